@@ -0,0 +1,377 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Microbenchmark of decoding fixed width values. Compares reading a BIGINT array
+ * value by value through ByteBuffer::getInt64 with ByteBuffer::getInt64s, and
+ * reading the columns of a table row by row through the Row getters with
+ * decoding it into a ColumnarTable, for a synthetic table of BIGINT, INTEGER,
+ * SMALLINT and FLOAT columns and for the fixed width columns of the tables in
+ * test_src/test_data, decoded repeatedly as they are small.
+ *
+ * Usage: byteswapbench [rows], run from the root of the tree
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "ByteSwap.h"
+#include "ColumnarTable.h"
+#include "InvocationResponse.hpp"
+#include "RowBuilder.h"
+#include "Table.h"
+#include "TableIterator.h"
+
+namespace {
+
+int64_t elapsedMicros(const boost::posix_time::ptime &start) {
+    return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds();
+}
+
+boost::posix_time::ptime now() {
+    return boost::posix_time::microsec_clock::universal_time();
+}
+
+// the table as received in a response, in a buffer of its own
+voltdb::Table received(voltdb::Table &table) {
+    const int32_t size = table.getSerializedSize();
+    boost::shared_array<char> bytes(new char[size]);
+    voltdb::ByteBuffer serialized(bytes.get(), size);
+    table.serializeTo(serialized);
+    voltdb::SharedByteBuffer buffer(bytes, size);
+    buffer.position(4);
+    return voltdb::Table(buffer.slice());
+}
+
+void report(const char *name, size_t values, int64_t baselineMicros, int64_t micros) {
+    printf("%-44s %10zu %14.2f %14.2f %7.2fx\n", name, values,
+           baselineMicros * 1000.0 / values, micros * 1000.0 / values,
+           micros > 0 ? static_cast<double>(baselineMicros) / micros : 0.0);
+}
+
+// the tables in test_src/test_data, a serialized table and the responses of selects
+const char *TABLE_FILE = "serialized_table.bin";
+const char *RESPONSE_FILES[] = {
+    "invocation_response_select.msg",
+    "invocation_response_select_with_date.msg",
+    "invocation_response_select_geo_both.msg",
+    "invocation_response_select_geo_both_mid.msg",
+    "invocation_response_select_geo_bothnull.msg",
+    "invocation_response_select_geo_polynull.msg",
+    "invocation_response_select_geo_ptnull.msg"
+};
+
+/*
+ * Reads a file of test_src/test_data, leaving the buffer empty if it can't be read
+ */
+voltdb::SharedByteBuffer testData(const std::string &name) {
+    const std::string path = "test_src/test_data/" + name;
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) {
+        return voltdb::SharedByteBuffer();
+    }
+    fseek(fp, 0L, SEEK_END);
+    const long size = ftell(fp);
+    fseek(fp, 0L, SEEK_SET);
+    boost::shared_array<char> bytes(new char[size > 0 ? size : 1]);
+    const bool read = size > 0 && fread(bytes.get(), static_cast<size_t>(size), 1, fp) == 1;
+    fclose(fp);
+    return read ? voltdb::SharedByteBuffer(bytes, static_cast<int32_t>(size)) : voltdb::SharedByteBuffer();
+}
+
+/*
+ * Whether the column is decoded by both the Row getters and ColumnarTable into comparable values
+ */
+bool benchedColumn(const voltdb::Column &column) {
+    switch (column.type()) {
+        case voltdb::WIRE_TYPE_TINYINT:
+        case voltdb::WIRE_TYPE_SMALLINT:
+        case voltdb::WIRE_TYPE_INTEGER:
+        case voltdb::WIRE_TYPE_BIGINT:
+        case voltdb::WIRE_TYPE_TIMESTAMP:
+        case voltdb::WIRE_TYPE_FLOAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Sums the fixed width values of a table read row by row through the Row getters, NULLs
+ * included as their sentinels
+ */
+void rowChecksum(const voltdb::Table &table, int64_t &integers, double &doubles) {
+    const std::vector<voltdb::Column> columns = table.columns();
+    voltdb::TableIterator iterator = table.iterator();
+    while (iterator.hasNext()) {
+        voltdb::Row row = iterator.next();
+        for (int32_t column = 0; column < static_cast<int32_t>(columns.size()); column++) {
+            switch (columns[static_cast<size_t>(column)].type()) {
+                case voltdb::WIRE_TYPE_TINYINT:
+                    integers += row.getInt8(column);
+                    break;
+                case voltdb::WIRE_TYPE_SMALLINT:
+                    integers += row.getInt16(column);
+                    break;
+                case voltdb::WIRE_TYPE_INTEGER:
+                    integers += row.getInt32(column);
+                    break;
+                case voltdb::WIRE_TYPE_BIGINT:
+                    integers += row.getInt64(column);
+                    break;
+                case voltdb::WIRE_TYPE_TIMESTAMP:
+                    integers += row.getTimestamp(column);
+                    break;
+                case voltdb::WIRE_TYPE_FLOAT:
+                    doubles += row.getDouble(column);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+/*
+ * Sums the same values as rowChecksum() decoded column by column into a ColumnarTable
+ */
+void columnChecksum(const voltdb::Table &table, int64_t &integers, double &doubles) {
+    voltdb::ColumnarTable columnar(table);
+    const int32_t rows = columnar.rowCount();
+    for (int32_t column = 0; column < columnar.columnCount(); column++) {
+        switch (columnar.columns()[static_cast<size_t>(column)].type()) {
+            case voltdb::WIRE_TYPE_TINYINT: {
+                const int8_t *values = columnar.int8Values(column);
+                for (int32_t ii = 0; ii < rows; ii++) {
+                    integers += values[ii];
+                }
+                break;
+            }
+            case voltdb::WIRE_TYPE_SMALLINT: {
+                const int16_t *values = columnar.int16Values(column);
+                for (int32_t ii = 0; ii < rows; ii++) {
+                    integers += values[ii];
+                }
+                break;
+            }
+            case voltdb::WIRE_TYPE_INTEGER: {
+                const int32_t *values = columnar.int32Values(column);
+                for (int32_t ii = 0; ii < rows; ii++) {
+                    integers += values[ii];
+                }
+                break;
+            }
+            case voltdb::WIRE_TYPE_BIGINT:
+            case voltdb::WIRE_TYPE_TIMESTAMP: {
+                const int64_t *values = columnar.int64Values(column);
+                for (int32_t ii = 0; ii < rows; ii++) {
+                    integers += values[ii];
+                }
+                break;
+            }
+            case voltdb::WIRE_TYPE_FLOAT: {
+                const double *values = columnar.doubleValues(column);
+                for (int32_t ii = 0; ii < rows; ii++) {
+                    doubles += values[ii];
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+/*
+ * Decodes the fixed width columns of a table of the test data both ways, repeating the decoding
+ * of a small table for about a million values. Returns false if the two disagree.
+ */
+bool benchTestData(const std::string &name, const voltdb::Table &table) {
+    size_t columns = 0;
+    const std::vector<voltdb::Column> schema = table.columns();
+    for (std::vector<voltdb::Column>::const_iterator it = schema.begin(); it != schema.end(); ++it) {
+        columns += benchedColumn(*it) ? 1 : 0;
+    }
+    const size_t values = columns * static_cast<size_t>(table.rowCount());
+    if (values == 0) {
+        printf("%-44s no fixed width values\n", name.c_str());
+        return true;
+    }
+    const size_t repeats = std::max(static_cast<size_t>(1), static_cast<size_t>(1000000) / values);
+
+    int64_t rowIntegers = 0;
+    int64_t columnIntegers = 0;
+    double rowDoubles = 0;
+    double columnDoubles = 0;
+    int64_t rowMicros = 0;
+    int64_t columnMicros = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        // the first pass warms up
+        rowIntegers = columnIntegers = 0;
+        rowDoubles = columnDoubles = 0;
+        boost::posix_time::ptime start = now();
+        for (size_t ii = 0; ii < repeats; ii++) {
+            rowChecksum(table, rowIntegers, rowDoubles);
+        }
+        rowMicros = elapsedMicros(start);
+        start = now();
+        for (size_t ii = 0; ii < repeats; ii++) {
+            columnChecksum(table, columnIntegers, columnDoubles);
+        }
+        columnMicros = elapsedMicros(start);
+    }
+    if (rowIntegers != columnIntegers || rowDoubles != columnDoubles) {
+        fprintf(stderr, "Columnar decode of %s differs\n", name.c_str());
+        return false;
+    }
+    report(name.c_str(), values * repeats, rowMicros, columnMicros);
+    return true;
+}
+
+/*
+ * Benchmarks the serialized table and the results of the select responses of the test data
+ */
+bool benchTestData() {
+    voltdb::SharedByteBuffer serialized = testData(TABLE_FILE);
+    if (serialized.capacity() == 0) {
+        fprintf(stderr, "Could not read test_src/test_data, run from the root of the tree\n");
+        return false;
+    }
+    // prefixed by its length
+    serialized.position(4);
+    if (!benchTestData(TABLE_FILE, voltdb::Table(serialized.slice()))) {
+        return false;
+    }
+
+    for (size_t ii = 0; ii < sizeof(RESPONSE_FILES) / sizeof(RESPONSE_FILES[0]); ii++) {
+        voltdb::SharedByteBuffer message = testData(RESPONSE_FILES[ii]);
+        if (message.capacity() == 0) {
+            fprintf(stderr, "Could not read %s\n", RESPONSE_FILES[ii]);
+            return false;
+        }
+        // most of the responses are prefixed by their length
+        if (message.capacity() >= 4 && message.getInt32(0) == message.capacity() - 4) {
+            message.position(4);
+        }
+        const int32_t length = message.remaining();
+        boost::shared_array<char> bytes(new char[length]);
+        message.get(bytes.get(), length);
+        voltdb::InvocationResponse response(bytes, length);
+        const std::vector<voltdb::Table> results = response.results();
+        for (size_t result = 0; result < results.size(); result++) {
+            if (!benchTestData(RESPONSE_FILES[ii], results[result])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char **argv) {
+    const int32_t rows = argc > 1 ? atoi(argv[1]) : 1000000;
+    srand(42);
+    printf("byte swap kernel: %s\n", voltdb::byteSwapKernel());
+    printf("%-44s %10s %14s %14s %8s\n", "decode", "values", "per value ns", "bulk ns", "speedup");
+
+    std::vector<int64_t> values(static_cast<size_t>(rows));
+    for (size_t ii = 0; ii < values.size(); ii++) {
+        values[ii] = (static_cast<int64_t>(rand()) << 32) ^ rand();
+    }
+    std::vector<char> storage(values.size() * 8);
+    voltdb::ByteBuffer array(&storage[0], static_cast<int32_t>(storage.size()));
+    array.putInt64s(&values[0], rows).flip();
+
+    std::vector<int64_t> decoded(values.size());
+    int64_t perValueMicros = 0;
+    int64_t bulkMicros = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        // the first pass warms up
+        boost::posix_time::ptime start = now();
+        array.position(0);
+        for (size_t ii = 0; ii < decoded.size(); ii++) {
+            decoded[ii] = array.getInt64();
+        }
+        perValueMicros = elapsedMicros(start);
+        start = now();
+        array.position(0);
+        array.getInt64s(&decoded[0], rows);
+        bulkMicros = elapsedMicros(start);
+    }
+    if (decoded != values) {
+        fprintf(stderr, "Bulk decoded array differs\n");
+        return 1;
+    }
+    report("array", values.size(), perValueMicros, bulkMicros);
+
+    std::vector<voltdb::Column> columns;
+    columns.push_back(voltdb::Column("BIG", voltdb::WIRE_TYPE_BIGINT));
+    columns.push_back(voltdb::Column("ID", voltdb::WIRE_TYPE_INTEGER));
+    columns.push_back(voltdb::Column("SMALL", voltdb::WIRE_TYPE_SMALLINT));
+    columns.push_back(voltdb::Column("RATIO", voltdb::WIRE_TYPE_FLOAT));
+    voltdb::Table built(columns);
+    voltdb::RowBuilder row(columns);
+    for (int32_t ii = 0; ii < rows; ii++) {
+        row.addInt64(values[static_cast<size_t>(ii)]).addInt32(rand()).addInt16(static_cast<int16_t>(rand()))
+           .addDouble(rand() * 0.5);
+        built.addRow(row);
+    }
+    voltdb::Table table = received(built);
+
+    int64_t rowChecksum = 0;
+    int64_t columnChecksum = 0;
+    int64_t rowMicros = 0;
+    int64_t columnMicros = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        rowChecksum = columnChecksum = 0;
+        boost::posix_time::ptime start = now();
+        voltdb::TableIterator iterator = table.iterator();
+        while (iterator.hasNext()) {
+            voltdb::Row current = iterator.next();
+            rowChecksum += current.getInt64(0) + current.getInt32(1) + current.getInt16(2) +
+                           static_cast<int64_t>(current.getDouble(3));
+        }
+        rowMicros = elapsedMicros(start);
+
+        start = now();
+        voltdb::ColumnarTable columnar(table);
+        const int64_t *big = columnar.int64Values(0);
+        const int32_t *ids = columnar.int32Values(1);
+        const int16_t *small = columnar.int16Values(2);
+        const double *ratios = columnar.doubleValues(3);
+        for (int32_t ii = 0; ii < rows; ii++) {
+            columnChecksum += big[ii] + ids[ii] + small[ii] + static_cast<int64_t>(ratios[ii]);
+        }
+        columnMicros = elapsedMicros(start);
+    }
+    if (rowChecksum != columnChecksum) {
+        fprintf(stderr, "Columnar decode differs\n");
+        return 1;
+    }
+    report("table", static_cast<size_t>(rows) * columns.size(), rowMicros, columnMicros);
+
+    return benchTestData() ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Microbenchmark of the elastic hashinator's partition lookup. Compares the
+ * binary search over the interleaved token/partition array the hashinator used
+ * to do with the current lookup, and hashing keys one at a time through
+ * TheHashinator with hashinateBatch, for rings of increasing size.
+ *
+ * Usage: hashinatorbench [lookups]
+ */
+#include <arpa/inet.h>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "ElasticHashinator.h"
+#include "MurmurHash3.h"
+
+namespace {
+
+/*
+ * The previous layout, tokens and partitions interleaved in one sorted array
+ */
+class LegacyHashinator {
+public:
+    LegacyHashinator(const std::vector<int32_t> &tokens, const std::vector<int32_t> &partitions) :
+        m_tokens(2 * tokens.size()), m_tokenCount(static_cast<int32_t>(tokens.size())) {
+        for (size_t ii = 0; ii < tokens.size(); ii++) {
+            m_tokens[ii * 2] = tokens[ii];
+            m_tokens[ii * 2 + 1] = partitions[ii];
+        }
+    }
+
+    int32_t hashinate(int64_t value) const {
+        if (value == INT64_MIN) return 0;
+        const int32_t hash = voltdb::MurmurHash3_x64_128(value);
+        int32_t min = 0;
+        int32_t max = m_tokenCount - 1;
+        while (min <= max) {
+            int32_t mid = (min + max) >> 1;
+            int32_t midval = m_tokens[mid * 2];
+            if (midval < hash) {
+                min = mid + 1;
+            } else if (midval > hash) {
+                max = mid - 1;
+            } else {
+                return m_tokens[mid * 2 + 1];
+            }
+        }
+        // like the original, assumes a token at INT32_MIN so min is never 0 here
+        return m_tokens[(min - 1) * 2 + 1];
+    }
+
+private:
+    std::vector<int32_t> m_tokens;
+    const int32_t m_tokenCount;
+};
+
+int64_t elapsedMicros(const boost::posix_time::ptime &start) {
+    return (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds();
+}
+
+int64_t runBatch(const voltdb::TheHashinator &hashinator, const std::vector<int64_t> &keys, int64_t &checksum) {
+    std::vector<int32_t> partitions(keys.size());
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    hashinator.hashinateBatch(&keys[0], keys.size(), &partitions[0]);
+    const int64_t micros = elapsedMicros(start);
+    for (size_t ii = 0; ii < partitions.size(); ii++) {
+        checksum += partitions[ii];
+    }
+    return micros;
+}
+
+template <typename Hashinator>
+int64_t run(const Hashinator &hashinator, const std::vector<int64_t> &keys, int64_t &checksum) {
+    const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+    for (size_t ii = 0; ii < keys.size(); ii++) {
+        checksum += hashinator.hashinate(keys[ii]);
+    }
+    return elapsedMicros(start);
+}
+
+}
+
+int main(int argc, char **argv) {
+    const size_t lookups = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 10000000;
+    std::vector<int64_t> keys(lookups);
+    srand(42);
+    for (size_t ii = 0; ii < lookups; ii++) {
+        keys[ii] = (static_cast<int64_t>(rand()) << 32) ^ rand();
+    }
+
+    printf("%8s %8s %14s %14s %14s %8s\n", "tokens", "lookups", "legacy ns/op", "current ns/op", "batch ns/op", "speedup");
+    const size_t ringSizes[] = { 64, 512, 4096, 16384, 65536 };
+    for (size_t rr = 0; rr < sizeof(ringSizes) / sizeof(ringSizes[0]); rr++) {
+        std::set<int32_t> unique;
+        unique.insert(INT32_MIN);
+        while (unique.size() < ringSizes[rr]) {
+            unique.insert(static_cast<int32_t>((static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand())));
+        }
+        std::vector<int32_t> tokens(unique.begin(), unique.end());
+        std::vector<int32_t> partitions(tokens.size());
+        std::vector<int32_t> serialized;
+        serialized.push_back(htonl(static_cast<uint32_t>(tokens.size())));
+        for (size_t ii = 0; ii < tokens.size(); ii++) {
+            partitions[ii] = static_cast<int32_t>(ii % 64);
+            serialized.push_back(htonl(static_cast<uint32_t>(tokens[ii])));
+            serialized.push_back(htonl(static_cast<uint32_t>(partitions[ii])));
+        }
+
+        LegacyHashinator legacy(tokens, partitions);
+        voltdb::ElasticHashinator current(reinterpret_cast<const char*>(&serialized[0]));
+
+        int64_t legacyChecksum = 0;
+        int64_t currentChecksum = 0;
+        // warm up both before timing
+        run(legacy, keys, legacyChecksum);
+        run(current, keys, currentChecksum);
+        runBatch(current, keys, currentChecksum);
+        legacyChecksum = currentChecksum = 0;
+        int64_t batchChecksum = 0;
+        const int64_t legacyMicros = run(legacy, keys, legacyChecksum);
+        // through the base class, as the Distributer calls it
+        const int64_t currentMicros = run<voltdb::TheHashinator>(current, keys, currentChecksum);
+        const int64_t batchMicros = runBatch(current, keys, batchChecksum);
+        if (legacyChecksum != currentChecksum || currentChecksum != batchChecksum) {
+            fprintf(stderr, "Lookups disagree for a ring of %zu tokens\n", tokens.size());
+            return 1;
+        }
+        printf("%8zu %8zu %14.2f %14.2f %14.2f %7.2fx\n", tokens.size(), lookups,
+               legacyMicros * 1000.0 / lookups, currentMicros * 1000.0 / lookups, batchMicros * 1000.0 / lookups,
+               batchMicros > 0 ? static_cast<double>(legacyMicros) / batchMicros : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef VOLTDB_BATCHCALLBACK_HPP_
+#define VOLTDB_BATCHCALLBACK_HPP_
+#include <vector>
+#include "InvocationResponse.hpp"
+#include "ProcedureCallback.hpp"
+namespace voltdb {
+
+/*
+ * Abstract base class for callbacks to provide to the API with
+ * batch invocations (see Client::invokeBatch)
+ */
+class BatchCallback {
+public:
+
+    /*
+     * Invoked once, after every procedure in the batch has either received a response
+     * or been failed because the connection it was sent on was lost.
+     * Responses are in the same order the procedures were submitted in.
+     * Callbacks should not throw user exceptions.
+     * @return true if the event loop should break after invoking this callback, false otherwise
+     */
+    virtual bool callback(const std::vector<InvocationResponse> &responses) throw (voltdb::Exception) = 0;
+    virtual void abandon(ProcedureCallback::AbandonReason reason) {}
+    // Mechanism for the batch to over-ride abandon property set in client in event of backpressure.
+    // @return true: allow abandoning of the batch in case of back pressure
+    //         false: don't abandon the batch in back pressure scenario.
+    virtual bool allowAbandon() const {return true;}
+    virtual ~BatchCallback() {}
+};
+}
+
+#endif /* VOLTDB_BATCHCALLBACK_HPP_ */
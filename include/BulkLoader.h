@@ -0,0 +1,178 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_BULKLOADER_H_
+#define VOLTDB_BULKLOADER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "Client.h"
+#include "Column.hpp"
+#include "Exception.hpp"
+#include "InvocationResponse.hpp"
+#include "Procedure.hpp"
+#include "RowBuilder.h"
+#include "Table.h"
+
+struct event;
+
+namespace voltdb {
+
+class ClientImpl;
+
+/*
+ * Abstract base class for callbacks notified of the outcome of the
+ * load invocations issued by a BulkLoader
+ */
+class BulkLoaderCallback {
+public:
+    /*
+     * Invoked when a batch of rows could not be loaded, either because the load
+     * procedure failed or the connection was lost. The rows of the batch are supplied
+     * so they can be logged or resubmitted.
+     */
+    virtual void failure(const Table &rows, const InvocationResponse &response) throw (voltdb::Exception) = 0;
+
+    /*
+     * Invoked when a batch of rows has been loaded
+     */
+    virtual void success(int32_t rowCount) throw (voltdb::Exception) {}
+
+    virtual ~BulkLoaderCallback() {}
+};
+
+/*
+ * Loads rows into a table in batches. Rows of a partitioned table are grouped by the partition
+ * their partitioning column hashes to and each group is loaded with @LoadSinglepartitionTable
+ * sent to the leader of that partition. Rows of a replicated table, and rows of a partitioned
+ * table while the client has no elastic hashinator (client affinity disabled or the topology
+ * not loaded yet) or whose partitioning column is null, are loaded with @LoadMultipartitionTable.
+ *
+ * Batches are flushed when they reach the batch size, when flush() is called and, if a flush
+ * interval is set, periodically while the client's event loop runs. Load invocations are
+ * asynchronous; run the client's event loop (e.g. Client::drain()) to deliver their outcome
+ * to the callback. A BulkLoader must be used from the thread that runs the client's event loop.
+ */
+class BulkLoader {
+public:
+    /*
+     * Partition column index to use for replicated tables
+     */
+    static const int32_t REPLICATED;
+    static const int32_t DEFAULT_BATCH_SIZE;
+
+    /*
+     * @param client Client the loader issues its invocations through
+     * @param tableName Name of the table to load
+     * @param schema Columns of the table, rows passed to insertRow must be built with the same schema
+     * @param partitionColumn Index of the partitioning column in the schema, REPLICATED for replicated tables
+     * @param callback Callback notified of the outcome of every load invocation
+     * @param batchSize Number of rows a batch accumulates before it is flushed
+     * @param flushIntervalMillis Interval at which pending batches are flushed while the client's event loop
+     *        runs, 0 to flush only when batches are full or flush() is called
+     * @param upsert Update rows with a matching primary key instead of failing the batch
+     * @throws InvalidColumnException The partition column is out of range or of a type tables can't be partitioned on
+     * @throws NullPointerException The callback is null
+     * @throws LibEventException Failed to create the flush timer
+     */
+    BulkLoader(Client &client,
+               const std::string &tableName,
+               const std::vector<Column> &schema,
+               int32_t partitionColumn,
+               boost::shared_ptr<BulkLoaderCallback> callback,
+               int32_t batchSize = DEFAULT_BATCH_SIZE,
+               int32_t flushIntervalMillis = 0,
+               bool upsert = false) throw (Exception, InvalidColumnException, LibEventException);
+
+    /*
+     * Flushes the pending rows. Failures to issue the invocations are logged and the rows dropped,
+     * call flush() beforehand to have them reported.
+     */
+    ~BulkLoader();
+
+    /*
+     * Add the row to the batch of its partition, flushing the batch if it is full.
+     * The row builder is reset so it can be reused for the next row.
+     * @throws InCompatibleSchemaException The row was not built with the loader's schema
+     * @throws UninitializedColumnException Not all the columns of the row were set
+     */
+    void insertRow(RowBuilder &row) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException,
+                                           ElasticModeMismatchException, InCompatibleSchemaException, UninitializedColumnException);
+
+    /*
+     * Issue load invocations for all pending rows
+     */
+    void flush() throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException);
+
+    /*
+     * Number of rows inserted but not flushed yet
+     */
+    int64_t pendingRows() const { return m_pendingRows; }
+
+    /*
+     * Invoked by the flush timer
+     */
+    void flushTimerExpired();
+
+private:
+    BulkLoader(const BulkLoader &);
+    BulkLoader& operator=(const BulkLoader &);
+
+    /*
+     * Rows accumulated for one partition along with the encoded partitioning
+     * value @LoadSinglepartitionTable is routed by
+     */
+    struct Batch {
+        Batch(const std::vector<Column> &schema) : m_rows(schema) {}
+        Table m_rows;
+        std::string m_partitionKey;
+    };
+    typedef std::map<int32_t, boost::shared_ptr<Batch> > BatchMap;
+
+    /*
+     * Partition the row hashes to, or the multi partition initiator's id if it is not
+     * routed to a single partition. Sets key to the encoded partitioning value.
+     */
+    int32_t partitionForRow(RowBuilder &row, std::string &key);
+    void flushBatch(int32_t partitionId, Batch &batch) throw (Exception, NoConnectionsException, UninitializedParamsException,
+                                                              LibEventException, ElasticModeMismatchException);
+
+    boost::shared_ptr<ClientImpl> m_impl;
+    const std::string m_tableName;
+    const std::vector<Column> m_schema;
+    const int32_t m_partitionColumn;
+    const boost::shared_ptr<BulkLoaderCallback> m_callback;
+    const int32_t m_batchSize;
+    const int8_t m_upsertMode;
+    Procedure m_singlePartitionLoad;
+    Procedure m_multiPartitionLoad;
+    BatchMap m_batches;
+    int64_t m_pendingRows;
+    struct event *m_flushTimer;
+};
+
+}
+
+#endif /* VOLTDB_BULKLOADER_H_ */
@@ -54,10 +54,12 @@
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <vector>
 #include <string>
 #include <cstring>
 #include "Exception.hpp"
+#include "ByteSwap.h"
 
 namespace voltdb {
 
@@ -108,6 +110,13 @@ private:
         return position;
     }
 
+    static int32_t bulkLength(int32_t count, int32_t width) {
+        if (count < 0 || count > INT32_MAX / width) {
+            throw OverflowUnderflowException();
+        }
+        return count * width;
+    }
+
     int32_t checkIndex(int32_t index, int32_t length) {
         if ((index < 0) || (length > m_limit - index) || length < 0) {
             throw IndexOutOfBoundsException();
@@ -255,6 +264,39 @@ public:
         return *this;
     }
 
+    /*
+     * Bulk variants of the above, reading or writing count consecutive values with a single
+     * bounds check and converting them all at once, see ByteSwap.h
+     */
+    void getInt16s(int16_t *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap16(&m_buffer[checkGetPutIndex(bulkLength(count, 2))], values, static_cast<size_t>(count));
+    }
+    void getInt32s(int32_t *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap32(&m_buffer[checkGetPutIndex(bulkLength(count, 4))], values, static_cast<size_t>(count));
+    }
+    void getInt64s(int64_t *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap64(&m_buffer[checkGetPutIndex(bulkLength(count, 8))], values, static_cast<size_t>(count));
+    }
+    void getDoubles(double *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap64(&m_buffer[checkGetPutIndex(bulkLength(count, 8))], values, static_cast<size_t>(count));
+    }
+    ByteBuffer& putInt16s(const int16_t *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap16(values, &m_buffer[checkGetPutIndex(bulkLength(count, 2))], static_cast<size_t>(count));
+        return *this;
+    }
+    ByteBuffer& putInt32s(const int32_t *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap32(values, &m_buffer[checkGetPutIndex(bulkLength(count, 4))], static_cast<size_t>(count));
+        return *this;
+    }
+    ByteBuffer& putInt64s(const int64_t *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap64(values, &m_buffer[checkGetPutIndex(bulkLength(count, 8))], static_cast<size_t>(count));
+        return *this;
+    }
+    ByteBuffer& putDoubles(const double *values, int32_t count) throw (OverflowUnderflowException) {
+        byteSwap64(values, &m_buffer[checkGetPutIndex(bulkLength(count, 8))], static_cast<size_t>(count));
+        return *this;
+    }
+
     std::string getString(bool &wasNull) throw (OverflowUnderflowException) {
         int32_t length = getInt32();
         if (length == -1) {
@@ -274,6 +316,20 @@ public:
         return std::string(data, static_cast<uint32_t>(length));
     }
 
+    /*
+     * View of the length prefixed value at the index, pointing into this buffer's memory.
+     * Empty if the value is null.
+     */
+    boost::string_ref getStringRef(int32_t index, bool &wasNull) throw (OverflowUnderflowException, IndexOutOfBoundsException) {
+        int32_t length = getInt32(index);
+        if (length == -1) {
+            wasNull = true;
+            return boost::string_ref();
+        }
+        char *data = getByReference(index + 4, length);
+        return boost::string_ref(data, static_cast<size_t>(length));
+    }
+
     bool getBytes(bool &wasNull, int32_t bufsize, uint8_t *out_value, int32_t *out_len)
     throw (OverflowUnderflowException) {
         int32_t length = getInt32();
@@ -512,6 +568,17 @@ public:
 
     SharedByteBuffer() : ExpandableByteBuffer() {};
 
+    /*
+     * Point this buffer at another region of the memory it shares a reference to, e.g. the next
+     * row of a table, without the reference counting of slice()
+     */
+    void window(char *data, int32_t length) {
+        m_buffer = data;
+        m_position = 0;
+        m_limit = length;
+        m_capacity = length;
+    }
+
     SharedByteBuffer slice() {
         SharedByteBuffer retval(m_ref, &m_buffer[m_position], m_limit - m_position);
         m_position = m_limit;
@@ -0,0 +1,48 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_BYTESWAP_H_
+#define VOLTDB_BYTESWAP_H_
+
+#include <stddef.h>
+
+namespace voltdb {
+
+/*
+ * Bulk conversion of count 2, 4 or 8 byte values between the wire's big endian and native
+ * endian, from source to destination. Converting works the same in both directions. The
+ * conversion may be done in place, source being destination, but the two must not otherwise
+ * overlap, and neither needs to be aligned. Uses AVX2 or SSSE3 shuffles when the CPU supports
+ * them and converts value by value otherwise.
+ */
+void byteSwap16(const void *source, void *destination, size_t count);
+void byteSwap32(const void *source, void *destination, size_t count);
+void byteSwap64(const void *source, void *destination, size_t count);
+
+/*
+ * Name of the instruction set the conversions use on this CPU, "avx2", "ssse3" or "scalar"
+ */
+const char *byteSwapKernel();
+}
+
+#endif /* VOLTDB_BYTESWAP_H_ */
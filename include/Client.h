@@ -35,7 +35,11 @@
 namespace voltdb {
 class MockVoltDB;
 class ClientImpl;
+class BulkLoader;
 class ProcedureCallback;
+class BatchCallback;
+class AllPartitionsCallback;
+class GroupedByPartitionCallback;
 /*
  * A VoltDB client for invoking stored procedures on a VoltDB instance. The client and the
  * shared pointers it returns are not thread safe. If you need more parallelism you run multiple processes
@@ -47,6 +51,7 @@ class ProcedureCallback;
  */
 class Client {
     friend class MockVoltDB;
+    friend class BulkLoader;
 public:
     /*
      * Create a connection to the VoltDB process running at the specified host authenticating
@@ -96,6 +101,65 @@ public:
      */
     void invoke(voltdb::Procedure &proc, voltdb::ProcedureCallback *callback) throw (voltdb::NoConnectionsException, voltdb::UninitializedParamsException, voltdb::LibEventException, voltdb::Exception);
 
+    /*
+     * Asynchronously invoke a group of stored procedures as one batch. All requests are serialized
+     * together and written with a single write per destination connection. The batch callback is invoked
+     * once, after every member has completed, with the responses in the order the procedures were submitted.
+     * If there is backpressure this method blocks until there is none, with the same status listener
+     * notification as invoke().
+     * @throws NoConnectionsException No connections to submit the requests on
+     * @throws UninitializedParamsException Some or all of the parameters for a stored procedure were not set,
+     *         in which case none of the batch is submitted
+     * @throws LibEventException An unknown error occured in libevent before any of the batch was written. A
+     *         failure after some connections were written completes the members that were not sent with
+     *         STATUS_CODE_UNEXPECTED_FAILURE instead.
+     */
+#ifdef SWIG
+%ignore invokeBatch;
+#endif
+    void invokeBatch(const std::vector<voltdb::Procedure*> &procs, boost::shared_ptr<voltdb::BatchCallback> callback) throw (voltdb::NoConnectionsException, voltdb::UninitializedParamsException, voltdb::LibEventException, voltdb::Exception);
+
+    /*
+     * Asynchronously invoke a single partition procedure once at every partition, e.g. to scan or aggregate
+     * in parallel instead of running one multi partition transaction. The procedure must be partitioned on
+     * an integer parameter. Set the parameters as for invoke(), the value of the partitioning parameter is
+     * a placeholder: each invocation replaces it with a key that hashes to its partition and is routed to
+     * that partition's leader. The callback is notified of each partition's response as it arrives and once
+     * more with all the responses. Requires the topology to be loaded, i.e. client affinity to be enabled.
+     * Once a partition's request was submitted, the partitions whose requests can't be get failed responses
+     * instead of the exception below.
+     * @throws AllPartitionsInvocationException The procedure is unknown or not partitioned on an integer
+     *         parameter, the topology is not loaded or no key of a partition could be found
+     * @throws NoConnectionsException No connections to submit the requests on
+     * @throws UninitializedParamsException Some or all of the parameters for the stored procedure were not set
+     * @throws LibEventException An unknown error occured in libevent
+     */
+#ifdef SWIG
+%ignore invokeAllPartitions;
+#endif
+    void invokeAllPartitions(voltdb::Procedure &proc, boost::shared_ptr<voltdb::AllPartitionsCallback> callback) throw (voltdb::NoConnectionsException, voltdb::UninitializedParamsException, voltdb::LibEventException, voltdb::AllPartitionsInvocationException, voltdb::Exception);
+
+    /*
+     * Asynchronously invoke a single partition procedure once per partition the keys hash to, e.g. to
+     * look up many keys with a round trip per partition instead of per key. The procedure takes two
+     * parameters: its partitioning parameter, which is set to one of the partition's keys, and an array
+     * of the partitioning parameter's type, which is set to all of the partition's keys. Any parameters
+     * already set on the procedure are replaced. The callback is notified of each partition's response
+     * as it arrives and once more with all the responses and, in the order of the keys, where each
+     * key's result is. Requires the topology to be loaded, i.e. client affinity to be enabled.
+     * Once a partition's request was submitted, the partitions whose requests can't be get failed responses
+     * instead of the exceptions below.
+     * @throws GroupedInvocationException The procedure is unknown, not partitioned on a parameter
+     *         of the type of the keys or does not take two parameters, or the topology is not loaded
+     * @throws NoConnectionsException No connections to submit the requests on
+     * @throws LibEventException An unknown error occured in libevent
+     */
+#ifdef SWIG
+%ignore invokeGroupedByPartition;
+#endif
+    void invokeGroupedByPartition(voltdb::Procedure &proc, const std::vector<int64_t> &keys, boost::shared_ptr<voltdb::GroupedByPartitionCallback> callback) throw (voltdb::NoConnectionsException, voltdb::UninitializedParamsException, voltdb::LibEventException, voltdb::GroupedInvocationException, voltdb::Exception);
+    void invokeGroupedByPartition(voltdb::Procedure &proc, const std::vector<std::string> &keys, boost::shared_ptr<voltdb::GroupedByPartitionCallback> callback) throw (voltdb::NoConnectionsException, voltdb::UninitializedParamsException, voltdb::LibEventException, voltdb::GroupedInvocationException, voltdb::Exception);
+
     /*
      * Run the event loop once and process pending events. This writes requests to any ready connections
      * and reads all responses and invokes the appropriate callbacks. Returns immediately after performing
@@ -67,6 +67,13 @@ public:
     timeval m_queryTimeout;
     timeval m_scanIntervalForTimedoutQuery;
     bool m_useSSL;
+    /*
+     * Spread read only single partition procedures across the connected hosts holding a replica
+     * of the partition instead of always sending them to the partition leader, which remains the
+     * fallback. Off by default: a replica only answers reads itself when the server's read
+     * consistency allows it, otherwise it forwards them to the leader.
+     */
+    bool m_readFromReplicas;
 
 private:
     static const int8_t DEFAULT_QUERY_TIMEOUT_SEC = 10;
@@ -33,6 +33,10 @@
 #include <list>
 #include <string>
 #include "ProcedureCallback.hpp"
+#include "BatchCallback.hpp"
+#include "AllPartitionsCallback.hpp"
+#include "GroupedByPartitionCallback.hpp"
+#include "StreamingProcedureCallback.hpp"
 #include "Client.h"
 #include "Procedure.hpp"
 #include <boost/atomic.hpp>
@@ -40,18 +44,22 @@
 #include <boost/thread/mutex.hpp>
 #include "ClientConfig.h"
 #include "Distributer.h"
+#include "SchemaCache.h"
 
 namespace voltdb {
 
 class CxnContext;
+class ResponseStream;
 class MockVoltDB;
 class Client;
 class PendingConnection;
+class BulkLoader;
 
 class ClientImpl {
     friend class MockVoltDB;
     friend class PendingConnection;
     friend class Client;
+    friend class BulkLoader;
 
 public:
     /*
@@ -74,6 +82,24 @@ public:
     InvocationResponse invoke(Procedure &proc) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException);
     void invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> callback) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException);
     void invoke(Procedure &proc, ProcedureCallback *callback) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException);
+
+    /*
+     * Asynchronously invoke a group of procedures. All requests are serialized up front and written
+     * with one contiguous write per destination connection. The batch callback fires once, after the
+     * last member completes, with the responses in submission order.
+     */
+    void invokeBatch(const std::vector<Procedure*> &procs, boost::shared_ptr<BatchCallback> callback) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException);
+    /*
+     * Asynchronously invoke a single partition procedure at every partition, the partitioning parameter
+     * of each invocation replaced with a key of its partition
+     */
+    void invokeAllPartitions(Procedure &proc, boost::shared_ptr<AllPartitionsCallback> callback) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException, AllPartitionsInvocationException);
+    /*
+     * Asynchronously invoke a single partition procedure once per partition the keys hash to, with
+     * a key of the partition as partitioning parameter and all its keys as array parameter
+     */
+    void invokeGroupedByPartition(Procedure &proc, const std::vector<int64_t> &keys, boost::shared_ptr<GroupedByPartitionCallback> callback) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException, GroupedInvocationException);
+    void invokeGroupedByPartition(Procedure &proc, const std::vector<std::string> &keys, boost::shared_ptr<GroupedByPartitionCallback> callback) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException, GroupedInvocationException);
     void runOnce() throw (Exception, NoConnectionsException, LibEventException);
     void run() throw (Exception, NoConnectionsException, LibEventException);
     void runForMaxTime(uint64_t microseconds) throw (Exception, NoConnectionsException, LibEventException);
@@ -156,9 +182,116 @@ private:
     void subscribeToTopologyNotifications();
 
     /*
-     * Get the buffered event based on transaction routing algorithm
+     * Get the buffered event based on transaction routing algorithm. A non negative
+     * partition id routes to that partition's leader instead of hashing the partitioning parameter.
+     * Every lookup of one route is made against the same routing snapshot, which also tells
+     * whether the procedure is read only.
+     */
+    struct bufferevent *routeProcedure(Procedure &proc, ByteBuffer &sbb, bool &readOnly, int partitionId = -1);
+
+    /*
+     * Connection to the specified host, NULL if there is none or it was lost
+     */
+    struct bufferevent *bevForHostId(int hostId);
+
+    /*
+     * Connections of the partitions of one topology, indexed by partition id. Never modified once
+     * published, a new table replaces it when the topology or the set of connections changes.
+     */
+    struct PartitionRouting {
+        PartitionRouting() : m_topologyVersion(-1), m_multiPartitionBev(NULL) {}
+        // topology version the table was built from
+        int64_t m_topologyVersion;
+        // leader connection of each partition
+        std::vector<struct bufferevent *> m_partitionToBev;
+        struct bufferevent *m_multiPartitionBev;
+        // connected replicas of each partition when reading from replicas
+        std::vector<std::vector<struct bufferevent *> > m_partitionToReplicaBevs;
+    };
+
+    /*
+     * The connection table for the topology of the snapshot, built and published if the current
+     * one is missing or was built from another topology
+     */
+    boost::shared_ptr<const PartitionRouting> partitionRouting(const RoutingSnapshot &topology);
+    boost::shared_ptr<const PartitionRouting> buildPartitionRouting(const RoutingSnapshot &topology);
+
+    /*
+     * Connection to the leader of the specified partition, NULL if it is unknown or the
+     * connection was lost
+     */
+    struct bufferevent *bevForPartition(const PartitionRouting &routing, int partitionId);
+
+    /*
+     * Connection for a read only invocation at the specified partition: the connected replicas
+     * take turns when reads from replicas are enabled, otherwise it is the leader's connection
+     */
+    struct bufferevent *readBevForPartition(const PartitionRouting &routing, int partitionId);
+
+    /*
+     * Stream parsing the response being received on a connection when it is for a streaming
+     * callback, NULL otherwise. The start of the response must have been received, it is only
+     * looked at while the connection has requests with streaming callbacks.
+     */
+    boost::shared_ptr<ResponseStream> streamFor(struct bufferevent *bev, int32_t length);
+
+    /*
+     * Passes what was received of a streamed response to its callback, completing the request
+     * once the whole response was read
+     * @return The number of bytes the connection's input must hold for the stream to progress,
+     * 0 once the response was read
+     */
+    size_t readStream(struct bufferevent *bev, ResponseStream &stream, bool &breakEventLoop);
+
+    /*
+     * Passes an exception thrown by a callback to the status listener
+     * @return true if the event loop should break
+     */
+    bool reportCallbackException(const std::exception &exception, const boost::shared_ptr<ProcedureCallback> &callback,
+                                 const InvocationResponse &response);
+
+    /*
+     * Backpressure check of an invocation made of several requests, done once for all of them
+     * @return true if the invocation was abandoned
+     */
+    template <class Callback>
+    bool abandonGroup(Callback &callback);
+
+    /*
+     * Partition of every key, the keys of each partition in their order and where each key ends up
+     * @throws GroupedInvocationException if the topology is not loaded
+     */
+    void groupByPartition(const std::vector<int32_t> &partitions, std::map<int32_t, std::vector<size_t> > &groups,
+                          std::vector<GroupedByPartitionCallback::KeyLocation> &locations) throw (GroupedInvocationException);
+
+    /*
+     * Completes the members of a group at the partitions from first to last, keys of a map by partition id,
+     * with failed responses when they can't be submitted after others of the group were
+     */
+    template <class Group, class Iterator>
+    void failGroupMembers(const boost::shared_ptr<Group> &group, Iterator first, Iterator last, const std::exception &reason);
+
+    /*
+     * Single partition procedure info of a grouped invocation and which of its two parameters is the array
+     */
+    const ProcedureInfo *resolveGroupedProcedure(Procedure &proc, const boost::shared_ptr<const RoutingSnapshot> &topology,
+                                                 bool &partitionParameterFirst) throw (GroupedInvocationException);
+
+    /*
+     * invokeGroupedByPartition() for integer or string keys
+     */
+    template <class Key>
+    void invokeGrouped(Procedure &proc, const std::vector<Key> &keys,
+                       const boost::shared_ptr<GroupedByPartitionCallback> &callback) throw (Exception, NoConnectionsException,
+                                                                                             UninitializedParamsException,
+                                                                                             LibEventException,
+                                                                                             GroupedInvocationException);
+
+    /*
+     * Asynchronously invoke a procedure routed to the leader of the specified partition,
+     * or by the procedure's partitioning parameter if the partition id is negative
      */
-    struct bufferevent *routeProcedure(Procedure &proc, ScopedByteBuffer &sbb);
+    void invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> callback, int partitionId) throw (Exception, NoConnectionsException, UninitializedParamsException, LibEventException, ElasticModeMismatchException);
 
     /*
      * Initiate connection based on pending connection instance
@@ -202,7 +335,14 @@ private:
 
     void setUpTimeoutCheckerMonitor() throw (LibEventException);
     void startMonitorThread() throw (TimerThreadException);
-    bool isReadOnly(const Procedure &proc) ;
+    bool isReadOnly(Procedure &proc) ;
+
+    /*
+     * Partitioning information for the procedure, served from the procedure's cache
+     * unless the procedure catalog changed since it was last resolved
+     */
+    const ProcedureInfo *resolveProcedure(Procedure &proc);
+    const ProcedureInfo *resolveProcedure(Procedure &proc, const boost::shared_ptr<const RoutingSnapshot> &routing);
 
 private:
     class CallBackBookeeping {
@@ -210,10 +350,12 @@ private:
         CallBackBookeeping(const boost::shared_ptr<ProcedureCallback> &callback,
                 timeval timeout, bool readOnly = false) : m_procCallBack(callback),
                                                           m_expirationTime(timeout),
-                                                          m_readOnly(readOnly) {}
+                                                          m_readOnly(readOnly),
+                                                          m_streaming(dynamic_cast<StreamingProcedureCallback*>(callback.get()) != NULL) {}
 
         CallBackBookeeping(const CallBackBookeeping& other) : m_procCallBack (other.m_procCallBack),
-                m_expirationTime (other.m_expirationTime),  m_readOnly (other.m_readOnly) {}
+                m_expirationTime (other.m_expirationTime),  m_readOnly (other.m_readOnly),
+                m_streaming (other.m_streaming) {}
 
         inline boost::shared_ptr<ProcedureCallback>  getCallback() const { return m_procCallBack; }
         // fetch the query/proc timeout/expiration value
@@ -222,12 +364,20 @@ private:
         inline bool isReadOnly() const { return m_readOnly; }
         // helper function to set if the proc is readonly or not
         inline void setReadOnly(bool value) { m_readOnly = value; }
+        // returns true if the callback is a StreamingProcedureCallback, decided once at invocation
+        inline bool isStreaming() const { return m_streaming; }
     private:
         const boost::shared_ptr<ProcedureCallback> m_procCallBack;
         const timeval m_expirationTime;
         bool m_readOnly;
+        const bool m_streaming;
     };
 
+    /*
+     * Counts a request with a streaming callback on the connection, or counts it down once it completed
+     */
+    void trackStreaming(struct bufferevent *bev, const CallBackBookeeping &request, bool completed);
+
     // Map from client data to the appropriate callback for a specific connection
     typedef std::map< int64_t, boost::shared_ptr<CallBackBookeeping> > CallbackMap;
     // Map from buffer event (connection) to the connection's callback map
@@ -243,6 +393,9 @@ private:
     std::vector<struct bufferevent*> m_bevs;
     std::map<struct bufferevent *, boost::shared_ptr<CxnContext> > m_contexts;
     std::map<int, struct bufferevent *> m_hostIdToEvent;
+    // connections of each partition, see partitionRouting(). Loaded and replaced with boost::atomic_load
+    // and boost::atomic_store, reset to NULL once a connection was added or lost
+    boost::shared_ptr<const PartitionRouting> m_partitionRouting;
     std::set<struct bufferevent *> m_backpressuredBevs;
     BEVToCallbackMap m_callbacks;
     boost::shared_ptr<voltdb::StatusListener> m_listener;
@@ -258,6 +411,11 @@ private:
     std::string m_username;
     unsigned char *m_passwordHash;
     const int32_t m_maxOutstandingRequests;
+    const bool m_readFromReplicas;
+    boost::atomic<size_t> m_nextReplicaIndex;
+    // a key of every partition for invokeAllPartitions(), and the topology version they were found for
+    std::map<int, int64_t> m_partitionKeys;
+    int64_t m_partitionKeysVersion;
 
     bool m_ignoreBackpressure;
     bool m_useClientAffinity;
@@ -304,6 +462,8 @@ private:
     ClientAuthHashScheme m_hashScheme;
     const bool m_enableSSL;
     SSL_CTX *m_clientSslCtx;
+    // shared by the result tables of every response received by this client
+    boost::shared_ptr<SchemaCache> m_schemaCache;
     // Reference count number of clients running to help in release of the global resource like
     // ssl ciphers, error strings and digests can be unloaded that are shared between clients
     static boost::atomic<uint32_t> m_numberOfClients;
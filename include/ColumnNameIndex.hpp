@@ -0,0 +1,62 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_COLUMNNAMEINDEX_HPP_
+#define VOLTDB_COLUMNNAMEINDEX_HPP_
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include "Column.hpp"
+
+namespace voltdb {
+
+/*
+ * Hash index from the names of a schema's columns to their indices, built once per schema and
+ * shared by its tables and rows so by-name access doesn't scan the columns. When several columns
+ * have the same name the first one is found.
+ */
+class ColumnNameIndex {
+public:
+    explicit ColumnNameIndex(const std::vector<voltdb::Column> &columns) {
+        m_indices.reserve(columns.size());
+        for (size_t ii = 0; ii < columns.size(); ii++) {
+            // insert keeps an existing name's index
+            m_indices.insert(std::make_pair(columns[ii].name(), static_cast<int32_t>(ii)));
+        }
+    }
+
+    /*
+     * Index of the column with the specified name, -1 if there is none
+     */
+    int32_t find(const std::string &name) const {
+        boost::unordered_map<std::string, int32_t>::const_iterator it = m_indices.find(name);
+        return it == m_indices.end() ? -1 : it->second;
+    }
+
+private:
+    boost::unordered_map<std::string, int32_t> m_indices;
+};
+}
+
+#endif /* VOLTDB_COLUMNNAMEINDEX_HPP_ */
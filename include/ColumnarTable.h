@@ -0,0 +1,196 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_COLUMNARTABLE_H_
+#define VOLTDB_COLUMNARTABLE_H_
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include <boost/utility/string_ref.hpp>
+#include "ByteBuffer.hpp"
+#include "Column.hpp"
+#include "Decimal.hpp"
+#include "Exception.hpp"
+#include "Table.h"
+#include "WireType.h"
+
+namespace voltdb {
+
+/*
+ * Column oriented copy of a table for vectorized processing. Every column is decoded into a
+ * contiguous array at once:
+ *   - TINYINT, SMALLINT, INTEGER, BIGINT, FLOAT, TIMESTAMP and DATE columns into arrays of their
+ *     native endian values, NULL values keeping the wire's NULL sentinel
+ *   - GEOGRAPHY_POINT columns into native endian longitude, latitude pairs of doubles
+ *   - DECIMAL columns into their 16 byte wire values
+ *   - STRING, VARBINARY and GEOGRAPHY columns into one data buffer holding every value back to
+ *     back, with rowCount() + 1 offsets delimiting the values, NULL values being empty
+ * Each column also has a validity bitmap, bit (row % 8) of byte (row / 8) being set when the
+ * value of the row is not NULL. The copy does not reference the table.
+ */
+class ColumnarTable {
+public:
+    /*
+     * Decodes all the rows of the table
+     * @throws UnsupportedTypeException The table has a column of a type that can't be decoded
+     */
+    explicit ColumnarTable(const Table &table) throw (UnsupportedTypeException, OverflowUnderflowException);
+
+    int32_t rowCount() const {
+        return m_rowCount;
+    }
+
+    int32_t columnCount() const {
+        return static_cast<int32_t>(m_columns.size());
+    }
+
+    const std::vector<voltdb::Column> &columns() const {
+        return m_columns;
+    }
+
+    /*
+     * Values of a TINYINT column
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const int8_t *int8Values(int32_t column) const throw (InvalidColumnException) {
+        return reinterpret_cast<const int8_t*>(values(column, WIRE_TYPE_TINYINT, WIRE_TYPE_TINYINT));
+    }
+
+    /*
+     * Values of a SMALLINT column
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const int16_t *int16Values(int32_t column) const throw (InvalidColumnException) {
+        return reinterpret_cast<const int16_t*>(values(column, WIRE_TYPE_SMALLINT, WIRE_TYPE_SMALLINT));
+    }
+
+    /*
+     * Values of an INTEGER column, or the encoded days of a DATE column
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const int32_t *int32Values(int32_t column) const throw (InvalidColumnException) {
+        return reinterpret_cast<const int32_t*>(values(column, WIRE_TYPE_INTEGER, WIRE_TYPE_DATE));
+    }
+
+    /*
+     * Values of a BIGINT column, or the microseconds of a TIMESTAMP column
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const int64_t *int64Values(int32_t column) const throw (InvalidColumnException) {
+        return reinterpret_cast<const int64_t*>(values(column, WIRE_TYPE_BIGINT, WIRE_TYPE_TIMESTAMP));
+    }
+
+    /*
+     * Values of a FLOAT column, or the longitude, latitude pairs of a GEOGRAPHY_POINT column
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const double *doubleValues(int32_t column) const throw (InvalidColumnException) {
+        return reinterpret_cast<const double*>(values(column, WIRE_TYPE_FLOAT, WIRE_TYPE_GEOGRAPHY_POINT));
+    }
+
+    /*
+     * Value of a row of a DECIMAL column
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    Decimal decimalValue(int32_t column, int32_t row) const throw (InvalidColumnException) {
+        char data[16];
+        ::memcpy(data, values(column, WIRE_TYPE_DECIMAL, WIRE_TYPE_DECIMAL) + static_cast<size_t>(row) * 16, 16);
+        return Decimal(data);
+    }
+
+    /*
+     * Offsets of the values of a STRING, VARBINARY or GEOGRAPHY column in its data, the value of
+     * a row spans from offsets[row] to offsets[row + 1]
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const int32_t *offsets(int32_t column) const throw (InvalidColumnException) {
+        return &variableColumn(column).m_offsets[0];
+    }
+
+    /*
+     * Values of a STRING, VARBINARY or GEOGRAPHY column, back to back
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    const char *data(int32_t column) const throw (InvalidColumnException) {
+        const ColumnData &data = variableColumn(column);
+        return data.m_values.empty() ? NULL : &data.m_values[0];
+    }
+
+    /*
+     * Value of a row of a STRING, VARBINARY or GEOGRAPHY column, pointing into the column's data
+     * @throws InvalidColumnException The index of the column was invalid or the column is of another type
+     */
+    boost::string_ref value(int32_t column, int32_t row) const throw (InvalidColumnException) {
+        const ColumnData &data = variableColumn(column);
+        const int32_t start = data.m_offsets[static_cast<size_t>(row)];
+        const int32_t end = data.m_offsets[static_cast<size_t>(row) + 1];
+        return start == end ? boost::string_ref() : boost::string_ref(&data.m_values[static_cast<size_t>(start)],
+                                                                      static_cast<size_t>(end - start));
+    }
+
+    /*
+     * Validity bitmap of a column
+     * @throws InvalidColumnException The index of the column was invalid
+     */
+    const uint8_t *validity(int32_t column) const throw (InvalidColumnException) {
+        const ColumnData &data = columnData(column);
+        return data.m_validity.empty() ? NULL : &data.m_validity[0];
+    }
+
+    /*
+     * Returns true if the value of the row of the column is NULL and false otherwise
+     * @throws InvalidColumnException The index of the column was invalid
+     */
+    bool isNull(int32_t column, int32_t row) const throw (InvalidColumnException) {
+        const ColumnData &data = columnData(column);
+        return (data.m_validity[static_cast<size_t>(row) / 8] & (1 << (row % 8))) == 0;
+    }
+
+private:
+    struct ColumnData {
+        // fixed width values, or the data of variable sized values
+        std::vector<char> m_values;
+        std::vector<int32_t> m_offsets;
+        std::vector<uint8_t> m_validity;
+    };
+
+    const ColumnData &columnData(int32_t column) const throw (InvalidColumnException) {
+        if (column < 0 || column >= columnCount()) {
+            throw InvalidColumnException(column, m_columns.size());
+        }
+        return m_data[static_cast<size_t>(column)];
+    }
+
+    const char *values(int32_t column, WireType type, WireType alternativeType) const throw (InvalidColumnException);
+    const ColumnData &variableColumn(int32_t column) const throw (InvalidColumnException);
+
+    void decodeFixedWidth(size_t column);
+
+    std::vector<voltdb::Column> m_columns;
+    std::vector<ColumnData> m_data;
+    int32_t m_rowCount;
+};
+}
+
+#endif /* VOLTDB_COLUMNARTABLE_H_ */
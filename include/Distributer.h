@@ -24,15 +24,17 @@
 #ifndef DISTRIBUTER_H_
 #define DISTRIBUTER_H_
 
-#include <boost/scoped_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/locks.hpp>
-#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
 #include "TheHashinator.h"
 #include "Table.h"
 #include "ByteBuffer.hpp"
 #include "Exception.hpp"
 #include <map>
 #include <string>
+#include <vector>
 
 
 
@@ -61,38 +63,110 @@ private:
     const int PARAMETER_NONE;
 };
 
+/*
+ * Immutable routing state: the hashinator, the leader of every partition and the partitioning of
+ * every procedure. The Distributer publishes a new snapshot on every update instead of modifying
+ * the current one, so a router that loaded a snapshot sees one consistent topology however long it
+ * keeps it, and is never blocked by an update in progress.
+ */
+class RoutingSnapshot {
+public:
+    RoutingSnapshot() : m_isElastic(true), m_topologyVersion(0), m_procedureInfoVersion(0),
+        m_partitionToHostId(new std::map<int, int>()),
+        m_partitionToReplicaHostIds(new std::map<int, std::vector<int> >()),
+        m_procedureInfo(new std::map<std::string, ProcedureInfo>()) {}
+
+    bool m_isElastic;
+    int64_t m_topologyVersion;
+    int64_t m_procedureInfoVersion;
+    // NULL until an elastic topology is loaded
+    boost::shared_ptr<const TheHashinator> m_hashinator;
+    // shared between snapshots until the part they describe changes
+    boost::shared_ptr<const std::map<int, int> > m_partitionToHostId;
+    // every host with a site of the partition, leader included, in the order the server listed them
+    boost::shared_ptr<const std::map<int, std::vector<int> > > m_partitionToReplicaHostIds;
+    boost::shared_ptr<const std::map<std::string, ProcedureInfo> > m_procedureInfo;
+};
+
 class Distributer{
 public:
      void startUpdate(){m_isUpdating = true;}
      bool isUpdating(){return m_isUpdating;}
-     bool isElastic(){return m_isElastic;}
+     bool isElastic(){return snapshot()->m_isElastic;}
 
      void updateAffinityTopology(const std::vector<voltdb::Table>& topoTable);
      void updateProcedurePartitioning(const std::vector<voltdb::Table>& procInfoTable);
 
-     Distributer(): m_isUpdating(false), m_isElastic(true){}
-
-     virtual ~Distributer(){
-         m_procedureInfo.clear();
-         m_PartitionToHostId.clear();
-     }
-
-     ProcedureInfo* getProcedure(const std::string& procName) throw (UnknownProcedureException);
-     int getHashedPartitionForParameter(ByteBuffer &paramBuffer, int parameterId);
+     Distributer(): m_id(++m_lastId), m_isUpdating(false), m_snapshot(new RoutingSnapshot()), m_procedureInfoVersion(0),
+         m_topologyVersion(0){}
+
+     virtual ~Distributer(){}
+
+     // The current routing state, safe to read from any thread while updates are published. The load
+     // holds one of boost's pooled spinlocks for the copy of the pointer, so a route should load the
+     // snapshot once and pass it to the static lookups below rather than call the instance ones
+     // repeatedly, which could also mix two topologies.
+     boost::shared_ptr<const RoutingSnapshot> snapshot() const { return boost::atomic_load(&m_snapshot); }
+
+     // Partitioning of the procedure, NULL if it is unknown. Keeps the snapshot it belongs to alive.
+     boost::shared_ptr<const ProcedureInfo> getProcedure(const std::string& procName) throw (UnknownProcedureException);
+     static boost::shared_ptr<const ProcedureInfo> getProcedure(const boost::shared_ptr<const RoutingSnapshot> &routing,
+                                                                const std::string& procName);
+     // Identifies this distributer among those of every client of the process, never reused
+     int64_t getId() const { return m_id; }
+     // Incremented every time the procedure partitioning is reloaded, invalidates
+     // ProcedureInfo pointers cached by procedures
+     int64_t getProcedureInfoVersion() const { return m_procedureInfoVersion; }
+     // Partition the partitioning parameter of the request hashes to, -1 if it can't be determined
+     int getHashedPartitionForParameter(ByteBuffer &paramBuffer, int parameterId, int parameterType);
+     // Same for a partitioning parameter whose offset in the request is known
+     int getHashedPartitionForParameterAt(ByteBuffer &paramBuffer, int offset, int parameterType);
+     // Both against a snapshot the caller already loaded
+     static int getHashedPartitionForParameter(const RoutingSnapshot &routing, ByteBuffer &paramBuffer,
+                                               int parameterId, int parameterType);
+     static int getHashedPartitionForParameterAt(const RoutingSnapshot &routing, ByteBuffer &paramBuffer,
+                                                 int offset, int parameterType);
      int getHostIdByPartitionId(int partitionId);
+     // Offset of the parameter in a serialized request, -1 if the request has no such parameter
+     static int getParameterOffset(ByteBuffer &paramBuffer, int parameterId);
+     // The smallest non negative integer key hashing to each partition of the snapshot's topology,
+     // searched with a bound derived from the partitions' shares of the hash ring. Throws rather than
+     // return a partial map if the topology is not loaded or a partition has no key.
+     static void getPartitionKeys(const RoutingSnapshot &routing, std::map<int, int64_t> &keys)
+         throw (AllPartitionsInvocationException);
+     boost::shared_ptr<const std::map<int, int> > getPartitionToHostId() const { return snapshot()->m_partitionToHostId; }
+     boost::shared_ptr<const std::map<int, std::vector<int> > > getPartitionToReplicaHostIds() const {
+         return snapshot()->m_partitionToReplicaHostIds;
+     }
+     // Incremented every time the affinity topology is reloaded, invalidates routing
+     // tables derived from the partition leaders
+     int64_t getTopologyVersion() const { return m_topologyVersion; }
+     // Partition of a key with the current hashinator, -1 if no elastic hashinator is loaded
+     int32_t hashinate(int64_t value) const;
+     int32_t hashinate(const char *bytes, int32_t length) const;
+     // Partitions of many keys at once, all -1 if no elastic hashinator is loaded
+     void hashinateBatch(const int64_t *values, size_t count, int32_t *partitions) const;
+     void hashinateBatch(const char * const *keys, const int32_t *lengths, size_t count, int32_t *partitions) const;
      void handleTopologyNotification(const std::vector<voltdb::Table>& t);
      static const int MP_INIT_PID;
 
 private:
-     int parseParameter(ByteBuffer &paramBuffer, int &index);
-
-     std::map<std::string, ProcedureInfo> m_procedureInfo;
-     std::map<int, int> m_PartitionToHostId;
-     bool m_isUpdating;
-     bool m_isElastic;
-     boost::scoped_ptr<TheHashinator> m_hashinator;
-
-     static boost::shared_mutex m_procInfoLock;
+     static int parseParameter(const TheHashinator &hashinator, ByteBuffer &paramBuffer, int &index, int partitionParameterType);
+     // The elastic hashinator of the current snapshot, NULL if there is none
+     boost::shared_ptr<const TheHashinator> elasticHashinator() const;
+     void publish(const boost::shared_ptr<RoutingSnapshot> &snapshot);
+
+     static boost::atomic<int64_t> m_lastId;
+     const int64_t m_id;
+     boost::atomic<bool> m_isUpdating;
+     boost::shared_ptr<const RoutingSnapshot> m_snapshot;
+     // Copies of the snapshot's versions that can be read without loading the snapshot,
+     // stored after the snapshot is published
+     boost::atomic<int64_t> m_procedureInfoVersion;
+     boost::atomic<int64_t> m_topologyVersion;
+
+     // Serializes updates of this distributer, never taken by readers
+     boost::mutex m_updateLock;
 
      voltdb::Table m_savedTopoTable;
 };
@@ -24,7 +24,12 @@
 #ifndef ELASTICHASHINATOR_H_
 #define ELASTICHASHINATOR_H_
 
+#include <algorithm>
 #include <string>
+#include <cstring>
+#include <vector>
+#include <arpa/inet.h>
+#include <boost/scoped_array.hpp>
 
 #include "TheHashinator.h"
 #include "MurmurHash3.h"
@@ -32,11 +37,14 @@
 
 namespace voltdb {
 
+class ElasticHashinatorTest;
+
 /*
  * Concrete implementation of TheHashinator that uses MurmurHash3_x64_128 to hash values
  * onto a consistent hash ring.
  */
 class ElasticHashinator : public TheHashinator {
+    friend class ElasticHashinatorTest;
 
 public:
 
@@ -53,8 +61,9 @@ public:
         const uint32_t partitionOffset = 8;
         const uint32_t int32size = sizeof(int32_t);
 
-        m_tokens.reset(new int32_t[2*m_tokenCount]);
-
+        // The ring is sent sorted by token
+        boost::scoped_array<int32_t> sortedTokens(new int32_t[m_tokenCount]);
+        boost::scoped_array<int32_t> sortedPartitions(new int32_t[m_tokenCount]);
         for (uint32_t ii = 0; ii < m_tokenCount; ii++) {
             int32_t hash;
             memcpy( &hash, tokens + ii*8 + tokenCountsOffset, int32size);
@@ -63,9 +72,20 @@ public:
             memcpy( &partitionId, tokens + ii*8 + partitionOffset, int32size);
 
             debug_msg("ElasticHashinator: hash " << std::hex << ntohl(hash) <<" partition " << std::dec << ntohl(partitionId));
-            m_tokens[ii * 2] = ntohl(hash);
-            m_tokens[ii * 2 + 1] =  ntohl(partitionId);
+            sortedTokens[ii] = ntohl(hash);
+            sortedPartitions[ii] = ntohl(partitionId);
         }
+
+        // Tokens and partitions are stored in parallel arrays in Eytzinger (breadth first) order,
+        // node k having children 2k and 2k+1, so the top of the search tree shares a few cache
+        // lines and the lookup can be branch free. Slot 0 holds the partition of hashes that
+        // precede the first token, which wrap around to the last token of the ring.
+        m_tokens.reset(new int32_t[m_tokenCount + 1]);
+        m_partitions.reset(new int32_t[m_tokenCount + 1]);
+        m_tokens[0] = 0;
+        m_partitions[0] = m_tokenCount > 0 ? sortedPartitions[m_tokenCount - 1] : 0;
+        uint32_t next = 0;
+        buildEytzinger(sortedTokens.get(), sortedPartitions.get(), next, 1);
     }
 
 
@@ -96,29 +116,120 @@ public:
         return partitionForToken(hash);
     }
 
+    void hashinateBatch(const int64_t *values, size_t count, int32_t *partitions) const {
+        int32_t hashes[BATCH_CHUNK];
+        for (size_t offset = 0; offset < count; offset += BATCH_CHUNK) {
+            const size_t chunk = count - offset < BATCH_CHUNK ? count - offset : BATCH_CHUNK;
+            MurmurHash3_x64_128(values + offset, chunk, hashes);
+            partitionsForTokens(hashes, chunk, partitions + offset);
+            for (size_t ii = 0; ii < chunk; ii++) {
+                if (values[offset + ii] == INT64_MIN) {
+                    partitions[offset + ii] = 0;
+                }
+            }
+        }
+    }
+
+    void hashinateBatch(const char * const *keys, const int32_t *lengths, size_t count, int32_t *partitions) const {
+        int32_t hashes[BATCH_CHUNK];
+        for (size_t offset = 0; offset < count; offset += BATCH_CHUNK) {
+            const size_t chunk = count - offset < BATCH_CHUNK ? count - offset : BATCH_CHUNK;
+            for (size_t ii = 0; ii < chunk; ii++) {
+                hashes[ii] = MurmurHash3_x64_128(keys[offset + ii], lengths[offset + ii], 0);
+            }
+            partitionsForTokens(hashes, chunk, partitions + offset);
+        }
+    }
+
+    void ringShares(std::map<int32_t, uint64_t> &shares) const {
+        shares.clear();
+        if (m_tokenCount == 0) {
+            return;
+        }
+        std::vector<std::pair<int32_t, int32_t> > ring;
+        ring.reserve(m_tokenCount);
+        for (uint32_t k = 1; k <= m_tokenCount; k++) {
+            ring.push_back(std::make_pair(m_tokens[k], m_partitions[k]));
+        }
+        std::sort(ring.begin(), ring.end());
+        // each token owns the hashes up to the next one, the last token also those before the first
+        for (size_t ii = 0; ii < ring.size(); ii++) {
+            const int64_t next = ii + 1 < ring.size() ?
+                    ring[ii + 1].first : static_cast<int64_t>(ring[0].first) + (INT64_C(1) << 32);
+            shares[ring[ii].second] += static_cast<uint64_t>(next - ring[ii].first);
+        }
+    }
+
 private:
+    // Keys hashed before their partitions are looked up, bounds the hash buffer on the stack
+    static const size_t BATCH_CHUNK = 256;
+    // Lookups descending the tree side by side so their cache misses overlap
+    static const size_t LOOKUP_LANES = 8;
+
     boost::scoped_array<int32_t> m_tokens;
+    boost::scoped_array<int32_t> m_partitions;
     uint32_t m_tokenCount;
 
+    /*
+     * In order traversal of the implicit tree assigns the sorted tokens to their Eytzinger slots
+     */
+    void buildEytzinger(const int32_t *sortedTokens, const int32_t *sortedPartitions, uint32_t &next, uint32_t k) {
+        if (k > m_tokenCount) {
+            return;
+        }
+        buildEytzinger(sortedTokens, sortedPartitions, next, 2 * k);
+        m_tokens[k] = sortedTokens[next];
+        m_partitions[k] = sortedPartitions[next];
+        next++;
+        buildEytzinger(sortedTokens, sortedPartitions, next, 2 * k + 1);
+    }
+
+    /*
+     * Partition owning the last token less than or equal to the hash
+     */
     int32_t partitionForToken(int32_t hash) const {
-        int32_t min = 0;
-        int32_t max = m_tokenCount - 1;
-
-        while (min <= max) {
-            assert(min >= 0);
-            assert(max >= 0);
-            uint32_t mid = (min + max) >> 1;
-            int32_t midval = m_tokens[mid * 2];
-
-            if (midval < hash) {
-                min = mid + 1;
-            } else if (midval > hash) {
-                max = mid - 1;
-            } else {
-                return m_tokens[mid * 2 + 1];
+        uint32_t k = 1;
+        while (k <= m_tokenCount) {
+            // the descendants four levels down share a cache line
+            __builtin_prefetch(m_tokens.get() + 16 * k);
+            k = 2 * k + (m_tokens[k] <= hash);
+        }
+        // Undo the trailing left turns and the last right turn to get back to the
+        // last node that was less than or equal to the hash, 0 if there was none
+        k >>= __builtin_ctz(k) + 1;
+        return m_partitions[k];
+    }
+
+    /*
+     * partitionForToken of count hashes. Every descent takes the same number of steps
+     * through the complete levels of the tree, so groups of lookups advance in lock step.
+     */
+    void partitionsForTokens(const int32_t *hashes, size_t count, int32_t *partitions) const {
+        const uint32_t completeLevels = 31 - __builtin_clz(m_tokenCount + 1);
+        size_t ii = 0;
+        for (; ii + LOOKUP_LANES <= count; ii += LOOKUP_LANES) {
+            uint32_t k[LOOKUP_LANES];
+            for (size_t lane = 0; lane < LOOKUP_LANES; lane++) {
+                k[lane] = 1;
+            }
+            for (uint32_t level = 0; level < completeLevels; level++) {
+                for (size_t lane = 0; lane < LOOKUP_LANES; lane++) {
+                    k[lane] = 2 * k[lane] + (m_tokens[k[lane]] <= hashes[ii + lane]);
+                }
             }
+            for (size_t lane = 0; lane < LOOKUP_LANES; lane++) {
+                uint32_t node = k[lane];
+                // the last level may be partially filled
+                if (node <= m_tokenCount) {
+                    node = 2 * node + (m_tokens[node] <= hashes[ii + lane]);
+                }
+                node >>= __builtin_ctz(node) + 1;
+                partitions[ii + lane] = m_partitions[node];
+            }
+        }
+        for (; ii < count; ii++) {
+            partitions[ii] = partitionForToken(hashes[ii]);
         }
-        return m_tokens[(min - 1) * 2 + 1];
     }
 };
 }
@@ -448,6 +448,42 @@ public:
         return m_what.c_str();
     }
 };
+
+/*
+ * Thrown when a procedure can't be invoked at every partition (see Client::invokeAllPartitions)
+ */
+class AllPartitionsInvocationException : public Exception {
+    std::string m_what;
+public:
+    explicit AllPartitionsInvocationException(const std::string& reason) : Exception() {
+        m_what = "Can't invoke the procedure at every partition: " + reason;
+    }
+
+    virtual ~AllPartitionsInvocationException() throw() {
+    }
+
+    const char* what() const throw() {
+        return m_what.c_str();
+    }
+};
+
+/*
+ * Thrown when a procedure can't be invoked with keys grouped by partition (see Client::invokeGroupedByPartition)
+ */
+class GroupedInvocationException : public Exception {
+    std::string m_what;
+public:
+    explicit GroupedInvocationException(const std::string& reason) : Exception() {
+        m_what = "Can't invoke the procedure grouped by partition: " + reason;
+    }
+
+    virtual ~GroupedInvocationException() throw() {
+    }
+
+    const char* what() const throw() {
+        return m_what.c_str();
+    }
+};
 }
 
 #endif /* VOLTDB_EXCEPTION_HPP_ */
@@ -0,0 +1,74 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_GROUPEDBYPARTITIONCALLBACK_HPP_
+#define VOLTDB_GROUPEDBYPARTITIONCALLBACK_HPP_
+#include <map>
+#include <vector>
+#include "InvocationResponse.hpp"
+#include "ProcedureCallback.hpp"
+namespace voltdb {
+
+/*
+ * Abstract base class for callbacks to provide to the API with
+ * invocations of keys grouped by partition (see Client::invokeGroupedByPartition)
+ */
+class GroupedByPartitionCallback {
+public:
+
+    /*
+     * Where the result of a key is: the partition whose response carries it and the
+     * key's position in the array parameter of that partition's invocation
+     */
+    struct KeyLocation {
+        int32_t m_partitionId;
+        int32_t m_position;
+    };
+
+    /*
+     * Invoked as the response of each partition arrives, or the invocation at the partition
+     * is failed because the connection it was sent on was lost.
+     * @return true if the event loop should break after invoking this callback, false otherwise
+     */
+    virtual bool partitionResponse(int32_t partitionId, const InvocationResponse &response) throw (voltdb::Exception) {
+        return false;
+    }
+
+    /*
+     * Invoked once, after every partition has responded, with the responses keyed by partition id
+     * and the location of every key's result, in the order the keys were given.
+     * Callbacks should not throw user exceptions.
+     * @return true if the event loop should break after invoking this callback, false otherwise
+     */
+    virtual bool callback(const std::map<int32_t, InvocationResponse> &responses,
+                          const std::vector<KeyLocation> &keys) throw (voltdb::Exception) = 0;
+    virtual void abandon(ProcedureCallback::AbandonReason reason) {}
+    // Mechanism for the invocation to over-ride abandon property set in client in event of backpressure.
+    // @return true: allow abandoning of the invocation in case of back pressure
+    //         false: don't abandon the invocation in back pressure scenario.
+    virtual bool allowAbandon() const {return true;}
+    virtual ~GroupedByPartitionCallback() {}
+};
+}
+
+#endif /* VOLTDB_GROUPEDBYPARTITIONCALLBACK_HPP_ */
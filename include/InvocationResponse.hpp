@@ -24,11 +24,15 @@
 #ifndef VOLTDB_INVOCATIONRESPONSE_HPP_
 #define VOLTDB_INVOCATIONRESPONSE_HPP_
 #include <boost/shared_array.hpp>
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include "ByteBuffer.hpp"
 #include "Table.h"
+#include "SegmentedBuffer.h"
 #include <iostream>
 namespace voltdb {
 
@@ -93,6 +97,7 @@ public:
         m_appStatusCode(STATUS_CODE_UNINITIALIZED_APP_STATUS_CODE),
         m_appStatusString(std::string("")),
         m_clusterRoundTripTime(0),
+        m_resultCount(0),
         m_results() {
     }
 
@@ -101,38 +106,42 @@ public:
 #endif
     /*
      * Constructor for taking shared ownership of a message buffer
-     * containing a response to a stored procedure invocation
+     * containing a response to a stored procedure invocation. Only the status is decoded,
+     * the result tables are decoded from the retained buffer when they are first asked for,
+     * sharing the columns of schemas interned in the optional schema cache.
      */
-    InvocationResponse(boost::shared_array<char>& data, int32_t length) : m_results(0) {
+    InvocationResponse(boost::shared_array<char>& data, int32_t length,
+                       const boost::shared_ptr<SchemaCache> &schemas = boost::shared_ptr<SchemaCache>()) {
         SharedByteBuffer buffer(data, length);
-        int8_t version = buffer.getInt8();
-        assert(version == 0);
-        m_clientData = buffer.getInt64();
-        int8_t presentFields = buffer.getInt8();
-        m_statusCode =  buffer.getInt8();
-        bool wasNull = false;
-        if ((presentFields & (1 << 5)) != 0) {
-            m_statusString = buffer.getString(wasNull);
-        }
-        m_appStatusCode = buffer.getInt8();
-        if ((presentFields & (1 << 7)) != 0) {
-            m_appStatusString = buffer.getString(wasNull);
-        }
-        assert(!wasNull);
-        m_clusterRoundTripTime = buffer.getInt32();
-        if ((presentFields & (1 << 6)) != 0) {
-            int32_t position = buffer.position() + 4;
-            buffer.position(position + buffer.getInt32());
-        }
-        size_t resultCount = static_cast<size_t>(buffer.getInt16());
-        m_results.resize(resultCount);
-        int32_t startLimit = buffer.limit();
-        for (size_t ii = 0; ii < resultCount; ii++) {
-            int32_t tableLength = buffer.getInt32();
-            assert(tableLength >= 4);
-            buffer.limit(buffer.position() + tableLength);
-            m_results[ii] = voltdb::Table(buffer.slice());
-            buffer.limit(startLimit);
+        decodeHeader(buffer);
+        m_lazyResults.reset(new LazyResults(buffer.slice(), boost::shared_ptr<SegmentedBuffer>(), 0, m_resultCount, schemas));
+    }
+
+#ifdef SWIG
+    %ignore InvocationResponse(const boost::shared_ptr<SegmentedBuffer> &segments,
+                               const boost::shared_ptr<SchemaCache> &schemas);
+#endif
+    /*
+     * Constructor for a response held in the segments it arrived in. The result tables keep
+     * their rows in the segments, see Table.
+     */
+    InvocationResponse(const boost::shared_ptr<SegmentedBuffer> &segments,
+                       const boost::shared_ptr<SchemaCache> &schemas = boost::shared_ptr<SchemaCache>()) {
+        // the status strings rarely span segments, so the header is usually read in place
+        int32_t headerLength = std::min(segments->length(), 256);
+        while (true) {
+            SharedByteBuffer header = segments->slice(0, headerLength);
+            try {
+                decodeHeader(header);
+                m_lazyResults.reset(new LazyResults(SharedByteBuffer(), segments, header.position(), m_resultCount, schemas));
+                return;
+            } catch (const voltdb::Exception&) {
+                // the header runs past the bytes read so far
+                if (headerLength == segments->length()) {
+                    throw;
+                }
+            }
+            headerLength = static_cast<int32_t>(std::min<int64_t>(segments->length(), headerLength * 2LL));
         }
     }
 
@@ -146,6 +155,7 @@ public:
                         m_appStatusCode(appStatus),
                         m_appStatusString(appStatusString),
                         m_clusterRoundTripTime(clusterRoudTripTime),
+                        m_resultCount(results.size()),
                         m_results(results) { }
     /*
      * Returns the client data generated by the API on behalf of user. Can be ignored.
@@ -219,7 +229,26 @@ public:
     /*
      * Returns a vector of tables containing result data returned by the stored procedure
      */
-    std::vector<voltdb::Table> results() const { return m_results; }
+    std::vector<voltdb::Table> results() const {
+        return decodedResults();
+    }
+
+    /*
+     * Returns the number of result tables without decoding them
+     */
+    size_t resultCount() const { return m_resultCount; }
+
+    /*
+     * Returns the result table at the specified index, decoding only that table if the
+     * results have not been decoded yet
+     */
+    voltdb::Table result(size_t index) const {
+        assert(index < m_resultCount);
+        if (m_lazyResults) {
+            return m_lazyResults->result(index);
+        }
+        return m_results[index];
+    }
 
     /*
      * Generate a string representation of the contents of the message
@@ -230,9 +259,10 @@ public:
         ostream << "App Status: " << static_cast<int32_t>(appStatusCode()) << ", " << appStatusString() << std::endl;
         ostream << "Client Data: " << clientData() << std::endl;
         ostream << "Cluster Round Trip Time: " << clusterRoundTripTime() << std::endl;
-        for (size_t ii = 0; ii < m_results.size(); ii++) {
+        const std::vector<voltdb::Table> &results = decodedResults();
+        for (size_t ii = 0; ii < results.size(); ii++) {
             ostream << "Result Table " << ii << std::endl;
-            m_results[ii].toString(ostream, std::string("    "));
+            results[ii].toString(ostream, std::string("    "));
         }
         return ostream.str();
     }
@@ -245,10 +275,11 @@ public:
         writeString(ostream, m_appStatusString);
         ostream.write((const char*)&m_clientData, sizeof(m_clientData));
         ostream.write((const char*)&m_clusterRoundTripTime, sizeof(m_clusterRoundTripTime));
-        size_t size = m_results.size();
+        const std::vector<voltdb::Table> &results = decodedResults();
+        size_t size = results.size();
         ostream.write((const char *)&size, sizeof(size));
-        for (size_t ii = 0; ii < m_results.size(); ii++) {
-            m_results[ii] >> ostream;
+        for (size_t ii = 0; ii < results.size(); ii++) {
+            results[ii] >> ostream;
         }
     }
 
@@ -261,6 +292,7 @@ public:
         istream.read((char *)&m_clusterRoundTripTime, sizeof(m_clusterRoundTripTime));
         size_t size;
         istream.read((char *)&size, sizeof(size));
+        m_resultCount = size;
         m_results.resize(size);
         for (size_t ii = 0; ii < size; ii++) {
             m_results[ii] = voltdb::Table(istream);
@@ -268,6 +300,158 @@ public:
     }
 
 private:
+    /*
+     * Result tables of a response received from the server, decoded on first access. The copies of the
+     * response share them, so they are decoded once, and the lock lets the response and its copies be
+     * used from different threads.
+     */
+    class LazyResults {
+    public:
+        LazyResults(const SharedByteBuffer &buffer, const boost::shared_ptr<SegmentedBuffer> &segments,
+                    int32_t offset, size_t count, const boost::shared_ptr<SchemaCache> &schemas) :
+            m_buffer(buffer), m_segments(segments), m_offset(offset), m_count(count), m_schemas(schemas),
+            m_decoded(false) {}
+
+        // never modified once decoded, so the reference stays valid without the lock
+        const std::vector<voltdb::Table> &results() {
+            boost::lock_guard<boost::mutex> guard(m_lock);
+            if (m_decoded) {
+                return m_results;
+            }
+            m_results.resize(m_count);
+            m_cached.resize(m_count, false);
+            if (m_segments) {
+                int32_t offset = m_offset;
+                for (size_t ii = 0; ii < m_count; ii++) {
+                    if (m_cached[ii]) {
+                        offset += 4 + m_segments->getInt32(offset);
+                    } else {
+                        m_results[ii] = nextResult(m_segments, offset, m_schemas.get());
+                    }
+                }
+            } else {
+                SharedByteBuffer buffer(m_buffer);
+                for (size_t ii = 0; ii < m_count; ii++) {
+                    if (m_cached[ii]) {
+                        const int32_t tableLength = buffer.getInt32();
+                        buffer.position(buffer.position() + tableLength);
+                    } else {
+                        m_results[ii] = nextResult(buffer, m_schemas.get());
+                    }
+                }
+            }
+            // the tables share the buffer, release the reference kept for decoding
+            m_buffer = SharedByteBuffer();
+            m_segments.reset();
+            m_cached.clear();
+            m_decoded = true;
+            return m_results;
+        }
+
+        /*
+         * Decodes one result on its first use, later calls return copies of the same table so that
+         * they share the rows of a segmented table once copied into one buffer
+         */
+        voltdb::Table result(size_t index) {
+            boost::lock_guard<boost::mutex> guard(m_lock);
+            if (m_decoded) {
+                return m_results[index];
+            }
+            if (m_cached.empty()) {
+                m_results.resize(m_count);
+                m_cached.resize(m_count, false);
+            }
+            if (m_cached[index]) {
+                return m_results[index];
+            }
+            if (m_segments) {
+                int32_t offset = m_offset;
+                for (size_t ii = 0; ii < index; ii++) {
+                    offset += 4 + m_segments->getInt32(offset);
+                }
+                m_results[index] = nextResult(m_segments, offset, m_schemas.get());
+            } else {
+                SharedByteBuffer buffer(m_buffer);
+                for (size_t ii = 0; ii < index; ii++) {
+                    const int32_t tableLength = buffer.getInt32();
+                    buffer.position(buffer.position() + tableLength);
+                }
+                m_results[index] = nextResult(buffer, m_schemas.get());
+            }
+            m_cached[index] = true;
+            return m_results[index];
+        }
+
+    private:
+        boost::mutex m_lock;
+        SharedByteBuffer m_buffer;
+        // the response held in the segments it arrived in instead of m_buffer
+        boost::shared_ptr<SegmentedBuffer> m_segments;
+        // offset of the first result in the segments
+        const int32_t m_offset;
+        const size_t m_count;
+        const boost::shared_ptr<SchemaCache> m_schemas;
+        bool m_decoded;
+        std::vector<voltdb::Table> m_results;
+        // results already decoded by result() before all of them are
+        std::vector<bool> m_cached;
+    };
+
+    const std::vector<voltdb::Table> &decodedResults() const {
+        return m_lazyResults ? m_lazyResults->results() : m_results;
+    }
+
+    /*
+     * Decodes the status and the result count, leaving the buffer's position at the first result
+     */
+    void decodeHeader(SharedByteBuffer &buffer) {
+        int8_t version = buffer.getInt8();
+        assert(version == 0);
+        m_clientData = buffer.getInt64();
+        int8_t presentFields = buffer.getInt8();
+        m_statusCode =  buffer.getInt8();
+        bool wasNull = false;
+        if ((presentFields & (1 << 5)) != 0) {
+            m_statusString = buffer.getString(wasNull);
+        }
+        m_appStatusCode = buffer.getInt8();
+        if ((presentFields & (1 << 7)) != 0) {
+            m_appStatusString = buffer.getString(wasNull);
+        }
+        assert(!wasNull);
+        m_clusterRoundTripTime = buffer.getInt32();
+        if ((presentFields & (1 << 6)) != 0) {
+            int32_t position = buffer.position() + 4;
+            buffer.position(position + buffer.getInt32());
+        }
+        m_resultCount = static_cast<size_t>(buffer.getInt16());
+    }
+
+    /*
+     * Table at the offset in the segments, the offset is moved past it
+     */
+    static voltdb::Table nextResult(const boost::shared_ptr<SegmentedBuffer> &segments, int32_t &offset,
+                                    SchemaCache *schemas) {
+        const int32_t tableLength = segments->getInt32(offset);
+        assert(tableLength >= 4);
+        voltdb::Table table(segments, offset + 4, tableLength, schemas);
+        offset += 4 + tableLength;
+        return table;
+    }
+
+    /*
+     * Table at the buffer's position, the position is moved past it
+     */
+    static voltdb::Table nextResult(SharedByteBuffer &buffer, SchemaCache *schemas) {
+        const int32_t tableLength = buffer.getInt32();
+        assert(tableLength >= 4);
+        const int32_t startLimit = buffer.limit();
+        buffer.limit(buffer.position() + tableLength);
+        voltdb::Table table(buffer.slice(), schemas);
+        buffer.limit(startLimit);
+        return table;
+    }
+
     static std::ostream &writeString(std::ostream &ostream, const std::string &str) {
         const int32_t size = str.size();
         ostream.write((const char*)&size, sizeof(size));
@@ -293,6 +477,9 @@ private:
     int8_t m_appStatusCode;
     std::string m_appStatusString;
     int32_t m_clusterRoundTripTime;
+    size_t m_resultCount;
+    // results of a response received from the server, NULL if it was built from m_results
+    boost::shared_ptr<LazyResults> m_lazyResults;
     std::vector<voltdb::Table> m_results;
 };
 }
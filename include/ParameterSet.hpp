@@ -185,9 +185,7 @@ public:
         m_buffer.putInt8(WIRE_TYPE_ARRAY);
         m_buffer.putInt8(WIRE_TYPE_TIMESTAMP);
         m_buffer.putInt16(static_cast<int16_t>(vals.size()));
-        for (std::vector<int64_t>::const_iterator i = vals.begin(); i != vals.end(); ++i) {
-            m_buffer.putInt64(*i);
-        }
+        m_buffer.putInt64s(vals.data(), static_cast<int32_t>(vals.size()));
         m_currentParam++;
         return *this;
     }
@@ -252,9 +250,7 @@ public:
         m_buffer.putInt8(WIRE_TYPE_ARRAY);
         m_buffer.putInt8(WIRE_TYPE_BIGINT);
         m_buffer.putInt16(static_cast<int16_t>(vals.size()));
-        for (std::vector<int64_t>::const_iterator i = vals.begin(); i != vals.end(); ++i) {
-            m_buffer.putInt64(*i);
-        }
+        m_buffer.putInt64s(vals.data(), static_cast<int32_t>(vals.size()));
         m_currentParam++;
         return *this;
     }
@@ -284,9 +280,7 @@ public:
         m_buffer.putInt8(WIRE_TYPE_ARRAY);
         m_buffer.putInt8(WIRE_TYPE_INTEGER);
         m_buffer.putInt16(static_cast<int16_t>(vals.size()));
-        for (std::vector<int32_t>::const_iterator i = vals.begin(); i != vals.end(); ++i) {
-            m_buffer.putInt32(*i);
-        }
+        m_buffer.putInt32s(vals.data(), static_cast<int32_t>(vals.size()));
         m_currentParam++;
         return *this;
     }
@@ -316,9 +310,7 @@ public:
         m_buffer.putInt8(WIRE_TYPE_ARRAY);
         m_buffer.putInt8(WIRE_TYPE_SMALLINT);
         m_buffer.putInt16(static_cast<int16_t>(vals.size()));
-        for (std::vector<int16_t>::const_iterator i = vals.begin(); i != vals.end(); ++i) {
-            m_buffer.putInt16(*i);
-        }
+        m_buffer.putInt16s(vals.data(), static_cast<int32_t>(vals.size()));
         m_currentParam++;
         return *this;
     }
@@ -376,13 +368,11 @@ public:
      */
     ParameterSet& addDouble(const std::vector<double>& vals) throw (voltdb::ParamMismatchException) {
         validateType(WIRE_TYPE_FLOAT, true);
-        m_buffer.ensureRemaining(2 + static_cast<int32_t>(sizeof(double) * vals.size()));
+        m_buffer.ensureRemaining(4 + static_cast<int32_t>(sizeof(double) * vals.size()));
         m_buffer.putInt8(WIRE_TYPE_ARRAY);
         m_buffer.putInt8(WIRE_TYPE_FLOAT);
         m_buffer.putInt16(static_cast<int16_t>(vals.size()));
-        for (std::vector<double>::const_iterator i = vals.begin(); i != vals.end(); ++i) {
-            m_buffer.putDouble(*i);
-        }
+        m_buffer.putDoubles(vals.data(), static_cast<int32_t>(vals.size()));
         m_currentParam++;
         return *this;
     }
@@ -399,6 +389,7 @@ public:
         if (m_currentParam > m_parameters.size()) {
             throw new ParamMismatchException();
         }
+        capturePartitionParameter();
         m_buffer.ensureRemaining(1);
         m_buffer.putInt8(WIRE_TYPE_NULL);
         m_currentParam++;
@@ -535,6 +526,8 @@ public:
         m_buffer.putInt8(WIRE_TYPE_VOLTTABLE);
         int32_t serializedSize = table.serializeTo(m_buffer);
         assert(serializedSize == tableSerializeSize);
+        // serializeTo sets the limit to the end of the table, reopen the buffer for the parameters after it
+        m_buffer.limit(m_buffer.capacity());
         m_currentParam++;
         return *this;
     }
@@ -561,6 +554,7 @@ public:
             serializedTablesSize += itr->serializeTo(m_buffer);
         }
         assert(serializedTablesSize == cummulativeSerializeTableSize);
+        m_buffer.limit(m_buffer.capacity());
         m_currentParam++;
         return *this;
     }
@@ -572,7 +566,9 @@ public:
      */
     void reset() {
         m_buffer.clear();
+        m_buffer.position(m_prefix);
         m_currentParam = 0;
+        m_partitionParameterOffset = -1;
         m_buffer.putInt16(static_cast<int16_t>(m_parameters.size()));
     }
 
@@ -580,7 +576,7 @@ public:
         if (m_currentParam != m_parameters.size()) {
             throw UninitializedParamsException();
         }
-        return m_buffer.position();
+        return m_buffer.position() - m_prefix;
     }
 
 #ifdef SWIG
@@ -591,6 +587,7 @@ public:
             throw UninitializedParamsException();
         }
         m_buffer.flip();
+        m_buffer.position(m_prefix);
         buffer->put(&m_buffer);
         reset();
         //once serialized parameters count cant be extended
@@ -611,16 +608,101 @@ private:
         m_parameters(parameters)
        ,m_buffer(8192)
        ,m_currentParam(0)
-       ,m_dynamicParamCount(false) {
+       ,m_dynamicParamCount(false)
+       ,m_prefix(0)
+       ,m_partitionParameter(-1)
+       ,m_partitionParameterOffset(-1) {
         m_buffer.putInt16(static_cast<int16_t>(m_parameters.size()));
     }
 
-    ParameterSet(): m_buffer(8192), m_currentParam(0), m_dynamicParamCount(true) {
+    ParameterSet(): m_buffer(8192), m_currentParam(0), m_dynamicParamCount(true), m_prefix(0),
+                    m_partitionParameter(-1), m_partitionParameterOffset(-1) {
         m_parameters.clear();
     }
 
+    /*
+     * Reserve the front of the parameter buffer for the request header (length prefix,
+     * the given pre-encoded version and name, and client data) so that parameters are
+     * encoded straight into their final position in the wire message.
+     */
+    void stageHeader(const std::string &header) {
+        m_prefix = 4 + static_cast<int32_t>(header.size()) + 8;
+        m_buffer.ensureCapacity(m_prefix + 2);
+        m_buffer.put(4, header.data(), static_cast<int32_t>(header.size()));
+        reset();
+    }
+
+    /*
+     * Complete the request staged in front of the parameters by filling in the length
+     * prefix and client data. The returned view stays valid until releaseRequest().
+     */
+    ByteBuffer stagedRequest(int64_t clientData) {
+        if (m_currentParam != m_parameters.size()) {
+            throw UninitializedParamsException();
+        }
+        const int32_t length = m_buffer.position();
+        m_buffer.putInt32(0, length - 4);
+        m_buffer.putInt64(m_prefix - 8, clientData);
+        ByteBuffer request(m_buffer.bytes(), length);
+        return request;
+    }
+
+    void releaseRequest() {
+        reset();
+        //once serialized parameters count cant be extended
+        m_dynamicParamCount = false;
+    }
+
+    /*
+     * Used by encoders that know the type and exact size of every parameter up front
+     * (see TypedProcedure): resets the set and makes room for all of the encoded
+     * parameters at once. The caller writes them and then calls endEncoded().
+     */
+    ByteBuffer& beginEncoded(int32_t size) {
+        reset();
+        m_buffer.ensureRemaining(size);
+        return m_buffer;
+    }
+
+    /*
+     * sizes holds the encoded size of every parameter, locating the partitioning parameter.
+     * NULL if the sizes are not known, routing then decodes the request.
+     */
+    void endEncoded(const int32_t *sizes) {
+        if (sizes != NULL && m_partitionParameter >= 0 && static_cast<size_t>(m_partitionParameter) < m_parameters.size()) {
+            int32_t offset = m_prefix + 2;
+            for (int32_t ii = 0; ii < m_partitionParameter; ii++) {
+                offset += sizes[ii];
+            }
+            m_partitionParameterOffset = offset;
+        }
+        m_currentParam = static_cast<uint32_t>(m_parameters.size());
+    }
+
+    /*
+     * Have the offset of the given parameter recorded as it is added, so the request can be
+     * routed without decoding the parameters preceding it. -1 to stop tracking.
+     */
+    void trackPartitionParameter(int32_t index) {
+        m_partitionParameter = index;
+    }
+
+    /*
+     * Offset of the given parameter in the request, -1 if it was not the one tracked while
+     * the current parameters were added
+     */
+    int32_t partitionParameterOffset(int32_t index) const {
+        return index == m_partitionParameter ? m_partitionParameterOffset : -1;
+    }
+
+    void capturePartitionParameter() {
+        if (static_cast<int32_t>(m_currentParam) == m_partitionParameter) {
+            m_partitionParameterOffset = m_buffer.position();
+        }
+    }
+
     void putParametersSize() {
-        m_buffer.putInt16(0, static_cast<int16_t>(m_parameters.size()));
+        m_buffer.putInt16(m_prefix, static_cast<int16_t>(m_parameters.size()));
     }
 
     void validateType(WireType type, bool isArray) {
@@ -634,12 +716,19 @@ private:
                 m_parameters[m_currentParam].m_array != isArray) {
             throw ParamMismatchException(static_cast<size_t>(type), wireTypeToString(type));
         }
+        capturePartitionParameter();
     }
 
     std::vector<Parameter> m_parameters;
     ScopedByteBuffer m_buffer;
     uint32_t m_currentParam;
     bool m_dynamicParamCount;
+    // bytes reserved ahead of the parameter count for the request header
+    int32_t m_prefix;
+    // index of the parameter the procedure is partitioned on, -1 if not tracked
+    int32_t m_partitionParameter;
+    // offset of that parameter's type byte in the buffer, -1 until it is added
+    int32_t m_partitionParameterOffset;
 };
 }
 #endif /* VOLTDB_PARAMETERSET_HPP_ */
@@ -25,22 +25,44 @@
 #define VOLTDB_PROCEDURE_HPP_
 #include <vector>
 #include <string>
+#include <boost/core/null_deleter.hpp>
+#include <boost/shared_ptr.hpp>
 #include "ParameterSet.hpp"
 #include "ByteBuffer.hpp"
 
 namespace voltdb {
+class ClientImpl;
+class DistributerTest;
+class StubGeneratorTest;
+class ProcedureInfo;
 
 /*
  * Description of a stored procedure and its parameters that must be provided to the API
- * in order to invoke a stored procedure
+ * in order to invoke a stored procedure.
+ *
+ * A Procedure is a prepared handle: the wire header (protocol version and procedure name)
+ * is encoded once at construction and the partitioning information resolved by the client
+ * is cached until the client learns of a catalog change, so reusing one instance for repeated
+ * invocations only re-encodes the parameters. Once the partitioning is known the offset of the
+ * partitioning parameter is captured as it is set, so routing doesn't decode the request.
  */
 class Procedure {
+    friend class ClientImpl;
+    friend class DistributerTest;
+    friend class StubGeneratorTest;
 public:
     /*
      * Construct a Procedure with the specified name and specified signature (parameters)
      */
-    Procedure(const std::string& name, std::vector<Parameter> parameters) : m_name(name), m_params(parameters) {}
-    Procedure(const std::string& name) : m_name(name) {}
+    Procedure(const std::string& name, std::vector<Parameter> parameters) :
+        m_name(name), m_params(parameters), m_procInfoSource(-1), m_procInfoVersion(-1), m_procInfoPinned(false) {
+        encodeHeader();
+        m_params.stageHeader(m_header);
+    }
+    Procedure(const std::string& name) : m_name(name), m_procInfoSource(-1), m_procInfoVersion(-1), m_procInfoPinned(false) {
+        encodeHeader();
+        m_params.stageHeader(m_header);
+    }
 
     /**
      * Retrieve the parameter set associated with the procedure so that the parameters can be set
@@ -54,9 +76,8 @@ public:
 
     int32_t getSerializedSize() {
         return
-            5                                      // length prefix and wire protocol version
-            + 4                                    // proc size
-            + static_cast<int32_t>(m_name.size())  // proc name
+            4                                      // length prefix
+            + static_cast<int32_t>(m_header.size())// wire protocol version, proc size and name
             + 8                                    // client data
             + m_params.getSerializedSize()         // parameters
             ;
@@ -69,16 +90,88 @@ public:
 #endif
     void serializeTo(ByteBuffer *buffer, int64_t clientData) {
         buffer->position(4);
-        buffer->putInt8(0);
-        buffer->putString(m_name);
+        buffer->put(m_header.data(), static_cast<int32_t>(m_header.size()));
         buffer->putInt64(clientData);
         m_params.serializeTo(buffer);
         buffer->flip();
         buffer->putInt32( 0, buffer->limit() - 4);
     }
+protected:
+    /*
+     * Raw access to the parameter buffer for subclasses that encode all parameters
+     * in one pass with types fixed at compile time.
+     */
+    ByteBuffer& beginEncodedParameters(int32_t size) {
+        return m_params.beginEncoded(size);
+    }
+
+    void endEncodedParameters(const int32_t *sizes) {
+        m_params.endEncoded(sizes);
+    }
+
+    /*
+     * Pin the partitioning information of this procedure, e.g. from stubs generated
+     * against a known catalog. The client then never looks the procedure up by name.
+     */
+    void pinProcedureInfo(const ProcedureInfo *info) {
+        m_procInfo.reset(info, boost::null_deleter());
+        m_procInfoPinned = true;
+    }
+
 private:
+    /*
+     * The parameters are encoded behind space reserved for the request header, so the
+     * complete request can be handed to the connection without first copying it into a
+     * separate request buffer. The view is valid until releaseRequest() or params() is called.
+     */
+    ByteBuffer stagedRequest(int64_t clientData) {
+        return m_params.stagedRequest(clientData);
+    }
+
+    void releaseRequest() {
+        m_params.releaseRequest();
+    }
+
+    /*
+     * Set the parameters to those of a request staged by this procedure, possibly modified,
+     * so the same parameters can be invoked again after the request was released
+     */
+    void restageRequest(const std::string &request) {
+        const int32_t offset = 4 + static_cast<int32_t>(m_header.size()) + 8 + 2;
+        const int32_t size = static_cast<int32_t>(request.size()) - offset;
+        ByteBuffer &buffer = m_params.beginEncoded(size);
+        buffer.put(request.data() + offset, size);
+        m_params.endEncoded(NULL);
+    }
+
+    void trackPartitionParameter(int32_t index) {
+        m_params.trackPartitionParameter(index);
+    }
+
+    int32_t partitionParameterOffset(int32_t index) const {
+        return m_params.partitionParameterOffset(index);
+    }
+
+    void encodeHeader() {
+        m_header.resize(1 + 4 + m_name.size());
+        ByteBuffer header(&m_header[0], static_cast<int32_t>(m_header.size()));
+        header.putInt8(0);
+        header.putString(m_name);
+    }
+
     const std::string m_name;
     ParameterSet m_params;
+    // pre-encoded wire protocol version and procedure name
+    std::string m_header;
+    // partitioning information cached by the client, valid while it is resolved by the same
+    // distributer and m_procInfoVersion matches its procedure catalog version. A procedure
+    // used with several clients is resolved again when it changes client.
+    // NULL if the procedure is unknown.
+    boost::shared_ptr<const ProcedureInfo> m_procInfo;
+    // id of the distributer that resolved m_procInfo, see Distributer::getId()
+    int64_t m_procInfoSource;
+    int64_t m_procInfoVersion;
+    bool m_procInfoPinned;
 };
 
 }
@@ -0,0 +1,134 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_RESPONSESTREAM_H_
+#define VOLTDB_RESPONSESTREAM_H_
+#include <cstddef>
+#include <stdint.h>
+#include <event2/buffer.h>
+#include <boost/shared_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include "InvocationResponse.hpp"
+#include "SchemaCache.h"
+#include "StreamingProcedureCallback.hpp"
+#include "Table.h"
+
+namespace voltdb {
+
+/*
+ * Incremental parser of an invocation response for a StreamingProcedureCallback. Reads the message
+ * from a connection's input buffer in pieces of whatever size arrived, handing the callback each
+ * result table's schema and then its rows as they complete.
+ */
+class ResponseStream {
+public:
+    /*
+     * @param length Length of the message, without its length prefix
+     */
+    ResponseStream(int32_t length, int64_t clientData, const boost::shared_ptr<StreamingProcedureCallback> &callback,
+                   const boost::shared_ptr<SchemaCache> &schemas);
+
+    /*
+     * Consumes what it can of the message from the input. Exceptions thrown by the callback are
+     * passed on and the stream can be read further.
+     * @param breakEventLoop Set if the callback asked for the event loop to break
+     * @return The number of bytes the input must hold for the stream to progress, 0 once the whole
+     * message was consumed
+     * @throws OverflowUnderflowException The lengths in the message are inconsistent, the stream
+     * is then malformed() and only the rest of the message can be skipped
+     */
+    size_t read(struct evbuffer *input, bool &breakEventLoop);
+
+    /*
+     * Whether reading the message failed for a reason other than an exception of the callback
+     */
+    bool malformed() const {
+        return m_malformed;
+    }
+
+    /*
+     * Stops passing the message to the callback, the rest of it is only consumed
+     */
+    void abandon() {
+        m_abandoned = true;
+    }
+
+    bool abandoned() const {
+        return m_abandoned;
+    }
+
+    int64_t clientData() const {
+        return m_clientData;
+    }
+
+    const boost::shared_ptr<StreamingProcedureCallback>& callback() const {
+        return m_callback;
+    }
+
+    /*
+     * The response without its result tables, once its header was read
+     */
+    const InvocationResponse& response() const {
+        return m_response;
+    }
+
+    // rows are copied out of the input and handed to the callback in batches of about this size
+    static const int32_t BATCH_BYTES = 256 * 1024;
+
+private:
+    enum State {
+        STATE_HEADER,
+        STATE_TABLE,
+        STATE_ROWS,
+        STATE_SKIP
+    };
+
+    size_t readMessage(struct evbuffer *input, bool &breakEventLoop);
+    size_t readHeader(struct evbuffer *input);
+    size_t readTable(struct evbuffer *input, bool &breakEventLoop);
+    size_t readRows(struct evbuffer *input, bool &breakEventLoop);
+    void consumed(int32_t length);
+    char *batch(int32_t length);
+
+    const int64_t m_clientData;
+    boost::shared_ptr<StreamingProcedureCallback> m_callback;
+    boost::shared_ptr<SchemaCache> m_schemas;
+    InvocationResponse m_response;
+    State m_state;
+    bool m_abandoned;
+    bool m_malformed;
+    // whether the exception being passed on by read() was thrown by the callback
+    bool m_callbackFailed;
+    // bytes of the message and of the current table not consumed yet
+    int32_t m_remaining;
+    int32_t m_tableRemaining;
+    size_t m_tableCount;
+    size_t m_tableIndex;
+    Table m_table;
+    int32_t m_rowsRemaining;
+    boost::shared_array<char> m_batch;
+    int32_t m_batchCapacity;
+};
+}
+
+#endif /* VOLTDB_RESPONSESTREAM_H_ */
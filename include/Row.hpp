@@ -26,6 +26,7 @@
 
 #include "ByteBuffer.hpp"
 #include "Column.hpp"
+#include "ColumnNameIndex.hpp"
 #include <string>
 #include <vector>
 #include "Exception.hpp"
@@ -45,15 +46,23 @@ namespace voltdb {
  * from. Retain references with care to avoid memory leaks.
  */
 class Row {
+    friend class RowCursor;
+    friend class TableTest;
 public:
     /*
      * Construct a row from a buffer containing the row data.
      */
 #ifdef SWIG
-    %ignore Row(SharedByteBuffer rowData, boost::shared_ptr<std::vector<voltdb::Column> > columns);
+    %ignore Row(SharedByteBuffer rowData, boost::shared_ptr<std::vector<voltdb::Column> > columns,
+                boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex);
 #endif
-    Row(SharedByteBuffer& rowData, boost::shared_ptr<std::vector<voltdb::Column> >& columns) :
-        m_data(rowData), m_columns(columns), m_wasNull(false), m_offsets(columns->size()), m_hasCalculatedOffsets(false) {
+    /*
+     * The by-name getters look names up in the column index when there is one and scan the columns otherwise.
+     */
+    Row(SharedByteBuffer& rowData, boost::shared_ptr<std::vector<voltdb::Column> >& columns,
+        const boost::shared_ptr<const voltdb::ColumnNameIndex>& columnIndex = boost::shared_ptr<const voltdb::ColumnNameIndex>()) :
+        m_data(rowData), m_columns(columns), m_columnIndex(columnIndex), m_wasNull(false), m_offsets(columns->size()),
+        m_hasCalculatedOffsets(false) {
     }
 
     /*
@@ -246,6 +255,45 @@ public:
         return m_data.getString(getOffset(column), m_wasNull);
     }
 
+    /*
+     * Retrieve the value at the specified column index as a view of the string's bytes in the
+     * response, without copying them. The view is valid as long as the table is alive.
+     * The type of the column must be STRING.
+     * @throws InvalidColumnException The index of the column was invalid or the type of the column does
+     * not match the type of the get method.
+     * @return View of the string at the specified column, empty if it is NULL
+     */
+    boost::string_ref getStringRef(int32_t column) throw(voltdb::InvalidColumnException) {
+        validateType(WIRE_TYPE_STRING, column);
+        return m_data.getStringRef(getOffset(column), m_wasNull);
+    }
+
+    /*
+     * Retrieve the value at the specified column index as a view of the bytes in the response,
+     * without copying them. The view is valid as long as the table is alive.
+     * The type of the column must be Varbinary.
+     * @throws InvalidColumnException The index of the column was invalid or the type of the column does
+     * not match the type of the get method.
+     * @return View of the bytes at the specified column, empty if they are NULL
+     */
+    boost::string_ref getVarbinaryRef(int32_t column) throw(voltdb::InvalidColumnException) {
+        validateType(WIRE_TYPE_VARBINARY, column);
+        return m_data.getStringRef(getOffset(column), m_wasNull);
+    }
+
+    /*
+     * Retrieve the value at the specified column index as a view of the serialized geography in
+     * the response, without decoding it. The view is valid as long as the table is alive.
+     * The type of the column must be Geography.
+     * @throws InvalidColumnException The index of the column was invalid or the type of the column does
+     * not match the type of the get method.
+     * @return View of the serialized geography at the specified column, empty if it is NULL
+     */
+    boost::string_ref getGeographyRef(int32_t column) throw(voltdb::InvalidColumnException) {
+        validateType(WIRE_TYPE_GEOGRAPHY, column);
+        return m_data.getStringRef(getOffset(column), m_wasNull);
+    }
+
     /*
      * Retrieve the value at the specified column index as a geographical point.
      *
@@ -300,12 +348,11 @@ public:
         case WIRE_TYPE_FLOAT:
             getDouble(column); break;
         case WIRE_TYPE_STRING:
-            getString(column); break;
+            getStringRef(column); break;
         case WIRE_TYPE_VARBINARY:
-            int out_len;
-            getVarbinary(column, 0, NULL, &out_len); break;
+            getVarbinaryRef(column); break;
         case WIRE_TYPE_GEOGRAPHY:
-            getGeography(column); break;
+            getGeographyRef(column); break;
         case WIRE_TYPE_GEOGRAPHY_POINT:
             getGeographyPoint(column); break;
         default:
@@ -425,6 +472,39 @@ public:
         return getString(getColumnIndexByName(cname));
     }
 
+    /*
+     * Retrieve the value from the column with the specific name as a view of the string's bytes
+     * in the response. The type of the column must be STRING.
+     * @throws InvalidColumnException No column with the specified name exists or the type of the getter
+     * does not match the column type.
+     * @return View of the string at the specified column, empty if it is NULL
+     */
+    boost::string_ref getStringRef(const std::string& cname) throw(voltdb::InvalidColumnException) {
+        return getStringRef(getColumnIndexByName(cname));
+    }
+
+    /*
+     * Retrieve the value from the column with the specific name as a view of the bytes in the
+     * response. The type of the column must be Varbinary.
+     * @throws InvalidColumnException No column with the specified name exists or the type of the getter
+     * does not match the column type.
+     * @return View of the bytes at the specified column, empty if they are NULL
+     */
+    boost::string_ref getVarbinaryRef(const std::string& cname) throw(voltdb::InvalidColumnException) {
+        return getVarbinaryRef(getColumnIndexByName(cname));
+    }
+
+    /*
+     * Retrieve the value from the column with the specific name as a view of the serialized
+     * geography in the response. The type of the column must be Geography.
+     * @throws InvalidColumnException No column with the specified name exists or the type of the getter
+     * does not match the column type.
+     * @return View of the serialized geography at the specified column, empty if it is NULL
+     */
+    boost::string_ref getGeographyRef(const std::string& cname) throw(voltdb::InvalidColumnException) {
+        return getGeographyRef(getColumnIndexByName(cname));
+    }
+
     /*
      * Retrieve the value at the specified column name as a geographical point.
      * This data type is not currently supported by the C++ client so this always
@@ -581,6 +661,13 @@ private:
     }
 
     int32_t getColumnIndexByName(const std::string& name) {
+        if (m_columnIndex) {
+            const int32_t index = m_columnIndex->find(name);
+            if (index < 0) {
+                throw InvalidColumnException(name);
+            }
+            return index;
+        }
         for (int32_t ii = 0; ii < static_cast<ssize_t>(m_columns->size()); ii++) {
             if (m_columns->at(static_cast<size_t>(ii)).name() == name) {
                 return ii;
@@ -659,6 +746,7 @@ private:
 
     SharedByteBuffer m_data;
     boost::shared_ptr<std::vector<voltdb::Column> > m_columns;
+    boost::shared_ptr<const voltdb::ColumnNameIndex> m_columnIndex;
     bool m_wasNull;
     std::vector<int32_t> m_offsets;
     bool m_hasCalculatedOffsets;
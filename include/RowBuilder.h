@@ -43,9 +43,11 @@
 namespace voltdb {
 
 class TableTest;
+class BulkLoader;
 
 class RowBuilder {
 friend class TableTest;
+friend class BulkLoader;
 private:
     void validateType(WireType type) throw (InvalidColumnException, RowCreationException) {
         if (m_currentColumnIndex >= m_columns.size()) {
@@ -280,7 +282,7 @@ public:
         return m_currentColumnIndex;
     }
 
-    std::vector<voltdb::Column> columns() const { return m_columns; }
+    const std::vector<voltdb::Column>& columns() const { return m_columns; }
 private:
     std::vector<voltdb::Column> m_columns;
     voltdb::ScopedByteBuffer m_buffer;
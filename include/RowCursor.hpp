@@ -0,0 +1,105 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_ROWCURSOR_HPP_
+#define VOLTDB_ROWCURSOR_HPP_
+
+#include "ByteBuffer.hpp"
+#include "Column.hpp"
+#include <boost/shared_ptr.hpp>
+#include "Row.hpp"
+#include "WireType.h"
+
+namespace voltdb {
+
+/*
+ * A row of a table that is moved from row to row in place. Unlike the rows returned by
+ * TableIterator, advancing the cursor allocates nothing and does not touch the reference count
+ * of the table's buffer, and the column offsets of a schema without variable sized columns are
+ * calculated once for all rows. The values of a row can only be read while the cursor is on it.
+ *
+ *     RowCursor cursor = table.cursor();
+ *     while (cursor.next()) {
+ *         sum += cursor.getInt64(0);
+ *     }
+ */
+class RowCursor : public Row {
+public:
+#ifdef SWIG
+%ignore RowCursor(voltdb::SharedByteBuffer rows,
+            boost::shared_ptr<std::vector<voltdb::Column> > columns,
+            int32_t rowCount,
+            boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex);
+#endif
+    /*
+     * Construct a cursor positioned before the first of the rows with the specified column schema
+     * and row count
+     */
+    RowCursor(
+            voltdb::SharedByteBuffer rows,
+            boost::shared_ptr<std::vector<voltdb::Column> > columns,
+            int32_t rowCount,
+            boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex = boost::shared_ptr<const voltdb::ColumnNameIndex>()) :
+        Row(rows, columns, columnIndex), m_rows(rows), m_rowCount(rowCount), m_currentRow(0), m_fixedWidth(true) {
+        for (std::vector<voltdb::Column>::const_iterator it = columns->begin(); it != columns->end(); ++it) {
+            if (isVariableSized(it->type())) {
+                m_fixedWidth = false;
+            }
+        }
+    }
+
+    /*
+     * Moves the cursor to the next row.
+     * @return true if the cursor is on a row, false if there are no more rows
+     */
+    bool next() {
+        if (m_rowCount <= m_currentRow) {
+            return false;
+        }
+        const int32_t rowLength = m_rows.getInt32();
+        m_data.window(m_rows.bytes() + m_rows.position(), rowLength);
+        m_rows.position(m_rows.position() + rowLength);
+        m_currentRow++;
+        m_wasNull = false;
+        // every row of a fixed width schema has the offsets of the first
+        if (!m_fixedWidth) {
+            m_hasCalculatedOffsets = false;
+        }
+        return true;
+    }
+
+    /*
+     * Index of the row the cursor is on, -1 before the first call to next()
+     */
+    int32_t rowIndex() const {
+        return m_currentRow - 1;
+    }
+
+private:
+    voltdb::SharedByteBuffer m_rows;
+    int32_t m_rowCount;
+    int32_t m_currentRow;
+    bool m_fixedWidth;
+};
+}
+#endif /* VOLTDB_ROWCURSOR_HPP_ */
@@ -0,0 +1,84 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_SCHEMACACHE_H_
+#define VOLTDB_SCHEMACACHE_H_
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/unordered_map.hpp>
+#include "Column.hpp"
+#include "ColumnNameIndex.hpp"
+
+namespace voltdb {
+
+/*
+ * Interns the schemas of result tables. A procedure returns the same schema with every response, so
+ * tables whose serialized schema (column count, types and names) is byte for byte identical share one
+ * column vector and name index instead of each decoding its own. The shared vectors must not be modified.
+ * Safe to use from several threads.
+ */
+class SchemaCache {
+public:
+    SchemaCache() : m_size(0) {}
+
+    /*
+     * A decoded schema, its columns and the index of their names
+     */
+    struct Schema {
+        boost::shared_ptr<std::vector<voltdb::Column> > m_columns;
+        boost::shared_ptr<const voltdb::ColumnNameIndex> m_columnIndex;
+    };
+
+    /*
+     * Decoded schema serialized in the specified bytes, with NULL columns if it was not interned
+     */
+    Schema find(const char *schema, int32_t length);
+
+    /*
+     * Shares the schema decoded from the specified bytes with tables of the same schema. The
+     * cache is emptied when it is full, so that schemas that are no longer returned are dropped.
+     */
+    void insert(const char *schema, int32_t length, const Schema &decoded);
+
+    size_t size();
+
+    static const size_t MAX_SCHEMAS = 1024;
+
+private:
+    struct Entry {
+        std::string m_schema;
+        Schema m_decoded;
+    };
+
+    // entries by hash of the serialized schema
+    boost::unordered_map<int32_t, std::vector<Entry> > m_schemas;
+    size_t m_size;
+    // the schema found last, consecutive responses usually share it
+    Entry m_last;
+    boost::mutex m_lock;
+};
+}
+
+#endif /* VOLTDB_SCHEMACACHE_H_ */
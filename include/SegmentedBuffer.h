@@ -0,0 +1,94 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_SEGMENTEDBUFFER_H_
+#define VOLTDB_SEGMENTEDBUFFER_H_
+#include <stdint.h>
+#include <vector>
+#include <boost/shared_array.hpp>
+#include "ByteBuffer.hpp"
+#include "Exception.hpp"
+
+struct evbuffer;
+
+namespace voltdb {
+
+/*
+ * A message held in the chunks it arrived in rather than in one allocation. The chunks are taken
+ * over from libevent's input buffer and stay alive as long as the buffer or anything sliced from it,
+ * e.g. the rows of a table, does. Bytes that lie within one chunk are shared, bytes spanning chunks
+ * are copied.
+ */
+class SegmentedBuffer {
+public:
+    /*
+     * Takes the first length bytes of the input. libevent moves its chunks over where it can and
+     * only copies the part of a chunk the message ends in.
+     * @throws LibEventException The input holds less than length bytes
+     */
+    SegmentedBuffer(struct evbuffer *input, int32_t length) throw (LibEventException);
+
+    int32_t length() const {
+        return m_length;
+    }
+
+    /*
+     * Number of chunks the bytes are split into
+     */
+    size_t segmentCount() const {
+        return m_segments.size();
+    }
+
+    /*
+     * Returns true if the length bytes at offset lie within one segment
+     */
+    bool contiguous(int32_t offset, int32_t length) const;
+
+    /*
+     * Copies length bytes at offset to storage
+     */
+    void get(int32_t offset, char *storage, int32_t length) const throw (IndexOutOfBoundsException);
+
+    int32_t getInt32(int32_t offset) const throw (IndexOutOfBoundsException);
+
+    /*
+     * Returns length bytes at offset, sharing the chunk they lie in or copied if they span chunks
+     */
+    SharedByteBuffer slice(int32_t offset, int32_t length) const throw (IndexOutOfBoundsException);
+
+private:
+    /*
+     * Index of the chunk holding the byte at offset
+     */
+    size_t segmentAt(int32_t offset) const;
+
+    // owns the chain of chunks, frees it with the last reference
+    boost::shared_array<char> m_ref;
+    std::vector<char*> m_segments;
+    // offset of every chunk followed by the length
+    std::vector<int32_t> m_offsets;
+    int32_t m_length;
+};
+}
+
+#endif /* VOLTDB_SEGMENTEDBUFFER_H_ */
@@ -0,0 +1,68 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef VOLTDB_STREAMINGPROCEDURECALLBACK_HPP_
+#define VOLTDB_STREAMINGPROCEDURECALLBACK_HPP_
+#include <cstddef>
+#include <stdint.h>
+#include "ProcedureCallback.hpp"
+#include "Row.hpp"
+#include "Table.h"
+
+namespace voltdb {
+
+/*
+ * Callback receiving the result tables of a response as the bytes arrive instead of once the whole
+ * message was buffered. The schema of each result table is handed to table() as soon as it arrived
+ * and its rows to row() in batches as they complete, so the client never holds more than a batch of
+ * rows of a response and the application can process them while the rest is still being transferred.
+ *
+ * callback() is invoked last, with the status of the response and no result tables. If the connection
+ * is lost or the invocation times out before the response completed it is invoked with that response
+ * instead, and no further rows are delivered. If table() or row() throw, the exception is passed to the
+ * status listener like those thrown by callback(), the rest of the response is skipped and callback()
+ * is not invoked.
+ */
+class StreamingProcedureCallback : public ProcedureCallback {
+public:
+    /*
+     * Invoked when the schema of a result table arrived, before its rows.
+     * @param index Index of the table among the results of the response
+     * @param schema Table with the columns of the result table and no rows
+     * @param rowCount Number of rows that will be passed to row()
+     * @return true if the event loop should break once the bytes received so far were processed
+     */
+    virtual bool table(size_t index, const Table &schema, int32_t rowCount) {
+        return false;
+    }
+
+    /*
+     * Invoked for every row of a result table once it arrived. The row is only valid during the call.
+     * @param index Index of the table among the results of the response
+     * @return true if the event loop should break once the bytes received so far were processed
+     */
+    virtual bool row(size_t index, Row &row) = 0;
+};
+}
+
+#endif /* VOLTDB_STREAMINGPROCEDURECALLBACK_HPP_ */
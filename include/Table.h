@@ -25,7 +25,9 @@
 #define VOLTDB_TABLE_H_
 
 #include "ByteBuffer.hpp"
+#include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <vector>
 #include "Column.hpp"
 #include <sstream>
@@ -33,19 +35,37 @@
 
 namespace voltdb {
 class TableIterator;
+class Row;
+class RowCursor;
 class RowBuilder;
+class SchemaCache;
+class ColumnNameIndex;
+class SegmentedBuffer;
 
 /*
  * Reprentation of result tables returns by VoltDB.
  */
 class Table {
     friend class TableTest;
+    friend class ColumnarTable;
+    friend class ResponseStream;
 public:
     /*
      * Construct a table from a shared buffer. The table retains a reference
      * to the shared buffer indefinitely so watch out for unwanted memory retension.
+     * With a schema cache, tables of the same schema share their columns.
      */
-    Table(SharedByteBuffer buffer);
+    Table(SharedByteBuffer buffer, SchemaCache *schemas = NULL);
+
+    /*
+     * Construct a table from length bytes at offset in a segmented buffer. A table within one
+     * segment shares it like any other buffer. The rows of a table spanning segments stay where they
+     * are and are iterated with iterator(), only a row spanning segments is copied. Anything else
+     * reading the rows, e.g. cursor(), the row index or serialization, first copies the table into
+     * one buffer, made once and shared by all copies of the table.
+     */
+    Table(const boost::shared_ptr<SegmentedBuffer> &segments, int32_t offset, int32_t length,
+          SchemaCache *schemas = NULL) throw (OverflowUnderflowException, IndexOutOfBoundsException);
     Table(const std::vector<Column> &columns) throw (TableException);
     Table() {}
 
@@ -57,6 +77,35 @@ public:
      */
     TableIterator iterator() const;
 
+    /*
+     * Returns a cursor positioned before the first row, which is advanced in place
+     * instead of creating a row per row (see RowCursor)
+     */
+    RowCursor cursor() const;
+
+    /*
+     * Records where every row starts in one pass over the table, for random access with row().
+     * Adding a row drops the index.
+     */
+    void buildRowIndex() throw (OverflowUnderflowException, IndexOutOfBoundsException);
+
+    /*
+     * Returns the row at the specified index. The row index must have been built.
+     * @throws TableException The row index was not built
+     * @throws IndexOutOfBoundsException There is no row at the index
+     */
+    Row row(int32_t index) const throw (TableException, IndexOutOfBoundsException);
+
+    /*
+     * Calls the function with the index and the content of every row, splitting the rows into
+     * contiguous ranges processed on the specified number of threads, the calling thread being one
+     * of them. Uses as many threads as the hardware runs concurrently when threads is not positive.
+     * The function is called concurrently and the row it is passed is only valid during the call.
+     * Uses the row index if it was built and finds the ranges with a pass over the table otherwise.
+     * The first exception thrown by the function is rethrown once all the threads are done.
+     */
+    void parallelForEachRow(int32_t threads, const boost::function<void (int32_t, Row&)> &function) const;
+
     /*
      * Returns the status code associated with this table that was set by the stored procedure.
      * Default value if not set is -128
@@ -85,6 +134,12 @@ public:
      */
     int32_t columnCount() const;
 
+    /*
+     * Resolves a column name to its index once, for by-index access to the rows of the table
+     * @throws InvalidColumnException No column has the name
+     */
+    int32_t columnIndex(const std::string &name) const throw (InvalidColumnException);
+
     /*
      * Returns a string representation of this table and all of its rows.
      */
@@ -120,10 +175,36 @@ public:
     const static int8_t DEFAULT_STATUS_CODE;
 private:
     void validateRowScehma(const std::vector<Column>& schema) const throw (InCompatibleSchemaException);
+    boost::shared_ptr<const std::vector<int32_t> > findRowOffsets() const throw (OverflowUnderflowException, IndexOutOfBoundsException);
+    void ensureContiguous() const;
+    boost::shared_ptr<SegmentedBuffer> spannedSegments() const;
+
+    /*
+     * Rows of a table spanning segments, shared by the copies of the table so that they are
+     * copied into one buffer at most once
+     */
+    struct SpannedRows {
+        SpannedRows(const boost::shared_ptr<SegmentedBuffer> &segments, int32_t offset, int32_t length) :
+            m_segments(segments), m_offset(offset), m_length(length) {}
+
+        boost::mutex m_lock;
+        // released once the rows are copied into m_contiguous
+        boost::shared_ptr<SegmentedBuffer> m_segments;
+        const int32_t m_offset;
+        const int32_t m_length;
+        SharedByteBuffer m_contiguous;
+    };
+
     boost::shared_ptr<std::vector<voltdb::Column> > m_columns;
+    // index of the column names of a schema interned in a SchemaCache, NULL for other tables
+    boost::shared_ptr<const voltdb::ColumnNameIndex> m_columnIndex;
+    // offset of every row in the buffer followed by the end of the last row, see buildRowIndex()
+    boost::shared_ptr<const std::vector<int32_t> > m_rowOffsets;
     int32_t m_rowCountPosition;
     int32_t m_rowCount;
     mutable voltdb::SharedByteBuffer m_buffer;
+    // rows of a table spanning segments, m_buffer then only holds the header through the row count
+    mutable boost::shared_ptr<SpannedRows> m_spanned;
 };
 }
 
@@ -29,6 +29,7 @@
 #include <boost/shared_ptr.hpp>
 #include "Row.hpp"
 #include "Exception.hpp"
+#include "SegmentedBuffer.h"
 
 namespace voltdb {
 class Table;
@@ -46,20 +47,43 @@ public:
 #ifdef SWIG
 %ignore TableIterator(voltdb::SharedByteBuffer rows,
             boost::shared_ptr<std::vector<voltdb::Column> > columns,
-            int32_t rowCount);
+            int32_t rowCount,
+            boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex);
 #endif
     TableIterator(
             voltdb::SharedByteBuffer rows,
             boost::shared_ptr<std::vector<voltdb::Column> > columns,
-            int32_t rowCount) :
-        m_buffer(rows), m_columns(columns), m_rowCount(rowCount), m_currentRow(0) {}
+            int32_t rowCount,
+            boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex = boost::shared_ptr<const voltdb::ColumnNameIndex>()) :
+        m_buffer(rows), m_columns(columns), m_columnIndex(columnIndex), m_rowCount(rowCount), m_currentRow(0),
+        m_segmentsOffset(0) {}
+
+#ifdef SWIG
+%ignore TableIterator(boost::shared_ptr<voltdb::SegmentedBuffer> segments,
+            int32_t offset,
+            boost::shared_ptr<std::vector<voltdb::Column> > columns,
+            int32_t rowCount,
+            boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex);
+#endif
+    /*
+     * Construct an iterator for the table rows starting at offset in a segmented buffer. A row
+     * within one segment shares it, a row spanning segments is copied.
+     */
+    TableIterator(
+            boost::shared_ptr<voltdb::SegmentedBuffer> segments,
+            int32_t offset,
+            boost::shared_ptr<std::vector<voltdb::Column> > columns,
+            int32_t rowCount,
+            boost::shared_ptr<const voltdb::ColumnNameIndex> columnIndex = boost::shared_ptr<const voltdb::ColumnNameIndex>()) :
+        m_columns(columns), m_columnIndex(columnIndex), m_rowCount(rowCount), m_currentRow(0),
+        m_segments(segments), m_segmentsOffset(offset) {}
 
     /*
      * Returns true if the table has more rows that can be retrieved via invoking next and false otherwise.
      */
     bool hasNext() {
         if (m_currentRow < m_rowCount) {
-            assert(m_buffer.hasRemaining());
+            assert(m_segments || m_buffer.hasRemaining());
             return true;
         }
         return false;
@@ -74,20 +98,30 @@ public:
         if (m_rowCount <= m_currentRow) {
             throw NoMoreRowsException();
         }
+        if (m_segments) {
+            const int32_t rowLength = m_segments->getInt32(m_segmentsOffset);
+            SharedByteBuffer buffer = m_segments->slice(m_segmentsOffset + 4, rowLength);
+            m_segmentsOffset += 4 + rowLength;
+            m_currentRow++;
+            return voltdb::Row(buffer, m_columns, m_columnIndex);
+        }
         int32_t rowLength = m_buffer.getInt32();
         int32_t oldLimit = m_buffer.limit();
         m_buffer.limit(m_buffer.position() + rowLength);
         SharedByteBuffer buffer = m_buffer.slice();
         m_buffer.limit(oldLimit);
         m_currentRow++;
-        return voltdb::Row(buffer, m_columns);
+        return voltdb::Row(buffer, m_columns, m_columnIndex);
     }
 
 private:
     voltdb::SharedByteBuffer m_buffer;
     boost::shared_ptr<std::vector<voltdb::Column> > m_columns;
+    boost::shared_ptr<const voltdb::ColumnNameIndex> m_columnIndex;
     int32_t m_rowCount;
     int32_t m_currentRow;
+    boost::shared_ptr<voltdb::SegmentedBuffer> m_segments;
+    int32_t m_segmentsOffset;
 };
 }
 #endif /* VOLTDB_TABLEITERATOR_H_ */
@@ -47,6 +47,8 @@
 
 
 #include <stdint.h>
+#include <stddef.h>
+#include <map>
 namespace voltdb {
 
 
@@ -76,6 +78,35 @@ class TheHashinator {
      * pick a partition to store the data
      */
     virtual int32_t hashinate(const char *string, int32_t length) const = 0;
+
+    /*
+     * Pick the partitions of count long values, partitions[i] is the partition
+     * of values[i]. Implementations hash and look up the keys in bulk, avoiding
+     * a virtual call per key.
+     */
+    virtual void hashinateBatch(const int64_t *values, size_t count, int32_t *partitions) const {
+        for (size_t ii = 0; ii < count; ii++) {
+            partitions[ii] = hashinate(values[ii]);
+        }
+    }
+
+    /*
+     * Pick the partitions of count pieces of UTF-8 encoded character data OR binary data,
+     * partitions[i] is the partition of the lengths[i] bytes at keys[i]
+     */
+    virtual void hashinateBatch(const char * const *keys, const int32_t *lengths, size_t count, int32_t *partitions) const {
+        for (size_t ii = 0; ii < count; ii++) {
+            partitions[ii] = hashinate(keys[ii], lengths[ii]);
+        }
+    }
+
+    /*
+     * How many of the 2^32 hashes each partition owns, partitions owning none are left out.
+     * Empty unless the hashinator places hashes on a ring.
+     */
+    virtual void ringShares(std::map<int32_t, uint64_t> &shares) const {
+        shares.clear();
+    }
 };
 
 } // namespace voltdb
@@ -0,0 +1,152 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef VOLTDB_TYPEDPROCEDURE_HPP_
+#define VOLTDB_TYPEDPROCEDURE_HPP_
+#include <string>
+#include <vector>
+#include "Procedure.hpp"
+#include "Parameter.hpp"
+#include "ParameterSet.hpp"
+#include "Decimal.hpp"
+#include "WireType.h"
+
+namespace voltdb {
+
+/*
+ * Compile time mapping from a C++ parameter type to its wire type, encoded size and encoding.
+ * Only the types below are supported, using any other type with TypedProcedure fails to compile.
+ */
+template <typename T> struct TypedParameter;
+
+template <> struct TypedParameter<int8_t> {
+    static const WireType type = WIRE_TYPE_TINYINT;
+    static int32_t size(int8_t) { return 1 + 1; }
+    static void encode(ByteBuffer &buffer, int8_t val) {
+        buffer.putInt8(WIRE_TYPE_TINYINT);
+        buffer.putInt8(val);
+    }
+};
+
+template <> struct TypedParameter<int16_t> {
+    static const WireType type = WIRE_TYPE_SMALLINT;
+    static int32_t size(int16_t) { return 1 + 2; }
+    static void encode(ByteBuffer &buffer, int16_t val) {
+        buffer.putInt8(WIRE_TYPE_SMALLINT);
+        buffer.putInt16(val);
+    }
+};
+
+template <> struct TypedParameter<int32_t> {
+    static const WireType type = WIRE_TYPE_INTEGER;
+    static int32_t size(int32_t) { return 1 + 4; }
+    static void encode(ByteBuffer &buffer, int32_t val) {
+        buffer.putInt8(WIRE_TYPE_INTEGER);
+        buffer.putInt32(val);
+    }
+};
+
+template <> struct TypedParameter<int64_t> {
+    static const WireType type = WIRE_TYPE_BIGINT;
+    static int32_t size(int64_t) { return 1 + 8; }
+    static void encode(ByteBuffer &buffer, int64_t val) {
+        buffer.putInt8(WIRE_TYPE_BIGINT);
+        buffer.putInt64(val);
+    }
+};
+
+template <> struct TypedParameter<double> {
+    static const WireType type = WIRE_TYPE_FLOAT;
+    static int32_t size(double) { return 1 + 8; }
+    static void encode(ByteBuffer &buffer, double val) {
+        buffer.putInt8(WIRE_TYPE_FLOAT);
+        buffer.putDouble(val);
+    }
+};
+
+template <> struct TypedParameter<Decimal> {
+    static const WireType type = WIRE_TYPE_DECIMAL;
+    static int32_t size(const Decimal &) { return 1 + static_cast<int32_t>(sizeof(Decimal)); }
+    static void encode(ByteBuffer &buffer, const Decimal &val) {
+        buffer.putInt8(WIRE_TYPE_DECIMAL);
+        val.serializeTo(&buffer);
+    }
+};
+
+template <> struct TypedParameter<std::string> {
+    static const WireType type = WIRE_TYPE_STRING;
+    static int32_t size(const std::string &val) { return 1 + 4 + static_cast<int32_t>(val.size()); }
+    static void encode(ByteBuffer &buffer, const std::string &val) {
+        buffer.putInt8(WIRE_TYPE_STRING);
+        buffer.putString(val);
+    }
+};
+
+template <> struct TypedParameter<buffer_t> {
+    static const WireType type = WIRE_TYPE_VARBINARY;
+    static int32_t size(const buffer_t &val) { return 1 + 4 + static_cast<int32_t>(val.size()); }
+    static void encode(ByteBuffer &buffer, const buffer_t &val) {
+        buffer.putInt8(WIRE_TYPE_VARBINARY);
+        buffer.putBytes(static_cast<int32_t>(val.size()), val.data());
+    }
+};
+
+/*
+ * A Procedure whose signature is fixed at compile time, e.g.
+ *
+ *     TypedProcedure<int64_t, int8_t, std::string> vote("Vote");
+ *     client.invoke(vote.bind(phoneNumber, state, contestant), callback);
+ *
+ * bind() sets every parameter in one call: the exact size of the payload is computed up front
+ * and the parameters are written without the per parameter type validation and buffer
+ * growth checks of ParameterSet. A TypedProcedure is invoked like any other Procedure.
+ */
+template <typename... Args>
+class TypedProcedure : public Procedure {
+public:
+    explicit TypedProcedure(const std::string &name) : Procedure(name, signature()) {}
+
+    TypedProcedure& bind(const Args&... args) {
+        const int32_t sizes[] = { 0, TypedParameter<Args>::size(args)... };
+        int32_t size = 0;
+        for (size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ii++) {
+            size += sizes[ii];
+        }
+        ByteBuffer &buffer = beginEncodedParameters(size);
+        // braced initializers are evaluated in order, so the parameters are encoded left to right
+        const int encoded[] = { 0, (TypedParameter<Args>::encode(buffer, args), 0)... };
+        (void)encoded;
+        endEncodedParameters(sizes + 1);
+        return *this;
+    }
+
+    static std::vector<Parameter> signature() {
+        const WireType types[] = { WIRE_TYPE_INVALID, TypedParameter<Args>::type... };
+        return std::vector<Parameter>(types + 1, types + sizeof(types) / sizeof(types[0]));
+    }
+};
+
+}
+
+#endif /* VOLTDB_TYPEDPROCEDURE_HPP_ */
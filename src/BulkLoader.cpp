@@ -0,0 +1,317 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "BulkLoader.h"
+#include "ClientImpl.h"
+#include <cassert>
+#include <event2/event.h>
+
+namespace voltdb {
+
+const int32_t BulkLoader::REPLICATED = -1;
+const int32_t BulkLoader::DEFAULT_BATCH_SIZE = 200;
+
+/*
+ * Serialized size of the values of fixed size column types, see Row
+ */
+static int32_t fixedColumnSize(WireType type) {
+    switch (type) {
+    case WIRE_TYPE_DECIMAL:
+    case WIRE_TYPE_GEOGRAPHY_POINT:
+        return 16;
+    case WIRE_TYPE_TIMESTAMP:
+    case WIRE_TYPE_BIGINT:
+    case WIRE_TYPE_FLOAT:
+        return 8;
+    case WIRE_TYPE_INTEGER:
+    case WIRE_TYPE_DATE:
+        return 4;
+    case WIRE_TYPE_SMALLINT:
+        return 2;
+    case WIRE_TYPE_TINYINT:
+        return 1;
+    default:
+        assert(false);
+        return 0;
+    }
+}
+
+static std::vector<Parameter> singlePartitionLoadParameters() {
+    std::vector<Parameter> parameters;
+    parameters.push_back(Parameter(WIRE_TYPE_VARBINARY));
+    parameters.push_back(Parameter(WIRE_TYPE_STRING));
+    parameters.push_back(Parameter(WIRE_TYPE_TINYINT));
+    parameters.push_back(Parameter(WIRE_TYPE_VOLTTABLE));
+    return parameters;
+}
+
+static std::vector<Parameter> multiPartitionLoadParameters() {
+    std::vector<Parameter> parameters;
+    parameters.push_back(Parameter(WIRE_TYPE_STRING));
+    parameters.push_back(Parameter(WIRE_TYPE_TINYINT));
+    parameters.push_back(Parameter(WIRE_TYPE_VOLTTABLE));
+    return parameters;
+}
+
+static void bulkLoaderFlushTimer(evutil_socket_t fd, short events, void *ctx) {
+    BulkLoader *loader = reinterpret_cast<BulkLoader*>(ctx);
+    loader->flushTimerExpired();
+}
+
+/*
+ * Callback of a load invocation, reports the outcome for the rows of the batch
+ */
+class LoadCallback : public ProcedureCallback {
+public:
+    LoadCallback(const boost::shared_ptr<BulkLoaderCallback> &callback, const Table &rows) :
+        m_callback(callback), m_rows(rows) {}
+
+    bool callback(InvocationResponse response) throw (Exception) {
+        if (response.success()) {
+            m_callback->success(m_rows.rowCount());
+        } else {
+            m_callback->failure(m_rows, response);
+        }
+        return false;
+    }
+
+    bool allowAbandon() const {
+        return false;
+    }
+
+private:
+    const boost::shared_ptr<BulkLoaderCallback> m_callback;
+    const Table m_rows;
+};
+
+BulkLoader::BulkLoader(Client &client,
+                       const std::string &tableName,
+                       const std::vector<Column> &schema,
+                       int32_t partitionColumn,
+                       boost::shared_ptr<BulkLoaderCallback> callback,
+                       int32_t batchSize,
+                       int32_t flushIntervalMillis,
+                       bool upsert) throw (Exception, InvalidColumnException, LibEventException) :
+        m_impl(client.m_impl), m_tableName(tableName), m_schema(schema), m_partitionColumn(partitionColumn),
+        m_callback(callback), m_batchSize(batchSize > 0 ? batchSize : 1), m_upsertMode(upsert ? 1 : 0),
+        m_singlePartitionLoad("@LoadSinglepartitionTable", singlePartitionLoadParameters()),
+        m_multiPartitionLoad("@LoadMultipartitionTable", multiPartitionLoadParameters()),
+        m_pendingRows(0), m_flushTimer(NULL) {
+    if (m_callback.get() == NULL) {
+        throw NullPointerException();
+    }
+    if (m_partitionColumn != REPLICATED) {
+        if (m_partitionColumn < 0 || static_cast<size_t>(m_partitionColumn) >= m_schema.size()) {
+            throw InvalidColumnException(static_cast<size_t>(m_partitionColumn), m_schema.size());
+        }
+        const Column &column = m_schema[static_cast<size_t>(m_partitionColumn)];
+        switch (column.type()) {
+        case WIRE_TYPE_TINYINT:
+        case WIRE_TYPE_SMALLINT:
+        case WIRE_TYPE_INTEGER:
+        case WIRE_TYPE_BIGINT:
+        case WIRE_TYPE_STRING:
+        case WIRE_TYPE_VARBINARY:
+            break;
+        default:
+            throw InvalidColumnException(column.name(), column.type(), wireTypeToString(column.type()),
+                                         "TINYINT, SMALLINT, INTEGER, BIGINT, STRING or VARBINARY");
+        }
+    }
+
+    if (flushIntervalMillis > 0) {
+        m_flushTimer = event_new(m_impl->m_base, -1, EV_PERSIST, bulkLoaderFlushTimer, this);
+        if (m_flushTimer == NULL) {
+            throw LibEventException("BulkLoader: event_new failed for the flush timer");
+        }
+        struct timeval interval;
+        interval.tv_sec = flushIntervalMillis / 1000;
+        interval.tv_usec = (flushIntervalMillis % 1000) * 1000;
+        if (event_add(m_flushTimer, &interval) != 0) {
+            event_free(m_flushTimer);
+            throw LibEventException("BulkLoader: event_add failed for the flush timer");
+        }
+    }
+}
+
+BulkLoader::~BulkLoader() {
+    if (m_flushTimer != NULL) {
+        event_free(m_flushTimer);
+    }
+    try {
+        flush();
+    } catch (const std::exception &e) {
+        m_impl->logMessage(ClientLogger::ERROR, std::string("BulkLoader: dropped rows failing to flush them: ") + e.what());
+    }
+}
+
+int32_t BulkLoader::partitionForRow(RowBuilder &row, std::string &key) {
+    if (m_partitionColumn == REPLICATED) {
+        return Distributer::MP_INIT_PID;
+    }
+
+    // Skip over the values preceding the partitioning column in the row's serialized data
+    ByteBuffer &data = row.m_buffer;
+    int32_t offset = 0;
+    for (size_t ii = 0; ii < static_cast<size_t>(m_partitionColumn); ii++) {
+        const WireType type = m_schema[ii].type();
+        if (isVariableSized(type)) {
+            const int32_t length = data.getInt32(offset);
+            offset += 4 + (length > 0 ? length : 0);
+        } else {
+            offset += fixedColumnSize(type);
+        }
+    }
+
+    const Distributer &distributer = m_impl->m_distributer;
+    int64_t value = 0;
+    switch (m_schema[static_cast<size_t>(m_partitionColumn)].type()) {
+    case WIRE_TYPE_TINYINT:
+        value = data.getInt8(offset);
+        if (value == INT8_MIN) {
+            return Distributer::MP_INIT_PID;
+        }
+        break;
+    case WIRE_TYPE_SMALLINT:
+        value = data.getInt16(offset);
+        if (value == INT16_MIN) {
+            return Distributer::MP_INIT_PID;
+        }
+        break;
+    case WIRE_TYPE_INTEGER:
+        value = data.getInt32(offset);
+        if (value == INT32_MIN) {
+            return Distributer::MP_INIT_PID;
+        }
+        break;
+    case WIRE_TYPE_BIGINT:
+        value = data.getInt64(offset);
+        if (value == INT64_MIN) {
+            return Distributer::MP_INIT_PID;
+        }
+        break;
+    default: {
+        // STRING or VARBINARY, validated by the constructor
+        const int32_t length = data.getInt32(offset);
+        if (length < 0) {
+            return Distributer::MP_INIT_PID;
+        }
+        const char *bytes = data.bytes() + offset + 4;
+        const int32_t partitionId = distributer.hashinate(bytes, length);
+        if (partitionId < 0) {
+            return Distributer::MP_INIT_PID;
+        }
+        key.assign(bytes, static_cast<size_t>(length));
+        return partitionId;
+    }
+    }
+
+    const int32_t partitionId = distributer.hashinate(value);
+    if (partitionId < 0) {
+        return Distributer::MP_INIT_PID;
+    }
+    // The server hashes integer partitioning values as 8 byte little endian longs
+    char encoded[sizeof(int64_t)];
+    for (size_t ii = 0; ii < sizeof(int64_t); ii++) {
+        encoded[ii] = static_cast<char>(static_cast<uint64_t>(value) >> (8 * ii));
+    }
+    key.assign(encoded, sizeof(encoded));
+    return partitionId;
+}
+
+void BulkLoader::insertRow(RowBuilder &row) throw (Exception, NoConnectionsException, UninitializedParamsException,
+                                                   LibEventException, ElasticModeMismatchException,
+                                                   InCompatibleSchemaException, UninitializedColumnException) {
+    if (row.columns() != m_schema) {
+        throw InCompatibleSchemaException();
+    }
+    if (static_cast<size_t>(row.numberOfPopulatedColumns()) != m_schema.size()) {
+        throw UninitializedColumnException(m_schema.size(), row.numberOfPopulatedColumns());
+    }
+
+    std::string key;
+    const int32_t partitionId = partitionForRow(row, key);
+    boost::shared_ptr<Batch> &batch = m_batches[partitionId];
+    if (batch.get() == NULL) {
+        batch.reset(new Batch(m_schema));
+    }
+    if (batch->m_rows.rowCount() == 0) {
+        batch->m_partitionKey = key;
+    }
+    batch->m_rows.addRow(row);
+    ++m_pendingRows;
+
+    if (batch->m_rows.rowCount() >= m_batchSize) {
+        flushBatch(partitionId, *batch);
+    }
+}
+
+void BulkLoader::flush() throw (Exception, NoConnectionsException, UninitializedParamsException,
+                                LibEventException, ElasticModeMismatchException) {
+    for (BatchMap::iterator it = m_batches.begin(); it != m_batches.end(); ++it) {
+        if (it->second->m_rows.rowCount() > 0) {
+            flushBatch(it->first, *it->second);
+        }
+    }
+}
+
+void BulkLoader::flushTimerExpired() {
+    // The timer fires inside the event loop, which can't be entered again to wait out backpressure
+    const bool ignoreBackpressure = m_impl->m_ignoreBackpressure;
+    m_impl->m_ignoreBackpressure = true;
+    try {
+        flush();
+    } catch (const std::exception &e) {
+        m_impl->logMessage(ClientLogger::ERROR, std::string("BulkLoader: failed flushing batches: ") + e.what());
+    }
+    m_impl->m_ignoreBackpressure = ignoreBackpressure;
+}
+
+void BulkLoader::flushBatch(int32_t partitionId, Batch &batch) throw (Exception, NoConnectionsException, UninitializedParamsException,
+                                                                      LibEventException, ElasticModeMismatchException) {
+    // Start a new batch before invoking, callbacks run while waiting out backpressure may insert rows
+    Table rows = batch.m_rows;
+    batch.m_rows = Table(m_schema);
+    m_pendingRows -= rows.rowCount();
+
+    boost::shared_ptr<ProcedureCallback> callback(new LoadCallback(m_callback, rows));
+    try {
+        if (partitionId == Distributer::MP_INIT_PID) {
+            m_multiPartitionLoad.params()->addString(m_tableName).addInt8(m_upsertMode).addTable(rows);
+            m_impl->invoke(m_multiPartitionLoad, callback, partitionId);
+        } else {
+            m_singlePartitionLoad.params()->addBytes(static_cast<int32_t>(batch.m_partitionKey.size()),
+                                                     reinterpret_cast<const uint8_t*>(batch.m_partitionKey.data()))
+                                            .addString(m_tableName).addInt8(m_upsertMode).addTable(rows);
+            m_impl->invoke(m_singlePartitionLoad, callback, partitionId);
+        }
+    } catch (...) {
+        // Keep the rows pending unless the batch was refilled in the meantime
+        if (batch.m_rows.rowCount() == 0) {
+            batch.m_rows = rows;
+            m_pendingRows += rows.rowCount();
+        }
+        throw;
+    }
+}
+
+}
@@ -0,0 +1,185 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <stdint.h>
+#include "ByteSwap.h"
+#include "ByteBuffer.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VOLTDB_BYTESWAP_SIMD
+#include <immintrin.h>
+#endif
+
+namespace voltdb {
+
+namespace {
+
+template <typename T>
+T swap(T value);
+
+template <>
+uint16_t swap(uint16_t value) {
+    return ntohs(value);
+}
+
+template <>
+uint32_t swap(uint32_t value) {
+    return ntohl(value);
+}
+
+template <>
+uint64_t swap(uint64_t value) {
+    return ntohll(value);
+}
+
+template <typename T>
+void scalarSwap(const char *source, char *destination, size_t count) {
+    for (size_t ii = 0; ii < count; ii++) {
+        T value;
+        ::memcpy(&value, source + ii * sizeof(T), sizeof(T));
+        value = swap(value);
+        ::memcpy(destination + ii * sizeof(T), &value, sizeof(T));
+    }
+}
+
+#ifdef VOLTDB_BYTESWAP_SIMD
+/*
+ * Shuffle masks reversing the bytes of every 2, 4 or 8 byte value of a 16 byte lane, twice
+ * for the two lanes of an AVX2 register
+ */
+const char SWAP16_MASK[32] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                               1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+const char SWAP32_MASK[32] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                               3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+const char SWAP64_MASK[32] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                               7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+
+/*
+ * Shuffle whole blocks of bytes, returning how many bytes were converted. The rest are left
+ * to scalarSwap.
+ */
+__attribute__((target("ssse3")))
+size_t ssse3Swap(const char *source, char *destination, size_t bytes, const char *mask) {
+    const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask));
+    size_t ii = 0;
+    for (; ii + 16 <= bytes; ii += 16) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + ii));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + ii), _mm_shuffle_epi8(values, shuffle));
+    }
+    return ii;
+}
+
+__attribute__((target("avx2")))
+size_t avx2Swap(const char *source, char *destination, size_t bytes, const char *mask) {
+    const __m256i shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask));
+    size_t ii = 0;
+    for (; ii + 64 <= bytes; ii += 64) {
+        const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + ii));
+        const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + ii + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + ii), _mm256_shuffle_epi8(first, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + ii + 32), _mm256_shuffle_epi8(second, shuffle));
+    }
+    for (; ii + 32 <= bytes; ii += 32) {
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + ii));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + ii), _mm256_shuffle_epi8(values, shuffle));
+    }
+    return ii;
+}
+#else
+const char *const SWAP16_MASK = NULL;
+const char *const SWAP32_MASK = NULL;
+const char *const SWAP64_MASK = NULL;
+#endif
+
+enum Kernel {
+    KERNEL_SCALAR,
+    KERNEL_SSSE3,
+    KERNEL_AVX2
+};
+
+Kernel detectKernel() {
+#ifdef VOLTDB_BYTESWAP_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return KERNEL_AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return KERNEL_SSSE3;
+    }
+#endif
+    return KERNEL_SCALAR;
+}
+
+Kernel kernel() {
+    static const Kernel detected = detectKernel();
+    return detected;
+}
+
+template <typename T>
+void byteSwap(const void *source, void *destination, size_t count, const char *mask) {
+    const char *from = static_cast<const char*>(source);
+    char *to = static_cast<char*>(destination);
+    size_t converted = 0;
+#ifdef VOLTDB_BYTESWAP_SIMD
+    switch (kernel()) {
+        case KERNEL_AVX2:
+            converted = avx2Swap(from, to, count * sizeof(T), mask);
+            break;
+        case KERNEL_SSSE3:
+            converted = ssse3Swap(from, to, count * sizeof(T), mask);
+            break;
+        default:
+            break;
+    }
+#else
+    (void)mask;
+#endif
+    scalarSwap<T>(from + converted, to + converted, count - converted / sizeof(T));
+}
+
+}
+
+void byteSwap16(const void *source, void *destination, size_t count) {
+    byteSwap<uint16_t>(source, destination, count, SWAP16_MASK);
+}
+
+void byteSwap32(const void *source, void *destination, size_t count) {
+    byteSwap<uint32_t>(source, destination, count, SWAP32_MASK);
+}
+
+void byteSwap64(const void *source, void *destination, size_t count) {
+    byteSwap<uint64_t>(source, destination, count, SWAP64_MASK);
+}
+
+const char *byteSwapKernel() {
+    switch (kernel()) {
+        case KERNEL_AVX2:
+            return "avx2";
+        case KERNEL_SSSE3:
+            return "ssse3";
+        default:
+            return "scalar";
+    }
+}
+}
@@ -74,6 +74,41 @@ void Client::invoke(Procedure &proc,
     m_impl->invoke(proc, callback);
 }
 
+void Client::invokeBatch(const std::vector<Procedure*> &procs,
+                         boost::shared_ptr<BatchCallback> callback) throw (voltdb::Exception,
+                                                                           voltdb::NoConnectionsException,
+                                                                           voltdb::UninitializedParamsException,
+                                                                           voltdb::LibEventException) {
+    m_impl->invokeBatch(procs, callback);
+}
+
+void Client::invokeAllPartitions(Procedure &proc,
+                                 boost::shared_ptr<AllPartitionsCallback> callback) throw (voltdb::Exception,
+                                                                                           voltdb::NoConnectionsException,
+                                                                                           voltdb::UninitializedParamsException,
+                                                                                           voltdb::LibEventException,
+                                                                                           voltdb::AllPartitionsInvocationException) {
+    m_impl->invokeAllPartitions(proc, callback);
+}
+
+void Client::invokeGroupedByPartition(Procedure &proc, const std::vector<int64_t> &keys,
+                                      boost::shared_ptr<GroupedByPartitionCallback> callback) throw (voltdb::Exception,
+                                                                                                     voltdb::NoConnectionsException,
+                                                                                                     voltdb::UninitializedParamsException,
+                                                                                                     voltdb::LibEventException,
+                                                                                                     voltdb::GroupedInvocationException) {
+    m_impl->invokeGroupedByPartition(proc, keys, callback);
+}
+
+void Client::invokeGroupedByPartition(Procedure &proc, const std::vector<std::string> &keys,
+                                      boost::shared_ptr<GroupedByPartitionCallback> callback) throw (voltdb::Exception,
+                                                                                                     voltdb::NoConnectionsException,
+                                                                                                     voltdb::UninitializedParamsException,
+                                                                                                     voltdb::LibEventException,
+                                                                                                     voltdb::GroupedInvocationException) {
+    m_impl->invokeGroupedByPartition(proc, keys, callback);
+}
+
 void Client::runOnce() throw (voltdb::Exception,
                               voltdb::NoConnectionsException,
                               voltdb::LibEventException) {
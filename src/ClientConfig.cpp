@@ -69,7 +69,7 @@ public:
             bool enableQueryTimeout, int timeoutInSeconds, bool useSSL) :
             m_username(username), m_password(password), m_listener(reinterpret_cast<StatusListener*>(NULL)),
             m_maxOutstandingRequests(3000), m_hashScheme(scheme), m_enableAbandon(enableAbandon),
-            m_enableQueryTimeout(enableQueryTimeout), m_useSSL (useSSL) {
+            m_enableQueryTimeout(enableQueryTimeout), m_useSSL (useSSL), m_readFromReplicas(false) {
         m_queryTimeout.tv_sec = timeoutInSeconds;
         m_queryTimeout.tv_usec = 0;
         m_scanIntervalForTimedoutQuery.tv_sec = DEFAULT_SCAN_INTERVAL_FOR_EXPIRED_REQUESTS_SEC;
@@ -83,7 +83,7 @@ public:
             bool enableQueryTimeout, int timeoutInSeconds, bool useSSL) :
             m_username(username), m_password(password), m_listener(new DummyStatusListener(listener)),
             m_maxOutstandingRequests(3000), m_hashScheme(scheme), m_enableAbandon(enableAbandon),
-            m_enableQueryTimeout(enableQueryTimeout), m_useSSL(useSSL) {
+            m_enableQueryTimeout(enableQueryTimeout), m_useSSL(useSSL), m_readFromReplicas(false) {
         m_queryTimeout.tv_sec = timeoutInSeconds;
         m_queryTimeout.tv_usec = 0;
         m_scanIntervalForTimedoutQuery.tv_sec = DEFAULT_SCAN_INTERVAL_FOR_EXPIRED_REQUESTS_SEC;
@@ -97,7 +97,7 @@ public:
             bool enableQueryTimeout, int timeoutInSeconds, bool useSSL) :
                 m_username(username), m_password(password), m_listener(listener),
                 m_maxOutstandingRequests(3000), m_hashScheme(scheme), m_enableAbandon(enableAbandon),
-                m_enableQueryTimeout(enableQueryTimeout), m_useSSL(useSSL) {
+                m_enableQueryTimeout(enableQueryTimeout), m_useSSL(useSSL), m_readFromReplicas(false) {
         m_queryTimeout.tv_sec = timeoutInSeconds;
         m_queryTimeout.tv_usec = 0;
         m_scanIntervalForTimedoutQuery.tv_sec = DEFAULT_SCAN_INTERVAL_FOR_EXPIRED_REQUESTS_SEC;
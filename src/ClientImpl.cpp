@@ -24,6 +24,8 @@
 #include <cassert>
 #include "AuthenticationResponse.hpp"
 #include "AuthenticationRequest.hpp"
+#include "ResponseStream.h"
+#include "SegmentedBuffer.h"
 #include <event2/buffer.h>
 #include <event2/thread.h>
 #include <event2/event.h>
@@ -32,6 +34,10 @@
 #include <openssl/err.h>
 
 #define HIGH_WATERMARK 1024 * 1024 * 55
+// version and client data at the start of a response
+#define RESPONSE_PEEK_LENGTH 9
+// responses from this length on are held in the chunks they arrived in, see SegmentedBuffer
+#define SEGMENTED_RESPONSE_LENGTH 1024 * 1024
 #define RECONNECT_INTERVAL 10
 
 namespace voltdb {
@@ -115,11 +121,17 @@ class CxnContext {
  */
 public:
     CxnContext(const std::string& name, unsigned short port, int hostId) : m_name(name),
-        m_port(port), m_nextLength(4), m_lengthOrMessage(true), m_hostId(hostId) { }
+        m_port(port), m_nextLength(4), m_lengthOrMessage(true), m_streamChecked(false), m_streamingRequests(0),
+        m_hostId(hostId) { }
     const std::string m_name;
     const unsigned short m_port;
     int32_t m_nextLength;
     bool m_lengthOrMessage;
+    // whether the message being received was checked for a streaming callback, and its stream if so
+    bool m_streamChecked;
+    boost::shared_ptr<ResponseStream> m_stream;
+    // outstanding requests with streaming callbacks, responses aren't checked for streaming without any
+    size_t m_streamingRequests;
     int m_hostId;
 };
 
@@ -466,11 +478,13 @@ ClientImpl::ClientImpl(ClientConfig config) throw (Exception, LibEventException,
         m_backPressuredForOutstandingRequests(false),
         m_isDraining(false), m_instanceIdIsSet(false), m_outstandingRequests(0), m_leaderAddress(-1),
         m_clusterStartTime(-1), m_username(config.m_username), m_passwordHash(NULL), m_maxOutstandingRequests(config.m_maxOutstandingRequests),
+        m_readFromReplicas(config.m_readFromReplicas), m_nextReplicaIndex(0), m_partitionKeysVersion(-1),
         m_ignoreBackpressure(false), m_useClientAffinity(true),m_updateHashinator(false), m_enableAbandon(config.m_enableAbandon), m_pendingConnectionSize(0),
         m_enableQueryTimeout(config.m_enableQueryTimeout), m_queryTimeoutMonitorThread(0), m_timerMonitorBase(NULL), m_timerMonitorEventPtr(NULL),
         m_timeoutServiceEventPtr(NULL), m_timerMonitorEventInitialized(false), m_timedoutRequests(0), m_responseHandleNotFound(0),
         m_queryExpirationTime(config.m_queryTimeout), m_scanIntervalForTimedoutQuery(config.m_scanIntervalForTimedoutQuery),
-        m_pLogger(0), m_hashScheme(config.m_hashScheme), m_enableSSL(config.m_useSSL), m_clientSslCtx(NULL) {
+        m_pLogger(0), m_hashScheme(config.m_hashScheme), m_enableSSL(config.m_useSSL), m_clientSslCtx(NULL),
+        m_schemaCache(new SchemaCache()) {
     pthread_once(&once_initLibevent, initLibevent);
 #ifdef DEBUG_EVENTS
     if (!voltdb_clientimpl_debug_init_libevent) {
@@ -689,6 +703,7 @@ void ClientImpl::finalizeAuthentication(PendingConnection* pc) throw (Exception,
         //save event for host id
         int hostId = pc->m_response.getHostId();
         m_hostIdToEvent[hostId] = bev;
+        boost::atomic_store(&m_partitionRouting, boost::shared_ptr<const PartitionRouting>());
         bufferevent_setwatermark( bev, EV_READ, 4, HIGH_WATERMARK);
         m_bevs.push_back(bev);
 
@@ -982,6 +997,7 @@ void ClientImpl::purgeExpiredRequests() {
                         }
                     }
                 }
+                trackStreaming(itr->first, *cbItr->second, true);
                 callbackMap->erase(cbItr);
                 --m_outstandingRequests;
                 ++m_timedoutRequests;
@@ -999,17 +1015,16 @@ InvocationResponse ClientImpl::invoke(Procedure &proc) throw (Exception, NoConne
         throw NoConnectionsException();
     }
 
-    int32_t messageSize = proc.getSerializedSize();
-    ScopedByteBuffer sbb(messageSize);
+    ByteBuffer request = proc.stagedRequest(m_nextRequestId);
     int64_t clientData = m_nextRequestId++;
-    proc.serializeTo(&sbb, clientData);
     struct bufferevent *bev = m_bevs[m_nextConnectionIndex++ % m_bevs.size()];
     InvocationResponse response;
     boost::shared_ptr<ProcedureCallback> callback(new SyncCallback(&response));
     struct evbuffer *evbuf = bufferevent_get_output(bev);
-    if (evbuffer_add(evbuf, sbb.bytes(), static_cast<size_t>(sbb.remaining()))) {
+    if (evbuffer_add(evbuf, request.bytes(), static_cast<size_t>(request.limit()))) {
         throw LibEventException("Synchronous invoke: failed adding data to event buffer");
     }
+    proc.releaseRequest();
     timeval tv, expirationTime;
     int status = gettimeofday(&tv, NULL);
     assert(status == 0);
@@ -1047,27 +1062,118 @@ void ClientImpl::invoke(Procedure &proc, ProcedureCallback *callback) throw (Exc
     invoke(proc, wrapper);
 }
 
-bool ClientImpl::isReadOnly(const Procedure &proc) {
-    ProcedureInfo *procInfo = m_distributer.getProcedure(proc.getName());
+const ProcedureInfo *ClientImpl::resolveProcedure(Procedure &proc) {
+    return resolveProcedure(proc, m_distributer.snapshot());
+}
+
+const ProcedureInfo *ClientImpl::resolveProcedure(Procedure &proc, const boost::shared_ptr<const RoutingSnapshot> &routing) {
+    const int64_t version = routing->m_procedureInfoVersion;
+    if (!proc.m_procInfoPinned && (proc.m_procInfoSource != m_distributer.getId() || proc.m_procInfoVersion != version)) {
+        proc.m_procInfo = Distributer::getProcedure(routing, proc.getName());
+        proc.m_procInfoSource = m_distributer.getId();
+        proc.m_procInfoVersion = version;
+    }
+    return proc.m_procInfo.get();
+}
+
+bool ClientImpl::isReadOnly(Procedure &proc) {
+    const ProcedureInfo *procInfo = resolveProcedure(proc);
     return (procInfo != NULL && procInfo->m_readOnly);
 }
 
-struct bufferevent *ClientImpl::routeProcedure(Procedure &proc, ScopedByteBuffer &sbb){
-    ProcedureInfo *procInfo = m_distributer.getProcedure(proc.getName());
+struct bufferevent *ClientImpl::routeProcedure(Procedure &proc, ByteBuffer &sbb, bool &readOnly, int partitionId){
+    const boost::shared_ptr<const RoutingSnapshot> topology = m_distributer.snapshot();
+    const boost::shared_ptr<const PartitionRouting> routing = partitionRouting(*topology);
+    const ProcedureInfo *procInfo = resolveProcedure(proc, topology);
+    readOnly = procInfo != NULL && procInfo->m_readOnly;
+    if (partitionId >= 0) {
+        return readOnly ? readBevForPartition(*routing, partitionId) : bevForPartition(*routing, partitionId);
+    }
 
     //route transaction to correct event if procedure is found, transaction is single partitioned
-    int hostId = -1;
     if (procInfo && !procInfo->m_multiPart){
-        const int hashedPartition = m_distributer.getHashedPartitionForParameter(sbb, procInfo->m_partitionParameter);
-        if (hashedPartition >= 0) {
-            hostId = m_distributer.getHostIdByPartitionId(hashedPartition);
+        // the parameter set captures where the partitioning parameter starts as it is set,
+        // fall back to decoding the request the first time or when the partitioning changed
+        const int32_t offset = proc.partitionParameterOffset(procInfo->m_partitionParameter);
+        const int hashedPartition = offset >= 0 ?
+                Distributer::getHashedPartitionForParameterAt(*topology, sbb, offset, procInfo->m_partitionParameterType) :
+                Distributer::getHashedPartitionForParameter(*topology, sbb, procInfo->m_partitionParameter,
+                                                            procInfo->m_partitionParameterType);
+        proc.trackPartitionParameter(procInfo->m_partitionParameter);
+        if (hashedPartition < 0) {
+            return NULL;
         }
+        return readOnly ? readBevForPartition(*routing, hashedPartition) : bevForPartition(*routing, hashedPartition);
     }
-    else
-    {
-        //use MIP partition instead
-        hostId = m_distributer.getHostIdByPartitionId(Distributer::MP_INIT_PID);
+    //use MIP partition instead
+    return bevForPartition(*routing, Distributer::MP_INIT_PID);
+}
+
+boost::shared_ptr<const ClientImpl::PartitionRouting> ClientImpl::partitionRouting(const RoutingSnapshot &topology) {
+    boost::shared_ptr<const PartitionRouting> routing = boost::atomic_load(&m_partitionRouting);
+    if (!routing || routing->m_topologyVersion != topology.m_topologyVersion) {
+        // a table built concurrently from the same topology is equivalent, the last one stored wins
+        routing = buildPartitionRouting(topology);
+        boost::atomic_store(&m_partitionRouting, routing);
+    }
+    return routing;
+}
+
+struct bufferevent *ClientImpl::bevForPartition(const PartitionRouting &routing, int partitionId) {
+    if (partitionId == Distributer::MP_INIT_PID) {
+        return routing.m_multiPartitionBev;
+    }
+    if (partitionId < 0 || static_cast<size_t>(partitionId) >= routing.m_partitionToBev.size()) {
+        return NULL;
+    }
+    return routing.m_partitionToBev[static_cast<size_t>(partitionId)];
+}
+
+struct bufferevent *ClientImpl::readBevForPartition(const PartitionRouting &routing, int partitionId) {
+    if (!m_readFromReplicas || partitionId < 0 || static_cast<size_t>(partitionId) >= routing.m_partitionToReplicaBevs.size()
+            || routing.m_partitionToReplicaBevs[static_cast<size_t>(partitionId)].empty()) {
+        return bevForPartition(routing, partitionId);
+    }
+    const std::vector<struct bufferevent *> &replicas = routing.m_partitionToReplicaBevs[static_cast<size_t>(partitionId)];
+    return replicas[m_nextReplicaIndex++ % replicas.size()];
+}
+
+boost::shared_ptr<const ClientImpl::PartitionRouting> ClientImpl::buildPartitionRouting(const RoutingSnapshot &topology) {
+    // partition ids are dense from 0, the multi partition initiator's id is kept out of the table
+    boost::shared_ptr<PartitionRouting> routing(new PartitionRouting());
+    routing->m_topologyVersion = topology.m_topologyVersion;
+    const std::map<int, int> &partitionToHostId = *topology.m_partitionToHostId;
+    for (std::map<int, int>::const_iterator it = partitionToHostId.begin(); it != partitionToHostId.end(); ++it) {
+        if (it->first == Distributer::MP_INIT_PID) {
+            routing->m_multiPartitionBev = bevForHostId(it->second);
+        } else if (it->first >= 0) {
+            if (static_cast<size_t>(it->first) >= routing->m_partitionToBev.size()) {
+                routing->m_partitionToBev.resize(static_cast<size_t>(it->first) + 1, NULL);
+            }
+            routing->m_partitionToBev[static_cast<size_t>(it->first)] = bevForHostId(it->second);
+        }
     }
+    if (m_readFromReplicas) {
+        // only replicas with a live connection take part, a partition without any falls back to its leader
+        const std::map<int, std::vector<int> > &replicaHostIds = *topology.m_partitionToReplicaHostIds;
+        routing->m_partitionToReplicaBevs.resize(routing->m_partitionToBev.size());
+        for (std::map<int, std::vector<int> >::const_iterator it = replicaHostIds.begin(); it != replicaHostIds.end(); ++it) {
+            if (it->first < 0 || static_cast<size_t>(it->first) >= routing->m_partitionToReplicaBevs.size()) {
+                continue;
+            }
+            std::vector<struct bufferevent *> &replicas = routing->m_partitionToReplicaBevs[static_cast<size_t>(it->first)];
+            for (std::vector<int>::const_iterator hostId = it->second.begin(); hostId != it->second.end(); ++hostId) {
+                struct bufferevent *bev = bevForHostId(*hostId);
+                if (bev != NULL) {
+                    replicas.push_back(bev);
+                }
+            }
+        }
+    }
+    return routing;
+}
+
+struct bufferevent *ClientImpl::bevForHostId(int hostId) {
     if (hostId >= 0) {
         std::map<int, bufferevent*>::iterator bevEntry = m_hostIdToEvent.find(hostId);
         if (bevEntry != m_hostIdToEvent.end()) {
@@ -1086,6 +1192,14 @@ void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> ca
                                                                                                UninitializedParamsException,
                                                                                                LibEventException,
                                                                                                ElasticModeMismatchException) {
+    invoke(proc, callback, -1);
+}
+
+void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> callback, int partitionId) throw (Exception,
+                                                                                                                NoConnectionsException,
+                                                                                                                UninitializedParamsException,
+                                                                                                                LibEventException,
+                                                                                                                ElasticModeMismatchException) {
     if (callback.get() == NULL) {
         throw NullPointerException();
     }
@@ -1126,10 +1240,14 @@ void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> ca
     expirationTime.tv_sec = entryTime.tv_sec + m_queryExpirationTime.tv_sec;
     expirationTime.tv_usec = entryTime.tv_usec + m_queryExpirationTime.tv_usec;
 
-    int32_t messageSize = proc.getSerializedSize();
-    ScopedByteBuffer sbb(messageSize);
+    // The request is completed in place in the procedure's parameter buffer. If the event loop
+    // has to run to wait out backpressure it is detached into a private copy first, because
+    // callbacks run by the loop may reuse the same procedure.
+    ByteBuffer staged = proc.stagedRequest(m_nextRequestId);
     int64_t clientData = m_nextRequestId++;
-    proc.serializeTo(&sbb, clientData);
+    char *requestBytes = staged.bytes();
+    const int32_t requestLength = staged.limit();
+    boost::scoped_array<char> detached;
 
     /*
      * Decide what connection to buffer the event on.
@@ -1153,19 +1271,15 @@ void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> ca
     struct bufferevent *bev = NULL;
 
     bool procReadOnly = false;
-    //route transaction to correct event if client affinity is enabled and hashinator updating is not in progress
-    //elastic scalability is disabled
-    if (m_useClientAffinity && !m_distributer.isUpdating()) {
-        if (isReadOnly(proc)) {
-            procReadOnly = true;
-        }
-    }
 
     while (true) {
         struct bufferevent *routed_bev = NULL;
+        //route transaction to correct event if client affinity is enabled and hashinator updating is not in progress
+        //elastic scalability is disabled
         if (m_useClientAffinity && !m_distributer.isUpdating()) {
             // It is possible that the topology was updated while waiting for backpressure so re-check every time.
-            routed_bev = routeProcedure(proc, sbb);
+            ByteBuffer request(requestBytes, requestLength);
+            routed_bev = routeProcedure(proc, request, procReadOnly, partitionId);
         }
         if (m_ignoreBackpressure) {
             if (routed_bev == NULL) {
@@ -1216,6 +1330,12 @@ void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> ca
                 }
             }
             if (callEventLoop) {
+                if (detached.get() == NULL) {
+                    detached.reset(new char[requestLength]);
+                    ::memcpy(detached.get(), requestBytes, static_cast<size_t>(requestLength));
+                    requestBytes = detached.get();
+                    proc.releaseRequest();
+                }
                 m_invocationBlockedOnBackpressure = true;
                 int loopRunStatus = event_base_dispatch(m_base);
                 if (loopRunStatus == -1) {
@@ -1250,14 +1370,18 @@ void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> ca
         throw NoConnectionsException();
     }
     (*(bevFromCBMap->second))[clientData] = cb;
+    trackStreaming(bev, *cb, false);
 
     //(*(m_callbacks[bev]))[clientData] = cb;
     ++m_outstandingRequests;
 
     struct evbuffer *evbuf = bufferevent_get_output(bev);
-    if (evbuffer_add(evbuf, sbb.bytes(), static_cast<size_t>(sbb.remaining()))) {
+    if (evbuffer_add(evbuf, requestBytes, static_cast<size_t>(requestLength))) {
         throw LibEventException("invoke: Failed adding data to event buffer");
     }
+    if (detached.get() == NULL) {
+        proc.releaseRequest();
+    }
 
     if (evbuffer_get_length(evbuf) >  262144) {
         m_backpressuredBevs.insert(bev);
@@ -1266,6 +1390,676 @@ void ClientImpl::invoke(Procedure &proc, boost::shared_ptr<ProcedureCallback> ca
     return;
 }
 
+/*
+ * Shared state for the members of a batch. Collects the responses in submission
+ * order and invokes the batch callback once the last member has completed.
+ */
+class BatchGroup {
+public:
+    BatchGroup(const boost::shared_ptr<BatchCallback> &callback, size_t size) :
+        m_callback(callback), m_responses(size), m_remaining(size) {}
+
+    bool complete(size_t index, const InvocationResponse &response) throw (Exception) {
+        m_responses[index] = response;
+        if (--m_remaining > 0) {
+            return false;
+        }
+        return m_callback->callback(m_responses);
+    }
+
+private:
+    const boost::shared_ptr<BatchCallback> m_callback;
+    std::vector<InvocationResponse> m_responses;
+    size_t m_remaining;
+};
+
+/*
+ * Per request callback of a batch member, forwards the response to the group
+ */
+class BatchMemberCallback : public ProcedureCallback {
+public:
+    BatchMemberCallback(const boost::shared_ptr<BatchGroup> &group, size_t index) : m_group(group), m_index(index) {}
+
+    bool callback(InvocationResponse response) throw (Exception) {
+        return m_group->complete(m_index, response);
+    }
+
+    bool allowAbandon() const {
+        return false;
+    }
+
+private:
+    const boost::shared_ptr<BatchGroup> m_group;
+    const size_t m_index;
+};
+
+template <class Callback>
+bool ClientImpl::abandonGroup(Callback &callback) {
+    if (m_outstandingRequests >= m_maxOutstandingRequests) {
+        if (m_listener.get() != NULL) {
+            m_backPressuredForOutstandingRequests = true;
+            try {
+                m_listener->backpressure(true);
+            } catch (const std::exception& e) {
+                std::cerr << "Exception thrown on invocation of backpressure callback: " << e.what() << std::endl;
+            }
+        }
+        if (m_enableAbandon && callback.allowAbandon()) {
+            callback.abandon(ProcedureCallback::TOO_BUSY);
+            return true;
+        }
+        else if (m_enableAbandon) {
+            callback.abandon(ProcedureCallback::NOT_ABANDONED);
+        }
+    }
+    return false;
+}
+
+void ClientImpl::invokeBatch(const std::vector<Procedure*> &procs, boost::shared_ptr<BatchCallback> callback) throw (Exception,
+                                                                                                                     NoConnectionsException,
+                                                                                                                     UninitializedParamsException,
+                                                                                                                     LibEventException,
+                                                                                                                     ElasticModeMismatchException) {
+    if (callback.get() == NULL) {
+        throw NullPointerException();
+    }
+    if (m_bevs.empty()) {
+        throw NoConnectionsException();
+    }
+    if (procs.empty()) {
+        callback->callback(std::vector<InvocationResponse>());
+        return;
+    }
+
+    if (abandonGroup(*callback)) {
+        return;
+    }
+
+    //do not call the procedures if hashinator is in the LEGACY mode
+    if (!m_distributer.isUpdating() && !m_distributer.isElastic()) {
+        throw ElasticModeMismatchException();
+    }
+
+    // The batch is admitted as a unit: wait once for the outstanding request count to
+    // drop instead of going through the per connection backpressure loop for every member.
+    while (!m_ignoreBackpressure && m_outstandingRequests > m_maxOutstandingRequests) {
+        bool callEventLoop = true;
+        if (m_listener.get() != NULL) {
+            try {
+                m_ignoreBackpressure = true;
+                callEventLoop = !m_listener->backpressure(true);
+                m_ignoreBackpressure = false;
+            } catch (const std::exception& e) {
+                std::string msg(e.what());
+                logMessage(ClientLogger::ERROR, "Exception thrown on invocation of backpressure callback: " + msg);
+            }
+        }
+        if (!callEventLoop) {
+            break;
+        }
+        m_invocationBlockedOnBackpressure = true;
+        if (event_base_dispatch(m_base) == -1) {
+            std::string msg("invokeBatch: failed running event base loop to ease out backpressure");
+            logMessage(ClientLogger::ERROR, msg);
+            throw LibEventException(msg);
+        }
+        if (m_bevs.empty()) {
+            throw NoConnectionsException();
+        }
+    }
+
+    timeval entryTime, expirationTime;
+    int status = gettimeofday(&entryTime, NULL);
+    assert(status == 0);
+    expirationTime.tv_sec = entryTime.tv_sec + m_queryExpirationTime.tv_sec;
+    expirationTime.tv_usec = entryTime.tv_usec + m_queryExpirationTime.tv_usec;
+
+    // Every member is completed in place in its procedure's parameter buffer. Uninitialized
+    // parameters are reported here, before anything is queued.
+    const size_t count = procs.size();
+    const int64_t firstClientData = m_nextRequestId;
+    std::vector<char*> requestBytes(count, NULL);
+    std::vector<int32_t> requestLengths(count, 0);
+    // last member staged from each procedure, a procedure submitted more than once gets
+    // its earlier request copied out before being staged again
+    std::map<Procedure*, size_t> staged;
+    std::vector<boost::shared_array<char> > copies;
+
+    const bool route = m_useClientAffinity && !m_distributer.isUpdating();
+    struct bufferevent *defaultBev = NULL;
+    std::vector<struct bufferevent*> targets(count, NULL);
+    std::vector<bool> readOnly(count, false);
+    // Destination connections in the order they were first used, with the bytes queued for each
+    std::vector<std::pair<struct bufferevent*, int32_t> > writes;
+    boost::shared_ptr<BatchGroup> group(new BatchGroup(callback, count));
+    // destinations written so far, the members of the others were not sent
+    size_t written = 0;
+    try {
+        for (size_t ii = 0; ii < count; ii++) {
+            std::map<Procedure*, size_t>::iterator previous = staged.find(procs[ii]);
+            if (previous != staged.end()) {
+                const size_t jj = previous->second;
+                boost::shared_array<char> copy(new char[requestLengths[jj]]);
+                ::memcpy(copy.get(), requestBytes[jj], static_cast<size_t>(requestLengths[jj]));
+                requestBytes[jj] = copy.get();
+                copies.push_back(copy);
+            }
+            ByteBuffer request = procs[ii]->stagedRequest(firstClientData + static_cast<int64_t>(ii));
+            staged[procs[ii]] = ii;
+            requestBytes[ii] = request.bytes();
+            requestLengths[ii] = request.limit();
+
+            struct bufferevent *bev = NULL;
+            if (route) {
+                bool procReadOnly = false;
+                bev = routeProcedure(*procs[ii], request, procReadOnly);
+                readOnly[ii] = procReadOnly;
+            }
+            if (bev == NULL) {
+                if (defaultBev == NULL) {
+                    // unrouted members share one connection so that they go out in a single write
+                    for (size_t jj = 0; jj < m_bevs.size(); jj++) {
+                        defaultBev = m_bevs[++m_nextConnectionIndex % m_bevs.size()];
+                        if (m_backpressuredBevs.find(defaultBev) == m_backpressuredBevs.end()) {
+                            break;
+                        }
+                    }
+                }
+                bev = defaultBev;
+            }
+            targets[ii] = bev;
+
+            size_t jj = 0;
+            while (jj < writes.size() && writes[jj].first != bev) {
+                jj++;
+            }
+            if (jj == writes.size()) {
+                writes.push_back(std::make_pair(bev, 0));
+            }
+            writes[jj].second += requestLengths[ii];
+        }
+        m_nextRequestId += static_cast<int64_t>(count);
+
+        for (size_t jj = 0; jj < writes.size(); jj++) {
+            if (m_callbacks.find(writes[jj].first) == m_callbacks.end()) {
+                throw NoConnectionsException();
+            }
+        }
+
+        // One contiguous write per destination connection, members keep their submission order.
+        // The members of a destination are registered once written, no response is read before
+        // the event loop runs again.
+        for (; written < writes.size(); written++) {
+            struct bufferevent *bev = writes[written].first;
+            struct evbuffer *evbuf = bufferevent_get_output(bev);
+            struct evbuffer_iovec space;
+            if (evbuffer_reserve_space(evbuf, writes[written].second, &space, 1) != 1) {
+                throw LibEventException("invokeBatch: Failed reserving space in event buffer");
+            }
+            char *out = static_cast<char*>(space.iov_base);
+            for (size_t ii = 0; ii < count; ii++) {
+                if (targets[ii] == bev) {
+                    ::memcpy(out, requestBytes[ii], static_cast<size_t>(requestLengths[ii]));
+                    out += requestLengths[ii];
+                }
+            }
+            space.iov_len = static_cast<size_t>(writes[written].second);
+            if (evbuffer_commit_space(evbuf, &space, 1)) {
+                throw LibEventException("invokeBatch: Failed adding data to event buffer");
+            }
+            for (size_t ii = 0; ii < count; ii++) {
+                if (targets[ii] == bev) {
+                    boost::shared_ptr<ProcedureCallback> member(new BatchMemberCallback(group, ii));
+                    boost::shared_ptr<CallBackBookeeping> cb(new CallBackBookeeping(member, expirationTime, readOnly[ii]));
+                    (*m_callbacks[bev])[firstClientData + static_cast<int64_t>(ii)] = cb;
+                    ++m_outstandingRequests;
+                }
+            }
+            if (evbuffer_get_length(evbuf) > 262144) {
+                m_backpressuredBevs.insert(bev);
+            }
+        }
+    } catch (const std::exception &e) {
+        for (std::map<Procedure*, size_t>::iterator itr = staged.begin(); itr != staged.end(); ++itr) {
+            itr->first->releaseRequest();
+        }
+        if (written == 0) {
+            throw;
+        }
+        // part of the batch went out, complete the members that did not so that the batch completes
+        std::vector<Table> noResults;
+        InvocationResponse response(0, STATUS_CODE_UNEXPECTED_FAILURE, std::string("request was not sent: ") + e.what(),
+                STATUS_CODE_UNINITIALIZED_APP_STATUS_CODE, "", noResults);
+        for (size_t jj = written; jj < writes.size(); jj++) {
+            for (size_t ii = 0; ii < count; ii++) {
+                if (targets[ii] != writes[jj].first) {
+                    continue;
+                }
+                boost::shared_ptr<ProcedureCallback> member(new BatchMemberCallback(group, ii));
+                try {
+                    member->callback(response);
+                } catch (std::exception &userException) {
+                    if (m_listener.get() != NULL) {
+                        m_listener->uncaughtException(userException, member, response);
+                    }
+                }
+            }
+        }
+        return;
+    }
+    for (std::map<Procedure*, size_t>::iterator itr = staged.begin(); itr != staged.end(); ++itr) {
+        itr->first->releaseRequest();
+    }
+}
+
+/*
+ * Collects the responses of an invocation at every partition and completes it once all arrived
+ */
+class AllPartitionsGroup {
+public:
+    AllPartitionsGroup(const boost::shared_ptr<AllPartitionsCallback> &callback, size_t size) :
+        m_callback(callback), m_remaining(size) {}
+
+    bool complete(int32_t partitionId, const InvocationResponse &response) throw (Exception) {
+        m_responses[partitionId] = response;
+        bool breakEventLoop = m_callback->partitionResponse(partitionId, response);
+        if (--m_remaining > 0) {
+            return breakEventLoop;
+        }
+        breakEventLoop |= m_callback->callback(m_responses);
+        return breakEventLoop;
+    }
+
+private:
+    const boost::shared_ptr<AllPartitionsCallback> m_callback;
+    std::map<int32_t, InvocationResponse> m_responses;
+    size_t m_remaining;
+};
+
+/*
+ * Collects the response of every partition of an invocation grouped by partition
+ */
+class GroupedByPartitionGroup {
+public:
+    GroupedByPartitionGroup(const boost::shared_ptr<GroupedByPartitionCallback> &callback, size_t size,
+                            std::vector<GroupedByPartitionCallback::KeyLocation> &locations) :
+        m_callback(callback), m_remaining(size) {
+        m_locations.swap(locations);
+    }
+
+    bool complete(int32_t partitionId, const InvocationResponse &response) throw (Exception) {
+        m_responses[partitionId] = response;
+        bool breakEventLoop = m_callback->partitionResponse(partitionId, response);
+        if (--m_remaining > 0) {
+            return breakEventLoop;
+        }
+        breakEventLoop |= m_callback->callback(m_responses, m_locations);
+        return breakEventLoop;
+    }
+
+private:
+    const boost::shared_ptr<GroupedByPartitionCallback> m_callback;
+    std::map<int32_t, InvocationResponse> m_responses;
+    std::vector<GroupedByPartitionCallback::KeyLocation> m_locations;
+    size_t m_remaining;
+};
+
+/*
+ * Per partition callback of an invocation made of one request per partition, forwards the response to the group
+ */
+template <class Group>
+class PartitionMemberCallback : public ProcedureCallback {
+public:
+    PartitionMemberCallback(const boost::shared_ptr<Group> &group, int32_t partitionId) :
+        m_group(group), m_partitionId(partitionId) {}
+
+    bool callback(InvocationResponse response) throw (Exception) {
+        return m_group->complete(m_partitionId, response);
+    }
+
+    bool allowAbandon() const {
+        return false;
+    }
+
+private:
+    const boost::shared_ptr<Group> m_group;
+    const int32_t m_partitionId;
+};
+
+template <class Group, class Iterator>
+void ClientImpl::failGroupMembers(const boost::shared_ptr<Group> &group, Iterator first, Iterator last,
+                                  const std::exception &reason) {
+    std::vector<Table> noResults;
+    InvocationResponse response(0, STATUS_CODE_UNEXPECTED_FAILURE, std::string("request was not sent: ") + reason.what(),
+            STATUS_CODE_UNINITIALIZED_APP_STATUS_CODE, "", noResults);
+    for (; first != last; ++first) {
+        boost::shared_ptr<ProcedureCallback> member(new PartitionMemberCallback<Group>(group, first->first));
+        try {
+            member->callback(response);
+        } catch (std::exception &e) {
+            if (m_listener.get() != NULL) {
+                m_listener->uncaughtException(e, member, response);
+            }
+        }
+    }
+}
+
+/*
+ * Largest non null value of an integer wire type, 0 for other types
+ */
+static int64_t maxPartitionKey(int8_t type) {
+    switch (type) {
+        case WIRE_TYPE_TINYINT:
+            return INT8_MAX;
+        case WIRE_TYPE_SMALLINT:
+            return INT16_MAX;
+        case WIRE_TYPE_INTEGER:
+            return INT32_MAX;
+        case WIRE_TYPE_BIGINT:
+            return INT64_MAX;
+        default:
+            return 0;
+    }
+}
+
+void ClientImpl::invokeAllPartitions(Procedure &proc, boost::shared_ptr<AllPartitionsCallback> callback) throw (Exception,
+                                                                                                               NoConnectionsException,
+                                                                                                               UninitializedParamsException,
+                                                                                                               LibEventException,
+                                                                                                               ElasticModeMismatchException,
+                                                                                                               AllPartitionsInvocationException) {
+    if (callback.get() == NULL) {
+        throw NullPointerException();
+    }
+    if (m_bevs.empty()) {
+        throw NoConnectionsException();
+    }
+
+    const boost::shared_ptr<const RoutingSnapshot> topology = m_distributer.snapshot();
+    const ProcedureInfo *procInfo = resolveProcedure(proc, topology);
+    if (procInfo == NULL) {
+        throw AllPartitionsInvocationException("unknown procedure " + proc.getName());
+    }
+    if (procInfo->m_multiPart) {
+        throw AllPartitionsInvocationException(proc.getName() + " is not a single partition procedure");
+    }
+
+    // The request is staged once and copied, every partition's invocation restages the copy
+    // with the placeholder key replaced
+    ByteBuffer staged = proc.stagedRequest(0);
+    std::string request(staged.bytes(), static_cast<size_t>(staged.limit()));
+    ByteBuffer requestBuffer(&request[0], static_cast<int32_t>(request.size()));
+    const int offset = Distributer::getParameterOffset(requestBuffer, procInfo->m_partitionParameter);
+    const int8_t keyType = offset >= 0 ? requestBuffer.getInt8(offset) : static_cast<int8_t>(WIRE_TYPE_INVALID);
+    const int64_t maxKey = maxPartitionKey(keyType);
+    if (maxKey == 0) {
+        throw AllPartitionsInvocationException(proc.getName() + " is not partitioned on an integer parameter");
+    }
+
+    if (m_partitionKeysVersion != topology->m_topologyVersion || m_partitionKeys.empty()) {
+        // only a complete map is kept, a failed search is repeated by the next invocation
+        std::map<int, int64_t> keys;
+        Distributer::getPartitionKeys(*topology, keys);
+        m_partitionKeys.swap(keys);
+        m_partitionKeysVersion = topology->m_topologyVersion;
+    }
+    for (std::map<int, int64_t>::const_iterator it = m_partitionKeys.begin(); it != m_partitionKeys.end(); ++it) {
+        if (it->second > maxKey) {
+            throw AllPartitionsInvocationException("no key of partition of the partitioning parameter's type");
+        }
+    }
+
+    if (abandonGroup(*callback)) {
+        return;
+    }
+
+    proc.releaseRequest();
+    // the key map may be rebuilt by a topology change while invoke() runs the event loop
+    const std::map<int, int64_t> partitionKeys(m_partitionKeys);
+    boost::shared_ptr<AllPartitionsGroup> group(new AllPartitionsGroup(callback, partitionKeys.size()));
+    for (std::map<int, int64_t>::const_iterator it = partitionKeys.begin(); it != partitionKeys.end(); ++it) {
+        switch (keyType) {
+            case WIRE_TYPE_TINYINT:
+                requestBuffer.putInt8(offset + 1, static_cast<int8_t>(it->second));
+                break;
+            case WIRE_TYPE_SMALLINT:
+                requestBuffer.putInt16(offset + 1, static_cast<int16_t>(it->second));
+                break;
+            case WIRE_TYPE_INTEGER:
+                requestBuffer.putInt32(offset + 1, static_cast<int32_t>(it->second));
+                break;
+            default:
+                requestBuffer.putInt64(offset + 1, it->second);
+                break;
+        }
+        proc.restageRequest(request);
+        boost::shared_ptr<ProcedureCallback> member(new PartitionMemberCallback<AllPartitionsGroup>(group, it->first));
+        try {
+            invoke(proc, member, it->first);
+        } catch (const Exception &e) {
+            // nothing was sent yet, the caller gets the exception and the callback is never invoked
+            if (it == partitionKeys.begin()) {
+                throw;
+            }
+            failGroupMembers(group, it, partitionKeys.end(), e);
+            return;
+        }
+    }
+}
+
+const ProcedureInfo *ClientImpl::resolveGroupedProcedure(Procedure &proc, const boost::shared_ptr<const RoutingSnapshot> &topology,
+                                                         bool &partitionParameterFirst) throw (GroupedInvocationException) {
+    const ProcedureInfo *procInfo = resolveProcedure(proc, topology);
+    if (procInfo == NULL) {
+        throw GroupedInvocationException("unknown procedure " + proc.getName());
+    }
+    if (procInfo->m_multiPart) {
+        throw GroupedInvocationException(proc.getName() + " is not a single partition procedure");
+    }
+    if (procInfo->m_partitionParameter != 0 && procInfo->m_partitionParameter != 1) {
+        throw GroupedInvocationException(proc.getName() + " does not take the partitioning parameter and an array of keys");
+    }
+    partitionParameterFirst = procInfo->m_partitionParameter == 0;
+    return procInfo;
+}
+
+void ClientImpl::groupByPartition(const std::vector<int32_t> &partitions, std::map<int32_t, std::vector<size_t> > &groups,
+                                  std::vector<GroupedByPartitionCallback::KeyLocation> &locations) throw (GroupedInvocationException) {
+    locations.resize(partitions.size());
+    for (size_t ii = 0; ii < partitions.size(); ii++) {
+        if (partitions[ii] < 0) {
+            throw GroupedInvocationException("the topology is not loaded");
+        }
+        std::vector<size_t> &group = groups[partitions[ii]];
+        locations[ii].m_partitionId = partitions[ii];
+        locations[ii].m_position = static_cast<int32_t>(group.size());
+        group.push_back(ii);
+    }
+}
+
+/*
+ * The keys of a group narrowed to the partitioning parameter's type
+ */
+template <typename T>
+static std::vector<T> narrowKeys(const std::vector<int64_t> &keys, const std::vector<size_t> &group) {
+    std::vector<T> narrowed;
+    narrowed.reserve(group.size());
+    for (std::vector<size_t>::const_iterator it = group.begin(); it != group.end(); ++it) {
+        narrowed.push_back(static_cast<T>(keys[*it]));
+    }
+    return narrowed;
+}
+
+/*
+ * Sets the partitioning parameter to the group's first key and the array parameter to all its keys
+ */
+static void setGroupParameters(ParameterSet &params, bool partitionParameterFirst, int8_t keyType,
+                               const std::vector<int64_t> &keys, const std::vector<size_t> &group) {
+    const int64_t key = keys[group[0]];
+    for (int parameter = 0; parameter < 2; parameter++) {
+        const bool scalar = (parameter == 0) == partitionParameterFirst;
+        switch (keyType) {
+            case WIRE_TYPE_TINYINT:
+                if (scalar) {
+                    params.addInt8(static_cast<int8_t>(key));
+                } else {
+                    params.addInt8(narrowKeys<int8_t>(keys, group));
+                }
+                break;
+            case WIRE_TYPE_SMALLINT:
+                if (scalar) {
+                    params.addInt16(static_cast<int16_t>(key));
+                } else {
+                    params.addInt16(narrowKeys<int16_t>(keys, group));
+                }
+                break;
+            case WIRE_TYPE_INTEGER:
+                if (scalar) {
+                    params.addInt32(static_cast<int32_t>(key));
+                } else {
+                    params.addInt32(narrowKeys<int32_t>(keys, group));
+                }
+                break;
+            default:
+                if (scalar) {
+                    params.addInt64(key);
+                } else {
+                    params.addInt64(narrowKeys<int64_t>(keys, group));
+                }
+                break;
+        }
+    }
+}
+
+static void setGroupParameters(ParameterSet &params, bool partitionParameterFirst, int8_t keyType,
+                               const std::vector<std::string> &keys, const std::vector<size_t> &group) {
+    std::vector<buffer_t> array;
+    array.reserve(group.size());
+    for (std::vector<size_t>::const_iterator it = group.begin(); it != group.end(); ++it) {
+        array.push_back(buffer_t(keys[*it].data(), keys[*it].size()));
+    }
+    const std::string &key = keys[group[0]];
+    for (int parameter = 0; parameter < 2; parameter++) {
+        const bool scalar = (parameter == 0) == partitionParameterFirst;
+        if (keyType == WIRE_TYPE_VARBINARY && scalar) {
+            params.addBytes(static_cast<int32_t>(key.size()), reinterpret_cast<const uint8_t*>(key.data()));
+        } else if (keyType == WIRE_TYPE_VARBINARY) {
+            params.addBytes(array);
+        } else if (scalar) {
+            params.addString(key);
+        } else {
+            params.addString(array);
+        }
+    }
+}
+
+/*
+ * Checks that the keys fit the integer partitioning parameter and hashes them, every partition is -1
+ * without a hashinator
+ */
+static void hashGroupedKeys(const std::string &procName, int8_t keyType, const TheHashinator *hashinator,
+                            const std::vector<int64_t> &keys, std::vector<int32_t> &partitions) throw (GroupedInvocationException) {
+    const int64_t maxKey = maxPartitionKey(keyType);
+    if (maxKey == 0) {
+        throw GroupedInvocationException(procName + " is not partitioned on an integer parameter");
+    }
+    for (std::vector<int64_t>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        // the smallest value of each integer type is its null
+        if (*it > maxKey || *it <= -maxKey - 1) {
+            throw GroupedInvocationException("a key is out of the range of the partitioning parameter's type");
+        }
+    }
+    partitions.assign(keys.size(), -1);
+    if (hashinator != NULL && !keys.empty()) {
+        hashinator->hashinateBatch(&keys[0], keys.size(), &partitions[0]);
+    }
+}
+
+static void hashGroupedKeys(const std::string &procName, int8_t keyType, const TheHashinator *hashinator,
+                            const std::vector<std::string> &keys, std::vector<int32_t> &partitions) throw (GroupedInvocationException) {
+    if (keyType != WIRE_TYPE_STRING && keyType != WIRE_TYPE_VARBINARY) {
+        throw GroupedInvocationException(procName + " is not partitioned on a string or varbinary parameter");
+    }
+    partitions.assign(keys.size(), -1);
+    if (hashinator == NULL || keys.empty()) {
+        return;
+    }
+    std::vector<const char *> bytes(keys.size());
+    std::vector<int32_t> lengths(keys.size());
+    for (size_t ii = 0; ii < keys.size(); ii++) {
+        bytes[ii] = keys[ii].data();
+        lengths[ii] = static_cast<int32_t>(keys[ii].size());
+    }
+    hashinator->hashinateBatch(&bytes[0], &lengths[0], keys.size(), &partitions[0]);
+}
+
+template <class Key>
+void ClientImpl::invokeGrouped(Procedure &proc, const std::vector<Key> &keys,
+                               const boost::shared_ptr<GroupedByPartitionCallback> &callback) throw (Exception,
+                                                                                                     NoConnectionsException,
+                                                                                                     UninitializedParamsException,
+                                                                                                     LibEventException,
+                                                                                                     GroupedInvocationException) {
+    if (callback.get() == NULL) {
+        throw NullPointerException();
+    }
+    if (m_bevs.empty()) {
+        throw NoConnectionsException();
+    }
+    const boost::shared_ptr<const RoutingSnapshot> topology = m_distributer.snapshot();
+    bool partitionParameterFirst;
+    const ProcedureInfo *procInfo = resolveGroupedProcedure(proc, topology, partitionParameterFirst);
+    const int8_t keyType = static_cast<int8_t>(procInfo->m_partitionParameterType);
+    std::vector<int32_t> partitions;
+    hashGroupedKeys(proc.getName(), keyType, topology->m_isElastic ? topology->m_hashinator.get() : NULL, keys, partitions);
+    std::map<int32_t, std::vector<size_t> > groups;
+    std::vector<GroupedByPartitionCallback::KeyLocation> locations;
+    groupByPartition(partitions, groups, locations);
+    if (groups.empty()) {
+        callback->callback(std::map<int32_t, InvocationResponse>(), locations);
+        return;
+    }
+    if (abandonGroup(*callback)) {
+        return;
+    }
+
+    boost::shared_ptr<GroupedByPartitionGroup> group(new GroupedByPartitionGroup(callback, groups.size(), locations));
+    for (std::map<int32_t, std::vector<size_t> >::iterator it = groups.begin(); it != groups.end(); ++it) {
+        boost::shared_ptr<ProcedureCallback> member(new PartitionMemberCallback<GroupedByPartitionGroup>(group, it->first));
+        try {
+            setGroupParameters(*proc.params(), partitionParameterFirst, keyType, keys, it->second);
+            invoke(proc, member, it->first);
+        } catch (const Exception &e) {
+            // nothing was sent yet, the caller gets the exception and the callback is never invoked
+            if (it == groups.begin()) {
+                throw;
+            }
+            failGroupMembers(group, it, groups.end(), e);
+            return;
+        }
+    }
+}
+
+void ClientImpl::invokeGroupedByPartition(Procedure &proc, const std::vector<int64_t> &keys,
+                                          boost::shared_ptr<GroupedByPartitionCallback> callback) throw (Exception,
+                                                                                                         NoConnectionsException,
+                                                                                                         UninitializedParamsException,
+                                                                                                         LibEventException,
+                                                                                                         ElasticModeMismatchException,
+                                                                                                         GroupedInvocationException) {
+    invokeGrouped(proc, keys, callback);
+}
+
+void ClientImpl::invokeGroupedByPartition(Procedure &proc, const std::vector<std::string> &keys,
+                                          boost::shared_ptr<GroupedByPartitionCallback> callback) throw (Exception,
+                                                                                                         NoConnectionsException,
+                                                                                                         UninitializedParamsException,
+                                                                                                         LibEventException,
+                                                                                                         ElasticModeMismatchException,
+                                                                                                         GroupedInvocationException) {
+    invokeGrouped(proc, keys, callback);
+}
+
 void ClientImpl::runOnce() throw (Exception, NoConnectionsException, LibEventException) {
 
     logMessage(ClientLogger::DEBUG, "ClientImpl::runOnce");
@@ -1322,13 +2116,45 @@ void ClientImpl::regularReadCallback(struct bufferevent *bev) {
             evbuffer_remove( evbuf, lengthBytes, 4);
             context->m_nextLength = static_cast<size_t>(lengthBuffer.getInt32());
             context->m_lengthOrMessage = false;
+            context->m_streamChecked = false;
             remaining -= 4;
+        } else if (!context->m_lengthOrMessage && !context->m_streamChecked) {
+            // responses to streaming callbacks are passed on as they arrive, which takes their client data
+            if (context->m_streamingRequests > 0 && context->m_nextLength >= RESPONSE_PEEK_LENGTH) {
+                if (remaining < RESPONSE_PEEK_LENGTH) {
+                    bufferevent_setwatermark( bev, EV_READ, RESPONSE_PEEK_LENGTH, HIGH_WATERMARK);
+                    break;
+                }
+                context->m_stream = streamFor(bev, context->m_nextLength);
+            }
+            context->m_streamChecked = true;
+        } else if (context->m_stream) {
+            const size_t needed = readStream(bev, *context->m_stream, breakEventLoop);
+            remaining = static_cast<int32_t>(evbuffer_get_length(evbuf));
+            if (needed > 0) {
+                bufferevent_setwatermark( bev, EV_READ, needed, HIGH_WATERMARK);
+                break;
+            }
+            context->m_stream.reset();
+            context->m_lengthOrMessage = true;
+
+            if (m_isDraining && (m_outstandingRequests == 0)) {
+                m_isDraining = false;
+                breakEventLoop = true;
+            }
         } else if (remaining >= context->m_nextLength) {
-            boost::shared_array<char> messageBytes = boost::shared_array<char>(new char[context->m_nextLength]);
             context->m_lengthOrMessage = true;
-            evbuffer_remove( evbuf, messageBytes.get(), static_cast<size_t>(context->m_nextLength));
+            InvocationResponse response;
+            if (context->m_nextLength >= SEGMENTED_RESPONSE_LENGTH) {
+                // large responses keep the chunks they arrived in instead of being copied into one allocation
+                boost::shared_ptr<SegmentedBuffer> segments(new SegmentedBuffer(evbuf, context->m_nextLength));
+                response = InvocationResponse(segments, m_schemaCache);
+            } else {
+                boost::shared_array<char> messageBytes = boost::shared_array<char>(new char[context->m_nextLength]);
+                evbuffer_remove( evbuf, messageBytes.get(), static_cast<size_t>(context->m_nextLength));
+                response = InvocationResponse(messageBytes, context->m_nextLength, m_schemaCache);
+            }
             remaining -= context->m_nextLength;
-            InvocationResponse response(messageBytes, context->m_nextLength);
             int64_t clientData = response.clientData();
 
             if (clientData == VOLT_NOTIFICATION_MAGIC_NUMBER) {
@@ -1345,17 +2171,9 @@ void ClientImpl::regularReadCallback(struct bufferevent *bev) {
                             breakEventLoop |= cbMapIterator->second->getCallback()->callback(response);
                             m_ignoreBackpressure = false;
                         } catch (const std::exception &e) {
-                            if (m_listener.get() != NULL) {
-                                try {
-                                    m_ignoreBackpressure = true;
-                                    breakEventLoop |= m_listener->uncaughtException( e, cbMapIterator->second->getCallback(), response);
-                                    m_ignoreBackpressure = false;
-                                } catch (const std::exception& e) {
-                                    std::string reason(e.what());
-                                    logMessage( ClientLogger::ERROR, "Uncaught exception handler threw exception: " + reason);
-                                }
-                            }
+                            breakEventLoop |= reportCallbackException(e, cbMapIterator->second->getCallback(), response);
                         }
+                        trackStreaming(bev, *cbMapIterator->second, true);
                         entry->second->erase(cbMapIterator);
                         --m_outstandingRequests;
                     }
@@ -1396,6 +2214,111 @@ void ClientImpl::regularReadCallback(struct bufferevent *bev) {
         event_base_loopbreak( m_base );
     }
 }
+boost::shared_ptr<ResponseStream> ClientImpl::streamFor(struct bufferevent *bev, int32_t length) {
+    char start[RESPONSE_PEEK_LENGTH];
+    evbuffer_copyout(bufferevent_get_input(bev), start, RESPONSE_PEEK_LENGTH);
+    ByteBuffer startBuffer(start, RESPONSE_PEEK_LENGTH);
+    const int64_t clientData = startBuffer.getInt64(1);
+    BEVToCallbackMap::iterator entry = m_callbacks.find(bev);
+    if (entry != m_callbacks.end()) {
+        CallbackMap::iterator cbMapIterator = entry->second->find(clientData);
+        if (cbMapIterator != entry->second->end() && cbMapIterator->second->isStreaming()) {
+            boost::shared_ptr<StreamingProcedureCallback> callback =
+                    boost::static_pointer_cast<StreamingProcedureCallback>(cbMapIterator->second->getCallback());
+            return boost::shared_ptr<ResponseStream>(new ResponseStream(length, clientData, callback, m_schemaCache));
+        }
+    }
+    return boost::shared_ptr<ResponseStream>();
+}
+
+size_t ClientImpl::readStream(struct bufferevent *bev, ResponseStream &stream, bool &breakEventLoop) {
+    // the request may have timed out or lost its connection while the response was streamed
+    BEVToCallbackMap::iterator entry = m_callbacks.find(bev);
+    CallbackMap::iterator cbMapIterator;
+    const bool pending = entry != m_callbacks.end() &&
+                         (cbMapIterator = entry->second->find(stream.clientData())) != entry->second->end();
+    if (!pending) {
+        stream.abandon();
+    }
+
+    size_t needed = 0;
+    while (true) {
+        try {
+            m_ignoreBackpressure = true;
+            needed = stream.read(bufferevent_get_input(bev), breakEventLoop);
+            m_ignoreBackpressure = false;
+            break;
+        } catch (const std::exception &e) {
+            // skip the rest of the response, a malformed one completes the request with a failure
+            // below while the callback isn't invoked again once it threw
+            m_ignoreBackpressure = false;
+            stream.abandon();
+            if (!stream.malformed()) {
+                breakEventLoop |= reportCallbackException(e, stream.callback(), stream.response());
+            }
+        }
+    }
+    if (needed > 0) {
+        return needed;
+    }
+
+    if (!pending) {
+        ++m_responseHandleNotFound;
+        return 0;
+    }
+    if (stream.malformed() || !stream.abandoned()) {
+        std::vector<Table> noResults;
+        const InvocationResponse response = stream.malformed() ?
+                InvocationResponse(stream.clientData(), STATUS_CODE_UNEXPECTED_FAILURE, "malformed response",
+                                   STATUS_CODE_UNINITIALIZED_APP_STATUS_CODE, "", noResults) :
+                stream.response();
+        try {
+            m_ignoreBackpressure = true;
+            breakEventLoop |= stream.callback()->callback(response);
+            m_ignoreBackpressure = false;
+        } catch (const std::exception &e) {
+            m_ignoreBackpressure = false;
+            breakEventLoop |= reportCallbackException(e, stream.callback(), response);
+        }
+    }
+    trackStreaming(bev, *cbMapIterator->second, true);
+    entry->second->erase(cbMapIterator);
+    --m_outstandingRequests;
+    return 0;
+}
+
+void ClientImpl::trackStreaming(struct bufferevent *bev, const CallBackBookeeping &request, bool completed) {
+    if (!request.isStreaming()) {
+        return;
+    }
+    std::map<struct bufferevent *, boost::shared_ptr<CxnContext> >::iterator context = m_contexts.find(bev);
+    if (context == m_contexts.end()) {
+        return;
+    }
+    if (completed) {
+        --context->second->m_streamingRequests;
+    } else {
+        ++context->second->m_streamingRequests;
+    }
+}
+
+bool ClientImpl::reportCallbackException(const std::exception &exception,
+                                         const boost::shared_ptr<ProcedureCallback> &callback,
+                                         const InvocationResponse &response) {
+    bool breakEventLoop = false;
+    if (m_listener.get() != NULL) {
+        try {
+            m_ignoreBackpressure = true;
+            breakEventLoop = m_listener->uncaughtException(exception, callback, response);
+            m_ignoreBackpressure = false;
+        } catch (const std::exception& e) {
+            std::string reason(e.what());
+            logMessage( ClientLogger::ERROR, "Uncaught exception handler threw exception: " + reason);
+        }
+    }
+    return breakEventLoop;
+}
+
 void ClientImpl::regularEventCallback(struct bufferevent *bev, short events) {
     if (events & BEV_EVENT_CONNECTED) {
         assert(false);
@@ -1464,6 +2387,7 @@ void ClientImpl::regularEventCallback(struct bufferevent *bev, short events) {
         }
 
         m_hostIdToEvent.erase(connectionCtxIter->second->m_hostId);
+        boost::atomic_store(&m_partitionRouting, boost::shared_ptr<const PartitionRouting>());
 
         //remove the entry for the backpressured connection set
         m_backpressuredBevs.erase(bev);
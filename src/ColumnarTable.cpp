@@ -0,0 +1,239 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include <arpa/inet.h>
+#include "ColumnarTable.h"
+#include "ByteSwap.h"
+#include "GeographyPoint.hpp"
+#include "SegmentedBuffer.h"
+
+namespace voltdb {
+
+/*
+ * Width of the values of a fixed width type, 0 for variable sized types
+ */
+static size_t fixedWidth(WireType type) throw (UnsupportedTypeException) {
+    switch (type) {
+        case WIRE_TYPE_TINYINT:
+            return 1;
+        case WIRE_TYPE_SMALLINT:
+            return 2;
+        case WIRE_TYPE_INTEGER:
+        case WIRE_TYPE_DATE:
+            return 4;
+        case WIRE_TYPE_BIGINT:
+        case WIRE_TYPE_TIMESTAMP:
+        case WIRE_TYPE_FLOAT:
+            return 8;
+        case WIRE_TYPE_DECIMAL:
+        case WIRE_TYPE_GEOGRAPHY_POINT:
+            return 16;
+        case WIRE_TYPE_STRING:
+        case WIRE_TYPE_VARBINARY:
+        case WIRE_TYPE_GEOGRAPHY:
+            return 0;
+        default:
+            throw UnsupportedTypeException(wireTypeToString(type));
+    }
+}
+
+static int32_t readInt32(const char *data) {
+    uint32_t value;
+    ::memcpy(&value, data, sizeof(value));
+    return static_cast<int32_t>(ntohl(value));
+}
+
+/*
+ * Sets the validity bit of every value that differs from the NULL sentinel
+ */
+template <typename T>
+static void setValidity(const char *values, size_t count, T null, std::vector<uint8_t> &validity) {
+    const T *typed = reinterpret_cast<const T*>(values);
+    for (size_t ii = 0; ii < count; ii++) {
+        validity[ii / 8] |= static_cast<uint8_t>((typed[ii] != null) << (ii % 8));
+    }
+}
+
+ColumnarTable::ColumnarTable(const Table &table) throw (UnsupportedTypeException, OverflowUnderflowException) :
+        m_columns(*table.m_columns), m_data(table.m_columns->size()), m_rowCount(table.m_rowCount) {
+    const size_t columnCount = m_columns.size();
+    const size_t rowCount = static_cast<size_t>(m_rowCount);
+    std::vector<size_t> widths(columnCount);
+    for (size_t column = 0; column < columnCount; column++) {
+        widths[column] = fixedWidth(m_columns[column].type());
+        ColumnData &data = m_data[column];
+        data.m_validity.assign((rowCount + 7) / 8, 0);
+        if (widths[column] > 0) {
+            data.m_values.resize(rowCount * widths[column]);
+        } else {
+            data.m_offsets.assign(rowCount + 1, 0);
+        }
+    }
+
+    // Gather the values of each row, still big endian, then convert every column at once
+    // the rows of a segmented table are read where they lie, a row spanning segments is copied
+    const boost::shared_ptr<SegmentedBuffer> segments = table.spannedSegments();
+    int32_t segmentsOffset = segments ? table.m_spanned->m_offset + table.m_rowCountPosition + 4 : 0;
+    const int32_t segmentsEnd = segments ? table.m_spanned->m_offset + table.m_spanned->m_length : 0;
+    const char *bytes = table.m_buffer.bytes();
+    const char *end = bytes + table.m_buffer.limit();
+    const char *row = bytes + table.m_rowCountPosition + 4;
+    SharedByteBuffer segmentsRow;
+    for (size_t ii = 0; ii < rowCount; ii++) {
+        const char *field;
+        const char *rowEnd;
+        if (segments) {
+            if (segmentsEnd - segmentsOffset < 4) {
+                throw OverflowUnderflowException();
+            }
+            const int32_t rowLength = segments->getInt32(segmentsOffset);
+            if (rowLength < 0 || rowLength > segmentsEnd - segmentsOffset - 4) {
+                throw OverflowUnderflowException();
+            }
+            segmentsRow = segments->slice(segmentsOffset + 4, rowLength);
+            segmentsOffset += 4 + rowLength;
+            field = segmentsRow.bytes();
+            rowEnd = field + rowLength;
+        } else {
+            if (end - row < 4) {
+                throw OverflowUnderflowException();
+            }
+            field = row + 4;
+            rowEnd = field + readInt32(row);
+            if (rowEnd > end || rowEnd < field) {
+                throw OverflowUnderflowException();
+            }
+        }
+        for (size_t column = 0; column < columnCount; column++) {
+            ColumnData &data = m_data[column];
+            const size_t width = widths[column];
+            if (width > 0) {
+                if (static_cast<size_t>(rowEnd - field) < width) {
+                    throw OverflowUnderflowException();
+                }
+                ::memcpy(&data.m_values[ii * width], field, width);
+                field += width;
+                continue;
+            }
+            if (rowEnd - field < 4) {
+                throw OverflowUnderflowException();
+            }
+            const int32_t length = readInt32(field);
+            field += 4;
+            if (length == -1) {
+                data.m_offsets[ii + 1] = data.m_offsets[ii];
+                continue;
+            }
+            if (length < 0 || rowEnd - field < length) {
+                throw OverflowUnderflowException();
+            }
+            data.m_values.insert(data.m_values.end(), field, field + length);
+            data.m_offsets[ii + 1] = data.m_offsets[ii] + length;
+            data.m_validity[ii / 8] |= static_cast<uint8_t>(1 << (ii % 8));
+            field += length;
+        }
+        row = rowEnd;
+    }
+
+    for (size_t column = 0; column < columnCount; column++) {
+        if (widths[column] > 0) {
+            decodeFixedWidth(column);
+        }
+    }
+}
+
+void ColumnarTable::decodeFixedWidth(size_t column) {
+    ColumnData &data = m_data[column];
+    const size_t rowCount = static_cast<size_t>(m_rowCount);
+    char *values = data.m_values.empty() ? NULL : &data.m_values[0];
+    switch (m_columns[column].type()) {
+        case WIRE_TYPE_TINYINT:
+            setValidity<int8_t>(values, rowCount, INT8_MIN, data.m_validity);
+            break;
+        case WIRE_TYPE_SMALLINT:
+            byteSwap16(values, values, rowCount);
+            setValidity<int16_t>(values, rowCount, INT16_MIN, data.m_validity);
+            break;
+        case WIRE_TYPE_INTEGER:
+        case WIRE_TYPE_DATE:
+            byteSwap32(values, values, rowCount);
+            setValidity<int32_t>(values, rowCount, INT32_MIN, data.m_validity);
+            break;
+        case WIRE_TYPE_BIGINT:
+        case WIRE_TYPE_TIMESTAMP:
+            byteSwap64(values, values, rowCount);
+            setValidity<int64_t>(values, rowCount, INT64_MIN, data.m_validity);
+            break;
+        case WIRE_TYPE_FLOAT: {
+            byteSwap64(values, values, rowCount);
+            const double *doubles = reinterpret_cast<const double*>(values);
+            for (size_t ii = 0; ii < rowCount; ii++) {
+                // the same NULL test as Row::getDouble
+                data.m_validity[ii / 8] |= static_cast<uint8_t>((doubles[ii] > -1.7E+308) << (ii % 8));
+            }
+            break;
+        }
+        case WIRE_TYPE_GEOGRAPHY_POINT: {
+            byteSwap64(values, values, rowCount * 2);
+            const double *coordinates = reinterpret_cast<const double*>(values);
+            for (size_t ii = 0; ii < rowCount; ii++) {
+                const bool isNull = coordinates[2 * ii] == GeographyPoint::NULL_COORDINATE &&
+                                    coordinates[2 * ii + 1] == GeographyPoint::NULL_COORDINATE;
+                data.m_validity[ii / 8] |= static_cast<uint8_t>(!isNull << (ii % 8));
+            }
+            break;
+        }
+        case WIRE_TYPE_DECIMAL:
+            for (size_t ii = 0; ii < rowCount; ii++) {
+                char decimal[16];
+                ::memcpy(decimal, values + ii * 16, 16);
+                data.m_validity[ii / 8] |= static_cast<uint8_t>(!Decimal(decimal).isNull() << (ii % 8));
+            }
+            break;
+        default:
+            assert(false);
+    }
+}
+
+const char *ColumnarTable::values(int32_t column, WireType type, WireType alternativeType) const throw (InvalidColumnException) {
+    const ColumnData &data = columnData(column);
+    const WireType columnType = m_columns[static_cast<size_t>(column)].type();
+    if (columnType != type && columnType != alternativeType) {
+        throw InvalidColumnException(m_columns[static_cast<size_t>(column)].name(), type,
+                                     wireTypeToString(type), wireTypeToString(columnType));
+    }
+    return data.m_values.empty() ? NULL : &data.m_values[0];
+}
+
+const ColumnarTable::ColumnData &ColumnarTable::variableColumn(int32_t column) const throw (InvalidColumnException) {
+    const ColumnData &data = columnData(column);
+    const WireType columnType = m_columns[static_cast<size_t>(column)].type();
+    if (!isVariableSized(columnType)) {
+        throw InvalidColumnException(m_columns[static_cast<size_t>(column)].name(), WIRE_TYPE_STRING,
+                                     wireTypeToString(WIRE_TYPE_STRING), wireTypeToString(columnType));
+    }
+    return data;
+}
+}
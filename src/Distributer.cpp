@@ -36,10 +36,13 @@
 #include <boost/foreach.hpp>
 #include <boost/scoped_array.hpp>
 #include <stdlib.h>
+#include <algorithm>
+#include <set>
+#include <sstream>
 namespace voltdb {
 
-boost::shared_mutex Distributer::m_procInfoLock;
 const int Distributer::MP_INIT_PID = 16383;
+boost::atomic<int64_t> Distributer::m_lastId(0);
 
 ProcedureInfo::ProcedureInfo(const std::string & jsonText):PARAMETER_NONE(-1){
     boost::property_tree::ptree pt;
@@ -58,95 +61,379 @@ ProcedureInfo::ProcedureInfo(const std::string & jsonText):PARAMETER_NONE(-1){
 }
 
 
-int Distributer::parseParameter(ByteBuffer &paramBuffer, int &index){
+/*
+ * Size of the values of fixed size parameter types, -1 for variable size types
+ */
+static int32_t fixedParameterSize(int8_t type) {
+    switch (type) {
+        case WIRE_TYPE_NULL:
+            return 0;
+        case WIRE_TYPE_TINYINT:
+            return 1;
+        case WIRE_TYPE_SMALLINT:
+            return 2;
+        case WIRE_TYPE_INTEGER:
+        case WIRE_TYPE_DATE:
+            return 4;
+        case WIRE_TYPE_BIGINT:
+        case WIRE_TYPE_FLOAT:
+        case WIRE_TYPE_TIMESTAMP:
+            return 8;
+        case WIRE_TYPE_DECIMAL:
+        case WIRE_TYPE_GEOGRAPHY_POINT:
+            return 16;
+        default:
+            return -1;
+    }
+}
+
+/*
+ * Advance index past a parameter value of the given type.
+ * Returns false if the type is not known.
+ */
+static bool skipValue(ByteBuffer &paramBuffer, int8_t type, int &index) {
+    const int32_t size = fixedParameterSize(type);
+    if (size >= 0) {
+        index += size;
+        return true;
+    }
+    switch (type) {
+        case WIRE_TYPE_STRING:
+        case WIRE_TYPE_VARBINARY:
+        case WIRE_TYPE_GEOGRAPHY:
+        case WIRE_TYPE_VOLTTABLE:
+        {
+            // length prefixed, -1 for null values
+            const int32_t length = paramBuffer.getInt32(index);
+            index += 4 + (length > 0 ? length : 0);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/*
+ * Advance index past the parameter, including its type, starting at index
+ */
+static bool skipParameter(ByteBuffer &paramBuffer, int &index) {
+    const int8_t type = paramBuffer.getInt8(index++);
+    if (type != WIRE_TYPE_ARRAY) {
+        return skipValue(paramBuffer, type, index);
+    }
+
+    const int8_t elementType = paramBuffer.getInt8(index++);
+    if (elementType == WIRE_TYPE_TINYINT) {
+        // byte arrays have a 4 byte length
+        index += 4 + paramBuffer.getInt32(index);
+        return true;
+    }
+    const int16_t count = paramBuffer.getInt16(index);
+    index += 2;
+    const int32_t size = fixedParameterSize(elementType);
+    if (size >= 0) {
+        index += count * size;
+        return true;
+    }
+    for (int16_t ii = 0; ii < count; ii++) {
+        if (!skipValue(paramBuffer, elementType, index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isIntegerType(int type) {
+    return type == WIRE_TYPE_TINYINT || type == WIRE_TYPE_SMALLINT ||
+           type == WIRE_TYPE_INTEGER || type == WIRE_TYPE_BIGINT;
+}
+
+/*
+ * Parse a decimal long the way java.lang.Long.parseLong does: an optional sign followed
+ * by at least one digit, nothing else, and no overflow.
+ */
+static bool parseLong(const char *data, int32_t length, int64_t &value) {
+    int32_t ii = 0;
+    bool negative = false;
+    if (length > 0 && (data[0] == '-' || data[0] == '+')) {
+        negative = (data[0] == '-');
+        ii++;
+    }
+    if (ii == length) {
+        return false;
+    }
+    const uint64_t limit = negative ? static_cast<uint64_t>(INT64_MAX) + 1 : static_cast<uint64_t>(INT64_MAX);
+    uint64_t magnitude = 0;
+    for (; ii < length; ii++) {
+        if (data[ii] < '0' || data[ii] > '9') {
+            return false;
+        }
+        const uint64_t digit = static_cast<uint64_t>(data[ii] - '0');
+        if (magnitude > (limit - digit) / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+    value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+int Distributer::parseParameter(const TheHashinator &hashinator, ByteBuffer &paramBuffer, int &index, int partitionParameterType){
+    // Mirrors the server's hashinator: null values, including the null sentinels of
+    // the integer types, hash to partition 0
     int8_t paramType = paramBuffer.getInt8(index++);
-    int64_t val = INT64_MIN;
+    int64_t val = 0;
     switch(paramType){
-    ///TODO:extend on all data types
+        case WIRE_TYPE_NULL:
+            return 0;
         case WIRE_TYPE_TINYINT:
         {
-            val = paramBuffer.getInt8(index);
+            const int8_t value = paramBuffer.getInt8(index);
+            if (value == INT8_MIN)
+                return 0;
+            val = value;
             break;
         }
         case WIRE_TYPE_SMALLINT:
         {
-            val = paramBuffer.getInt16(index);
+            const int16_t value = paramBuffer.getInt16(index);
+            if (value == INT16_MIN)
+                return 0;
+            val = value;
             break;
         }
         case WIRE_TYPE_INTEGER:
         {
-            val = paramBuffer.getInt32(index);
+            const int32_t value = paramBuffer.getInt32(index);
+            if (value == INT32_MIN)
+                return 0;
+            val = value;
             break;
         }
         case WIRE_TYPE_BIGINT:
-        case WIRE_TYPE_FLOAT:
-        case WIRE_TYPE_TIMESTAMP:
         {
             val = paramBuffer.getInt64(index);
             break;
         }
         case WIRE_TYPE_STRING:
+        case WIRE_TYPE_VARBINARY:
         {
-            bool wasNull = false;
-            std::string strVal = paramBuffer.getString(index, wasNull);
-
-            if(wasNull)
+            const int32_t length = paramBuffer.getInt32(index);
+            if (length < 0)
                 return 0;
-            return m_hashinator->hashinate((strVal.data()), strVal.size());
+            if (index + 4 + length > paramBuffer.limit())
+                return -1;
+            const char *data = paramBuffer.bytes() + index + 4;
+            if (paramType == WIRE_TYPE_VARBINARY) {
+                // empty byte arrays hash like nulls
+                if (length == 0)
+                    return 0;
+                return hashinator.hashinate(data, length);
+            }
+            // strings passed for integer partitioning parameters are converted by the server
+            if (isIntegerType(partitionParameterType)) {
+                if (!parseLong(data, length, val))
+                    return -1;
+                break;
+            }
+            return hashinator.hashinate(data, length);
         }
 
         default:
-            //not supported
+            //not a partitionable type
             return -1;
     }
 
-    if (val != INT64_MIN)
-        return m_hashinator->hashinate(val);
-    return -1;
+    return hashinator.hashinate(val);
 }
 
 
-int Distributer::getHashedPartitionForParameter(ByteBuffer &paramBuffer, int parameterId){
+int Distributer::getHashedPartitionForParameter(ByteBuffer &paramBuffer, int parameterId, int parameterType){
+    return getHashedPartitionForParameter(*snapshot(), paramBuffer, parameterId, parameterType);
+}
 
-    int index = 5;//offset
+int Distributer::getHashedPartitionForParameter(const RoutingSnapshot &routing, ByteBuffer &paramBuffer,
+                                                int parameterId, int parameterType){
+    if (!routing.m_isElastic || !routing.m_hashinator)
+        return -1;
 
-    bool wasNull;
-    std::string name = paramBuffer.getString(index, wasNull);
+    int index = getParameterOffset(paramBuffer, parameterId);
+    if (index < 0)
+        return -1;
+    return parseParameter(*routing.m_hashinator, paramBuffer, index, parameterType);
+}
+
+int Distributer::getParameterOffset(ByteBuffer &paramBuffer, int parameterId){
+    if (parameterId < 0)
+        return -1;
+
+    int index = 5;//offset
 
     //Skip procedure name and size, client data
-    index += sizeof(int32_t) + name.size() + sizeof(int64_t);
+    const int32_t nameLength = paramBuffer.getInt32(index);
+    index += sizeof(int32_t) + nameLength + sizeof(int64_t);
 
     //get number of parameters
-    paramBuffer.getInt16(index);
+    const int16_t parameterCount = paramBuffer.getInt16(index);
     index += 2;
+    if (parameterId >= parameterCount)
+        return -1;
 
-    //partition key must be the first
-    if (parameterId > 0)
-        return -1;//throw
+    //skip the parameters preceding the partitioning parameter
+    for (int ii = 0; ii < parameterId; ii++) {
+        if (!skipParameter(paramBuffer, index))
+            return -1;
+    }
+    return index;
+}
+
+void Distributer::getPartitionKeys(const RoutingSnapshot &routing, std::map<int, int64_t> &keys) throw (AllPartitionsInvocationException)
+{
+    keys.clear();
+    if (!routing.m_isElastic || !routing.m_hashinator || routing.m_partitionToHostId->empty()) {
+        throw AllPartitionsInvocationException("the topology is not loaded");
+    }
+    std::map<int32_t, uint64_t> shares;
+    routing.m_hashinator->ringShares(shares);
+    std::set<int> missing;
+    uint64_t smallestShare = UINT64_MAX;
+    for (std::map<int, int>::const_iterator it = routing.m_partitionToHostId->begin();
+         it != routing.m_partitionToHostId->end(); ++it) {
+        if (it->first == MP_INIT_PID) {
+            continue;
+        }
+        std::map<int32_t, uint64_t>::const_iterator share = shares.find(it->first);
+        if (share == shares.end()) {
+            std::ostringstream reason;
+            reason << "partition " << it->first << " owns no part of the hash ring";
+            throw AllPartitionsInvocationException(reason.str());
+        }
+        smallestShare = std::min(smallestShare, share->second);
+        missing.insert(it->first);
+    }
+
+    // A candidate hashes to a partition with the probability of the partition's share of the ring,
+    // the search gives up on a partition after as many candidates as miss it with a probability of e^-64
+    const int64_t limit = static_cast<int64_t>((UINT64_C(64) << 32) / smallestShare);
+    const size_t chunk = 1024;
+    int64_t candidates[chunk];
+    int32_t partitions[chunk];
+    for (int64_t first = 0; !missing.empty() && first < limit; first += static_cast<int64_t>(chunk)) {
+        for (size_t ii = 0; ii < chunk; ii++) {
+            candidates[ii] = first + static_cast<int64_t>(ii);
+        }
+        routing.m_hashinator->hashinateBatch(candidates, chunk, partitions);
+        for (size_t ii = 0; ii < chunk && !missing.empty(); ii++) {
+            if (missing.erase(partitions[ii]) > 0) {
+                keys.insert(std::make_pair(partitions[ii], candidates[ii]));
+            }
+        }
+    }
+    if (!missing.empty()) {
+        keys.clear();
+        std::ostringstream reason;
+        reason << "no key of partition " << *missing.begin() << " was found";
+        throw AllPartitionsInvocationException(reason.str());
+    }
+}
 
-    return parseParameter(paramBuffer, index);
+int Distributer::getHashedPartitionForParameterAt(ByteBuffer &paramBuffer, int offset, int parameterType){
+    return getHashedPartitionForParameterAt(*snapshot(), paramBuffer, offset, parameterType);
 }
 
-ProcedureInfo* Distributer::getProcedure(const std::string& procName) throw (UnknownProcedureException)
+int Distributer::getHashedPartitionForParameterAt(const RoutingSnapshot &routing, ByteBuffer &paramBuffer,
+                                                  int offset, int parameterType){
+    if (!routing.m_isElastic || !routing.m_hashinator || offset < 0 || offset >= paramBuffer.limit())
+        return -1;
+    return parseParameter(*routing.m_hashinator, paramBuffer, offset, parameterType);
+}
+
+boost::shared_ptr<const ProcedureInfo> Distributer::getProcedure(const std::string& procName) throw (UnknownProcedureException)
 {
-    std::map<std::string, ProcedureInfo>::iterator it = m_procedureInfo.find(procName);
-    if (it == m_procedureInfo.end())
-        return NULL;
-    return &it->second;
+    return getProcedure(snapshot(), procName);
+}
+
+boost::shared_ptr<const ProcedureInfo> Distributer::getProcedure(const boost::shared_ptr<const RoutingSnapshot> &current,
+                                                                 const std::string& procName)
+{
+    std::map<std::string, ProcedureInfo>::const_iterator it = current->m_procedureInfo->find(procName);
+    if (it == current->m_procedureInfo->end())
+        return boost::shared_ptr<const ProcedureInfo>();
+    // shares ownership of the snapshot so the entry outlives later updates
+    return boost::shared_ptr<const ProcedureInfo>(current, &it->second);
 }
 
 int Distributer::getHostIdByPartitionId(int partitionId)
 {
-    std::map<int, int>::iterator it = m_PartitionToHostId.find(partitionId);
-    if (it == m_PartitionToHostId.end())
+    const boost::shared_ptr<const std::map<int, int> > partitionToHostId = getPartitionToHostId();
+    std::map<int, int>::const_iterator it = partitionToHostId->find(partitionId);
+    if (it == partitionToHostId->end())
         return -1;
     return it->second;
 }
 
+boost::shared_ptr<const TheHashinator> Distributer::elasticHashinator() const
+{
+    const boost::shared_ptr<const RoutingSnapshot> current = snapshot();
+    if (!current->m_isElastic) {
+        return boost::shared_ptr<const TheHashinator>();
+    }
+    return current->m_hashinator;
+}
+
+void Distributer::publish(const boost::shared_ptr<RoutingSnapshot> &snapshot)
+{
+    boost::shared_ptr<const RoutingSnapshot> published(snapshot);
+    boost::atomic_store(&m_snapshot, published);
+    m_topologyVersion = snapshot->m_topologyVersion;
+    m_procedureInfoVersion = snapshot->m_procedureInfoVersion;
+}
+
+int32_t Distributer::hashinate(int64_t value) const
+{
+    const boost::shared_ptr<const TheHashinator> hashinator = elasticHashinator();
+    if (!hashinator) {
+        return -1;
+    }
+    return hashinator->hashinate(value);
+}
+
+int32_t Distributer::hashinate(const char *bytes, int32_t length) const
+{
+    const boost::shared_ptr<const TheHashinator> hashinator = elasticHashinator();
+    if (!hashinator) {
+        return -1;
+    }
+    return hashinator->hashinate(bytes, length);
+}
+
+void Distributer::hashinateBatch(const int64_t *values, size_t count, int32_t *partitions) const
+{
+    const boost::shared_ptr<const TheHashinator> hashinator = elasticHashinator();
+    if (!hashinator) {
+        std::fill(partitions, partitions + count, -1);
+        return;
+    }
+    hashinator->hashinateBatch(values, count, partitions);
+}
+
+void Distributer::hashinateBatch(const char * const *keys, const int32_t *lengths, size_t count, int32_t *partitions) const
+{
+    const boost::shared_ptr<const TheHashinator> hashinator = elasticHashinator();
+    if (!hashinator) {
+        std::fill(partitions, partitions + count, -1);
+        return;
+    }
+    hashinator->hashinateBatch(keys, lengths, count, partitions);
+}
+
 void Distributer::handleTopologyNotification(const std::vector<voltdb::Table>& t){
     // If The savedTopoTable is not the same as our notified one, we have to update the hashinator
-    if (m_savedTopoTable == t[0]) {
-        return;
+    {
+        boost::lock_guard<boost::mutex> lock(m_updateLock);
+        if (m_savedTopoTable == t[0]) {
+            return;
+        }
     }
     updateAffinityTopology(t);
     debug_msg("updateAffinityTopology after notification");
@@ -163,7 +450,11 @@ void Distributer::updateAffinityTopology(const std::vector<voltdb::Table>& topoT
 //    16383,     2:2,   2:2
 
     debug_msg("updateAffinityTopology ");
-    m_PartitionToHostId.clear();
+    boost::lock_guard<boost::mutex> lock(m_updateLock);
+    boost::shared_ptr<RoutingSnapshot> next(new RoutingSnapshot(*snapshot()));
+    ++next->m_topologyVersion;
+    boost::shared_ptr<std::map<int, int> > partitionToHostId(new std::map<int, int>());
+    boost::shared_ptr<std::map<int, std::vector<int> > > partitionToReplicaHostIds(new std::map<int, std::vector<int> >());
     voltdb::TableIterator tableIter = topoTable[0].iterator();
     while (tableIter.hasNext())
     {
@@ -179,8 +470,27 @@ void Distributer::updateAffinityTopology(const std::vector<voltdb::Table>& topoT
         hostId = atoi(token.c_str());
 
         debug_msg("updateAffinityTopology: partitionId=" <<partitionId << " hostId="<<hostId);
-        m_PartitionToHostId.insert(std::pair<int, int >(partitionId, hostId));
+        partitionToHostId->insert(std::pair<int, int >(partitionId, hostId));
+
+        //parse the host Id of every site, hostId:siteId separated by commas
+        std::vector<int> &replicaHostIds = (*partitionToReplicaHostIds)[partitionId];
+        std::istringstream sites(row.getString(1));
+        std::string site;
+        while (std::getline(sites, site, ',')) {
+            if (site.empty()) {
+                continue;
+            }
+            const int replicaHostId = atoi(site.substr(0, site.find(':')).c_str());
+            if (std::find(replicaHostIds.begin(), replicaHostIds.end(), replicaHostId) == replicaHostIds.end()) {
+                replicaHostIds.push_back(replicaHostId);
+            }
+        }
+        if (std::find(replicaHostIds.begin(), replicaHostIds.end(), hostId) == replicaHostIds.end()) {
+            replicaHostIds.push_back(hostId);
+        }
     }
+    next->m_partitionToHostId = partitionToHostId;
+    next->m_partitionToReplicaHostIds = partitionToReplicaHostIds;
 
     //Get partitions count from second table
     voltdb::TableIterator hashTableIter = topoTable[1].iterator();
@@ -196,23 +506,26 @@ void Distributer::updateAffinityTopology(const std::vector<voltdb::Table>& topoT
     if (hashMode.compare("ELASTIC") == 0 ) {
         boost::scoped_array<char> tokens(new char[realsize]);
         hashRow.getVarbinary(1, realsize, (uint8_t*)(tokens.get()), &realsize);
-        m_hashinator.reset(new ElasticHashinator(tokens.get()));
-        m_isElastic = true;
+        next->m_hashinator.reset(new ElasticHashinator(tokens.get()));
+        next->m_isElastic = true;
     }else{
-        m_isElastic = false;
+        next->m_isElastic = false;
     }
 
+    m_savedTopoTable = topoTable[0];
+    publish(next);
+
     //mark update status as finished
     m_isUpdating = false;
-
-    m_savedTopoTable = topoTable[0];
 }
 
 void Distributer::updateProcedurePartitioning(const std::vector<voltdb::Table>& procInfoTable){
 
     debug_msg("updateProcedurePartitioning ");
-    boost::unique_lock<boost::shared_mutex> lock(m_procInfoLock);
-    m_procedureInfo.clear();
+    boost::lock_guard<boost::mutex> lock(m_updateLock);
+    boost::shared_ptr<RoutingSnapshot> next(new RoutingSnapshot(*snapshot()));
+    ++next->m_procedureInfoVersion;
+    boost::shared_ptr<std::map<std::string, ProcedureInfo> > procedureInfo(new std::map<std::string, ProcedureInfo>());
 
     voltdb::TableIterator tableIter = procInfoTable[0].iterator();
 
@@ -222,8 +535,10 @@ void Distributer::updateProcedurePartitioning(const std::vector<voltdb::Table>&
         std::string procedureName = row.getString(2);
         std::string jsonString = row.getString(6);
 
-        m_procedureInfo.insert(std::pair<std::string, ProcedureInfo>(procedureName, ProcedureInfo(jsonString)));
+        procedureInfo->insert(std::pair<std::string, ProcedureInfo>(procedureName, ProcedureInfo(jsonString)));
     }
+    next->m_procedureInfo = procedureInfo;
+    publish(next);
 
 }
 
@@ -147,6 +147,79 @@ int32_t MurmurHash3_x64_128 ( const void * key, const int len,
   //Also use the h1 higher order bits because it provided much better performance in voter, consistent too
   return static_cast<int32_t>(h1 >> 32);
 }
+
+//-----------------------------------------------------------------------------
+// An 8 byte key is a single tail block, so with seed 0 the hash reduces to
+// mixing k1 followed by the finalization
+
+static FORCE_INLINE uint64_t int64block ( int64_t value )
+{
+  // the tail is assembled little endian from the key's bytes
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return __builtin_bswap64(static_cast<uint64_t>(value));
+#else
+  return static_cast<uint64_t>(value);
+#endif
+}
+
+static FORCE_INLINE int32_t hashInt64 ( int64_t value )
+{
+  const uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+  const uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+
+  uint64_t k1 = int64block(value);
+  k1 *= c1; k1  = ROTL64(k1,31); k1 *= c2;
+
+  uint64_t h1 = k1 ^ 8;
+  uint64_t h2 = 8;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  return static_cast<int32_t>(h1 >> 32);
+}
+
+void MurmurHash3_x64_128 ( const int64_t * values, size_t count, int32_t * hashes )
+{
+  const uint64_t c1 = BIG_CONSTANT(0x87c37b91114253d5);
+  const uint64_t c2 = BIG_CONSTANT(0x4cf5ad432745937f);
+  const size_t lanes = 4;
+
+  size_t i = 0;
+  for(; i + lanes <= count; i += lanes)
+  {
+    uint64_t h1[lanes];
+    uint64_t h2[lanes];
+
+    for(size_t l = 0; l < lanes; l++)
+    {
+      uint64_t k1 = int64block(values[i + l]);
+      k1 *= c1; k1  = ROTL64(k1,31); k1 *= c2;
+      h1[l] = k1 ^ 8;
+      h2[l] = 8;
+    }
+    for(size_t l = 0; l < lanes; l++)
+    {
+      h1[l] += h2[l];
+      h2[l] += h1[l];
+    }
+    for(size_t l = 0; l < lanes; l++)
+    {
+      h1[l] = fmix(h1[l]);
+      h2[l] = fmix(h2[l]);
+    }
+    for(size_t l = 0; l < lanes; l++)
+    {
+      hashes[i + l] = static_cast<int32_t>((h1[l] + h2[l]) >> 32);
+    }
+  }
+
+  for(; i < count; i++)
+  {
+    hashes[i] = hashInt64(values[i]);
+  }
+}
 }
 //-----------------------------------------------------------------------------
 
@@ -0,0 +1,262 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "ResponseStream.h"
+#include "RowCursor.hpp"
+
+namespace voltdb {
+
+// version, client data and the present fields
+static const int32_t MIN_HEADER_LENGTH = 10;
+
+static int32_t readInt32(const char *data) {
+    char bytes[4];
+    ::memcpy(bytes, data, 4);
+    ByteBuffer buffer(bytes, 4);
+    return buffer.getInt32();
+}
+
+/*
+ * Length of the response header up to and including the result count if the available bytes hold
+ * it, the number of bytes needed to find out more otherwise
+ */
+static int32_t headerLength(const char *data, int32_t available) {
+    const uint8_t presentFields = static_cast<uint8_t>(data[9]);
+    int32_t position = MIN_HEADER_LENGTH + 1; // status
+    // status string, app status, app status string, round trip time, serialized exception
+    const uint8_t optionalFields[] = { 1 << 5, 0, 1 << 7, 0, 1 << 6 };
+    const int32_t fixedLengths[] = { 0, 1, 0, 4, 0 };
+    for (size_t ii = 0; ii < sizeof(fixedLengths) / sizeof(fixedLengths[0]); ii++) {
+        if (optionalFields[ii] == 0) {
+            position += fixedLengths[ii];
+        } else if ((presentFields & optionalFields[ii]) != 0) {
+            if (available < position + 4) {
+                return position + 4;
+            }
+            position += 4 + std::max(0, readInt32(data + position));
+        }
+    }
+    return position + 2; // result count
+}
+
+ResponseStream::ResponseStream(int32_t length, int64_t clientData,
+                               const boost::shared_ptr<StreamingProcedureCallback> &callback,
+                               const boost::shared_ptr<SchemaCache> &schemas) :
+    m_clientData(clientData), m_callback(callback), m_schemas(schemas), m_state(STATE_HEADER), m_abandoned(false),
+    m_malformed(false), m_callbackFailed(false), m_remaining(length),
+    m_tableRemaining(0), m_tableCount(0), m_tableIndex(0), m_rowsRemaining(0), m_batchCapacity(0) {
+}
+
+void ResponseStream::consumed(int32_t length) {
+    if (length > m_remaining) {
+        throw OverflowUnderflowException();
+    }
+    m_remaining -= length;
+}
+
+char *ResponseStream::batch(int32_t length) {
+    if (length > m_batchCapacity) {
+        m_batchCapacity = std::max(length, BATCH_BYTES);
+        m_batch.reset(new char[m_batchCapacity]);
+    }
+    return m_batch.get();
+}
+
+size_t ResponseStream::read(struct evbuffer *input, bool &breakEventLoop) {
+    m_callbackFailed = false;
+    try {
+        return readMessage(input, breakEventLoop);
+    } catch (...) {
+        m_malformed |= !m_callbackFailed;
+        throw;
+    }
+}
+
+size_t ResponseStream::readMessage(struct evbuffer *input, bool &breakEventLoop) {
+    while (m_remaining > 0) {
+        size_t needed = 0;
+        if (m_abandoned) {
+            m_state = STATE_SKIP;
+        }
+        switch (m_state) {
+            case STATE_HEADER:
+                needed = readHeader(input);
+                break;
+            case STATE_TABLE:
+                needed = readTable(input, breakEventLoop);
+                break;
+            case STATE_ROWS:
+                needed = readRows(input, breakEventLoop);
+                break;
+            case STATE_SKIP: {
+                const int32_t available = static_cast<int32_t>(std::min(evbuffer_get_length(input),
+                                                                        static_cast<size_t>(m_remaining)));
+                evbuffer_drain(input, static_cast<size_t>(available));
+                consumed(available);
+                if (m_remaining > 0) {
+                    needed = 1;
+                }
+                break;
+            }
+        }
+        if (needed > 0) {
+            return needed;
+        }
+    }
+    return 0;
+}
+
+size_t ResponseStream::readHeader(struct evbuffer *input) {
+    const int32_t available = static_cast<int32_t>(std::min(evbuffer_get_length(input), static_cast<size_t>(m_remaining)));
+    int32_t length = MIN_HEADER_LENGTH;
+    const char *data = NULL;
+    // pull up as much of the header as is known to be needed until all of it is
+    while (true) {
+        if (available < length) {
+            return static_cast<size_t>(length);
+        }
+        data = reinterpret_cast<const char*>(evbuffer_pullup(input, length));
+        const int32_t needed = headerLength(data, length);
+        if (needed > m_remaining) {
+            throw OverflowUnderflowException();
+        }
+        if (needed <= length) {
+            length = needed;
+            break;
+        }
+        length = needed;
+    }
+
+    boost::shared_array<char> header(new char[length]);
+    ::memcpy(header.get(), data, static_cast<size_t>(length));
+    ByteBuffer resultCount(header.get() + length - 2, 2);
+    m_tableCount = static_cast<size_t>(std::max<int16_t>(0, resultCount.getInt16()));
+    // the results are passed to the callback as they arrive rather than with the response
+    resultCount.putInt16(0, 0);
+    m_response = InvocationResponse(header, length, m_schemas);
+    evbuffer_drain(input, static_cast<size_t>(length));
+    consumed(length);
+    m_state = m_tableCount > 0 ? STATE_TABLE : STATE_SKIP;
+    return 0;
+}
+
+size_t ResponseStream::readTable(struct evbuffer *input, bool &breakEventLoop) {
+    // table length, header size, the header and the row count
+    const size_t available = evbuffer_get_length(input);
+    if (available < 8) {
+        return 8;
+    }
+    const char *data = reinterpret_cast<const char*>(evbuffer_pullup(input, 8));
+    const int32_t tableLength = readInt32(data);
+    const int32_t headerSize = readInt32(data + 4);
+    if (tableLength < 0 || headerSize < 0 || tableLength > m_remaining - 4 || headerSize > tableLength - 8) {
+        throw OverflowUnderflowException();
+    }
+    const int32_t length = 8 + headerSize + 4;
+    if (available < static_cast<size_t>(length)) {
+        return static_cast<size_t>(length);
+    }
+    data = reinterpret_cast<const char*>(evbuffer_pullup(input, length));
+
+    // the table without the length prefix, and without rows
+    boost::shared_array<char> schema(new char[length - 4]);
+    ::memcpy(schema.get(), data + 4, static_cast<size_t>(length - 4));
+    ByteBuffer rowCount(schema.get() + length - 8, 4);
+    m_rowsRemaining = rowCount.getInt32();
+    if (m_rowsRemaining < 0) {
+        throw OverflowUnderflowException();
+    }
+    rowCount.putInt32(0, 0);
+    m_table = Table(SharedByteBuffer(schema, length - 4), m_schemas.get());
+    m_tableRemaining = tableLength - (length - 4);
+    evbuffer_drain(input, static_cast<size_t>(length));
+    consumed(length);
+    m_state = STATE_ROWS;
+    try {
+        breakEventLoop |= m_callback->table(m_tableIndex, m_table, m_rowsRemaining);
+    } catch (...) {
+        m_callbackFailed = true;
+        throw;
+    }
+    return 0;
+}
+
+size_t ResponseStream::readRows(struct evbuffer *input, bool &breakEventLoop) {
+    if (m_rowsRemaining == 0) {
+        if (m_tableRemaining != 0) {
+            throw OverflowUnderflowException();
+        }
+        m_tableIndex++;
+        m_state = m_tableIndex < m_tableCount ? STATE_TABLE : STATE_SKIP;
+        return 0;
+    }
+
+    // copy out the complete rows, up to a batch of them
+    int32_t batchLength = 0;
+    int32_t rows = 0;
+    size_t needed = 0;
+    while (rows < m_rowsRemaining && batchLength < BATCH_BYTES) {
+        char lengthBytes[4];
+        if (evbuffer_copyout(input, lengthBytes, 4) < 4) {
+            needed = 4;
+            break;
+        }
+        const int32_t rowLength = readInt32(lengthBytes);
+        if (rowLength < 0 || rowLength > m_tableRemaining - 4 - batchLength) {
+            throw OverflowUnderflowException();
+        }
+        if (evbuffer_get_length(input) < static_cast<size_t>(4 + rowLength)) {
+            needed = static_cast<size_t>(4 + rowLength);
+            break;
+        }
+        if (batchLength + 4 + rowLength > m_batchCapacity) {
+            if (rows > 0) {
+                break;
+            }
+            batch(4 + rowLength);
+        }
+        evbuffer_remove(input, m_batch.get() + batchLength, static_cast<size_t>(4 + rowLength));
+        batchLength += 4 + rowLength;
+        rows++;
+    }
+    if (rows == 0) {
+        return needed;
+    }
+
+    consumed(batchLength);
+    m_tableRemaining -= batchLength;
+    m_rowsRemaining -= rows;
+    RowCursor cursor(SharedByteBuffer(m_batch, batchLength), m_table.m_columns, rows, m_table.m_columnIndex);
+    while (cursor.next()) {
+        try {
+            breakEventLoop |= m_callback->row(m_tableIndex, cursor);
+        } catch (...) {
+            m_callbackFailed = true;
+            throw;
+        }
+    }
+    return 0;
+}
+}
@@ -0,0 +1,77 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include "SchemaCache.h"
+#include "MurmurHash3.h"
+
+namespace voltdb {
+
+static bool matches(const std::string &interned, const char *schema, int32_t length) {
+    return interned.size() == static_cast<size_t>(length) && ::memcmp(interned.data(), schema, interned.size()) == 0;
+}
+
+SchemaCache::Schema SchemaCache::find(const char *schema, int32_t length) {
+    boost::mutex::scoped_lock lock(m_lock);
+    if (m_last.m_decoded.m_columns.get() != NULL && matches(m_last.m_schema, schema, length)) {
+        return m_last.m_decoded;
+    }
+    boost::unordered_map<int32_t, std::vector<Entry> >::const_iterator bucket =
+            m_schemas.find(MurmurHash3_x64_128(schema, length, 0));
+    if (bucket != m_schemas.end()) {
+        for (std::vector<Entry>::const_iterator it = bucket->second.begin(); it != bucket->second.end(); ++it) {
+            if (matches(it->m_schema, schema, length)) {
+                m_last = *it;
+                return it->m_decoded;
+            }
+        }
+    }
+    return Schema();
+}
+
+void SchemaCache::insert(const char *schema, int32_t length, const Schema &decoded) {
+    boost::mutex::scoped_lock lock(m_lock);
+    if (m_size >= MAX_SCHEMAS) {
+        m_schemas.clear();
+        m_size = 0;
+    }
+    std::vector<Entry> &bucket = m_schemas[MurmurHash3_x64_128(schema, length, 0)];
+    for (std::vector<Entry>::const_iterator it = bucket.begin(); it != bucket.end(); ++it) {
+        if (matches(it->m_schema, schema, length)) {
+            // interned by another thread meanwhile
+            return;
+        }
+    }
+    Entry entry;
+    entry.m_schema.assign(schema, static_cast<size_t>(length));
+    entry.m_decoded = decoded;
+    bucket.push_back(entry);
+    m_last = entry;
+    m_size++;
+}
+
+size_t SchemaCache::size() {
+    boost::mutex::scoped_lock lock(m_lock);
+    return m_size;
+}
+}
@@ -0,0 +1,127 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <event2/buffer.h>
+#include "SegmentedBuffer.h"
+
+namespace voltdb {
+
+namespace {
+/*
+ * Deleter of the shared reference to the chain, which ignores the chunk it is given
+ */
+class ChainRelease {
+public:
+    explicit ChainRelease(struct evbuffer *chain) : m_chain(chain) {}
+
+    void operator()(char *) const {
+        evbuffer_free(m_chain);
+    }
+
+private:
+    struct evbuffer *m_chain;
+};
+}
+
+SegmentedBuffer::SegmentedBuffer(struct evbuffer *input, int32_t length) throw (LibEventException) :
+        m_length(length) {
+    struct evbuffer *chain = evbuffer_new();
+    if (chain == NULL) {
+        throw LibEventException("evbuffer_new failed to allocate the chain of a segmented buffer");
+    }
+    if (length < 0 || evbuffer_remove_buffer(input, chain, static_cast<size_t>(length)) != length) {
+        evbuffer_free(chain);
+        throw LibEventException("evbuffer_remove_buffer did not move the whole message");
+    }
+
+    const int count = evbuffer_peek(chain, -1, NULL, NULL, 0);
+    std::vector<struct evbuffer_iovec> chunks(static_cast<size_t>(std::max(count, 0)));
+    if (count > 0) {
+        evbuffer_peek(chain, -1, NULL, &chunks[0], count);
+    }
+    int32_t offset = 0;
+    for (std::vector<struct evbuffer_iovec>::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        if (it->iov_len == 0) {
+            continue;
+        }
+        m_segments.push_back(static_cast<char*>(it->iov_base));
+        m_offsets.push_back(offset);
+        offset += static_cast<int32_t>(it->iov_len);
+    }
+    m_offsets.push_back(offset);
+    assert(offset == m_length);
+
+    // the chain is never added to or drained, so the chunks stay where they are
+    static char empty;
+    m_ref = boost::shared_array<char>(m_segments.empty() ? &empty : m_segments[0], ChainRelease(chain));
+}
+
+size_t SegmentedBuffer::segmentAt(int32_t offset) const {
+    return static_cast<size_t>(std::upper_bound(m_offsets.begin(), m_offsets.end(), offset) - m_offsets.begin()) - 1;
+}
+
+bool SegmentedBuffer::contiguous(int32_t offset, int32_t length) const {
+    if (offset < 0 || length <= 0 || length > m_length - offset) {
+        return false;
+    }
+    return offset + length <= m_offsets[segmentAt(offset) + 1];
+}
+
+void SegmentedBuffer::get(int32_t offset, char *storage, int32_t length) const throw (IndexOutOfBoundsException) {
+    if (offset < 0 || length < 0 || length > m_length - offset) {
+        throw IndexOutOfBoundsException();
+    }
+    for (size_t segment = segmentAt(offset); length > 0; segment++) {
+        const int32_t start = offset - m_offsets[segment];
+        const int32_t count = std::min(length, m_offsets[segment + 1] - offset);
+        ::memcpy(storage, m_segments[segment] + start, static_cast<size_t>(count));
+        storage += count;
+        offset += count;
+        length -= count;
+    }
+}
+
+int32_t SegmentedBuffer::getInt32(int32_t offset) const throw (IndexOutOfBoundsException) {
+    int32_t value;
+    get(offset, reinterpret_cast<char*>(&value), 4);
+    return static_cast<int32_t>(ntohl(value));
+}
+
+SharedByteBuffer SegmentedBuffer::slice(int32_t offset, int32_t length) const throw (IndexOutOfBoundsException) {
+    if (offset < 0 || length < 0 || length > m_length - offset) {
+        throw IndexOutOfBoundsException();
+    }
+    if (contiguous(offset, length)) {
+        const size_t segment = segmentAt(offset);
+        boost::shared_array<char> ref(m_ref);
+        SharedByteBuffer shared(ref, 0);
+        shared.window(m_segments[segment] + (offset - m_offsets[segment]), length);
+        return shared;
+    }
+    boost::shared_array<char> copy(new char[length > 0 ? length : 1]);
+    get(offset, copy.get(), length);
+    return SharedByteBuffer(copy, length);
+}
+}
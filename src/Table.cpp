@@ -20,24 +20,31 @@
  * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
  * OTHER DEALINGS IN THE SOFTWARE.
  */
+#include <algorithm>
+#include <exception>
 #include <vector>
+#include <boost/thread/thread.hpp>
 
 #include "Table.h"
 #include "TableIterator.h"
+#include "RowCursor.hpp"
 #include "Row.hpp"
 #include "RowBuilder.h"
+#include "SchemaCache.h"
+#include "SegmentedBuffer.h"
 
 namespace voltdb {
     const int32_t Table::MAX_TUPLE_LENGTH = 2097152;
     const int8_t Table::DEFAULT_STATUS_CODE = INT8_MIN;
 
-    Table::Table(SharedByteBuffer buffer) : m_buffer(buffer) {
-        buffer.position(5);
+    /*
+     * Columns of the schema at the buffer's position
+     */
+    static boost::shared_ptr<std::vector<voltdb::Column> > decodeColumns(SharedByteBuffer &buffer) {
         size_t columnCount = static_cast<size_t>(buffer.getInt16());
         assert(columnCount > 0);
         boost::shared_ptr<std::vector< voltdb::Column> > columns(
                                 new std::vector< voltdb::Column>(columnCount));
-        m_columns = columns;
 
         std::vector<int8_t> types(columnCount);
         for (size_t ii = 0; ii < columnCount; ii++) {
@@ -45,13 +52,89 @@ namespace voltdb {
         }
         for (size_t ii = 0; ii < columnCount; ii++) {
             bool wasNull = false;
-            m_columns->at(ii) = voltdb::Column(buffer.getString(wasNull), static_cast<WireType>(types[ii]));
+            columns->at(ii) = voltdb::Column(buffer.getString(wasNull), static_cast<WireType>(types[ii]));
             assert(!wasNull);
         }
+        return columns;
+    }
+
+    Table::Table(SharedByteBuffer buffer, SchemaCache *schemas) :
+        m_buffer(buffer) {
         m_rowCountPosition = m_buffer.getInt32(0) + 4;
         m_rowCount = m_buffer.getInt32(m_rowCountPosition);
 
+        // the schema follows the header size and status code
+        buffer.position(5);
+        if (schemas == NULL) {
+            // the name index only pays off once it is shared, by-name access scans the columns
+            m_columns = decodeColumns(buffer);
+        } else {
+            const char *schema = buffer.bytes() + 5;
+            const int32_t schemaLength = m_rowCountPosition - 5;
+            SchemaCache::Schema decoded = schemas->find(schema, schemaLength);
+            if (decoded.m_columns.get() == NULL) {
+                decoded.m_columns = decodeColumns(buffer);
+                decoded.m_columnIndex.reset(new ColumnNameIndex(*decoded.m_columns));
+                schemas->insert(schema, schemaLength, decoded);
+            }
+            m_columns = decoded.m_columns;
+            m_columnIndex = decoded.m_columnIndex;
+        }
+
+        m_buffer.position(m_buffer.limit());
+    }
+
+    Table::Table(const boost::shared_ptr<SegmentedBuffer> &segments, int32_t offset, int32_t length,
+                 SchemaCache *schemas) throw (OverflowUnderflowException, IndexOutOfBoundsException) {
+        if (segments->contiguous(offset, length)) {
+            *this = Table(segments->slice(offset, length), schemas);
+            return;
+        }
+        const int32_t headerLength = segments->getInt32(offset) + 8;
+        if (headerLength < 8 || headerLength > length) {
+            throw OverflowUnderflowException();
+        }
+        // a header of its own, a slice of a chunk would keep the whole chain alive after the rows are copied
+        boost::shared_array<char> header(new char[headerLength]);
+        segments->get(offset, header.get(), headerLength);
+        *this = Table(SharedByteBuffer(header, headerLength), schemas);
+        m_spanned.reset(new SpannedRows(segments, offset, length));
+    }
+
+    void Table::ensureContiguous() const {
+        if (!m_spanned) {
+            return;
+        }
+        {
+            boost::lock_guard<boost::mutex> guard(m_spanned->m_lock);
+            if (m_spanned->m_segments) {
+                boost::shared_array<char> data(new char[m_spanned->m_length]);
+                m_spanned->m_segments->get(m_spanned->m_offset, data.get(), m_spanned->m_length);
+                m_spanned->m_contiguous = SharedByteBuffer(data, m_spanned->m_length);
+                m_spanned->m_segments.reset();
+            }
+            m_buffer = m_spanned->m_contiguous;
+        }
         m_buffer.position(m_buffer.limit());
+        m_spanned.reset();
+    }
+
+    /*
+     * Returns the segments holding the rows, or NULL once they are in m_buffer, adopting the
+     * buffer another copy of the table already copied the rows into
+     */
+    boost::shared_ptr<SegmentedBuffer> Table::spannedSegments() const {
+        if (!m_spanned) {
+            return boost::shared_ptr<SegmentedBuffer>();
+        }
+        {
+            boost::lock_guard<boost::mutex> guard(m_spanned->m_lock);
+            if (m_spanned->m_segments) {
+                return m_spanned->m_segments;
+            }
+        }
+        ensureContiguous();
+        return boost::shared_ptr<SegmentedBuffer>();
     }
 
     Table::Table(const std::vector<Column> &columns) throw (TableException) {
@@ -91,13 +174,125 @@ namespace voltdb {
         m_buffer.limit(m_buffer.position());
     }
 
+    boost::shared_ptr<const std::vector<int32_t> > Table::findRowOffsets() const
+            throw (OverflowUnderflowException, IndexOutOfBoundsException) {
+        if (m_rowOffsets) {
+            return m_rowOffsets;
+        }
+        ensureContiguous();
+        boost::shared_ptr<std::vector<int32_t> > offsets(new std::vector<int32_t>(static_cast<size_t>(m_rowCount) + 1));
+        int32_t offset = m_rowCountPosition + 4;
+        for (int32_t ii = 0; ii < m_rowCount; ii++) {
+            (*offsets)[static_cast<size_t>(ii)] = offset;
+            const int32_t rowLength = m_buffer.getInt32(offset);
+            if (rowLength < 0 || rowLength > m_buffer.limit() - offset - 4) {
+                throw OverflowUnderflowException();
+            }
+            offset += 4 + rowLength;
+        }
+        (*offsets)[static_cast<size_t>(m_rowCount)] = offset;
+        return offsets;
+    }
+
+    void Table::buildRowIndex() throw (OverflowUnderflowException, IndexOutOfBoundsException) {
+        m_rowOffsets = findRowOffsets();
+    }
+
+    Row Table::row(int32_t index) const throw (TableException, IndexOutOfBoundsException) {
+        if (!m_rowOffsets) {
+            throw TableException("The row index of the table was not built, see buildRowIndex()");
+        }
+        if (index < 0 || index >= m_rowCount) {
+            throw IndexOutOfBoundsException();
+        }
+        const int32_t start = (*m_rowOffsets)[static_cast<size_t>(index)] + 4;
+        const int32_t end = (*m_rowOffsets)[static_cast<size_t>(index) + 1];
+        SharedByteBuffer data(m_buffer);
+        data.window(m_buffer.bytes() + start, end - start);
+        boost::shared_ptr<std::vector<voltdb::Column> > columns(m_columns);
+        return Row(data, columns, m_columnIndex);
+    }
+
+    namespace {
+    /*
+     * Runs a function over a contiguous range of rows with a cursor of its own, keeping the
+     * exception the function throws
+     */
+    class RowRange {
+    public:
+        RowRange(const RowCursor &cursor, int32_t firstRow, const boost::function<void (int32_t, Row&)> &function,
+                 std::exception_ptr &error) :
+            m_cursor(cursor), m_firstRow(firstRow), m_function(function), m_error(error) {}
+
+        void operator()() {
+            try {
+                while (m_cursor.next()) {
+                    m_function(m_firstRow + m_cursor.rowIndex(), m_cursor);
+                }
+            } catch (...) {
+                m_error = std::current_exception();
+            }
+        }
+
+    private:
+        RowCursor m_cursor;
+        const int32_t m_firstRow;
+        const boost::function<void (int32_t, Row&)> &m_function;
+        std::exception_ptr &m_error;
+    };
+    }
+
+    void Table::parallelForEachRow(int32_t threads, const boost::function<void (int32_t, Row&)> &function) const {
+        if (threads <= 0) {
+            threads = std::max(1, static_cast<int32_t>(boost::thread::hardware_concurrency()));
+        }
+        threads = std::max(1, std::min(threads, m_rowCount));
+        boost::shared_ptr<const std::vector<int32_t> > offsets = findRowOffsets();
+
+        std::vector<RowRange> ranges;
+        std::vector<std::exception_ptr> errors(static_cast<size_t>(threads));
+        ranges.reserve(static_cast<size_t>(threads));
+        for (int32_t ii = 0; ii < threads; ii++) {
+            const int32_t firstRow = static_cast<int32_t>(static_cast<int64_t>(m_rowCount) * ii / threads);
+            const int32_t endRow = static_cast<int32_t>(static_cast<int64_t>(m_rowCount) * (ii + 1) / threads);
+            const int32_t start = (*offsets)[static_cast<size_t>(firstRow)];
+            SharedByteBuffer rows(m_buffer);
+            rows.window(m_buffer.bytes() + start, (*offsets)[static_cast<size_t>(endRow)] - start);
+            ranges.push_back(RowRange(RowCursor(rows, m_columns, endRow - firstRow, m_columnIndex), firstRow,
+                                      function, errors[static_cast<size_t>(ii)]));
+        }
+
+        boost::thread_group workers;
+        for (size_t ii = 1; ii < ranges.size(); ii++) {
+            workers.create_thread(boost::ref(ranges[ii]));
+        }
+        ranges[0]();
+        workers.join_all();
+        for (std::vector<std::exception_ptr>::const_iterator it = errors.begin(); it != errors.end(); ++it) {
+            if (*it) {
+                std::rethrow_exception(*it);
+            }
+        }
+    }
+
     int8_t Table::getStatusCode() const{
         return m_buffer.getInt8(4);
     }
 
     TableIterator Table::iterator() const{
+        boost::shared_ptr<SegmentedBuffer> segments = spannedSegments();
+        if (segments) {
+            return TableIterator(segments, m_spanned->m_offset + m_rowCountPosition + 4, m_columns, m_rowCount,
+                                 m_columnIndex);
+        }
+        m_buffer.position(m_rowCountPosition + 4);//skip row count
+        return TableIterator(m_buffer.slice(), m_columns, m_rowCount, m_columnIndex);
+    }
+
+    RowCursor Table::cursor() const{
+        ensureContiguous();
         m_buffer.position(m_rowCountPosition + 4);//skip row count
-        return TableIterator(m_buffer.slice(), m_columns, m_rowCount);
+        return RowCursor(m_buffer.slice(), m_columns, m_rowCount, m_columnIndex);
     }
 
     int32_t Table::rowCount() const{
@@ -108,6 +303,22 @@ namespace voltdb {
         return static_cast<int32_t>(m_columns->size());
     }
 
+    int32_t Table::columnIndex(const std::string &name) const throw (InvalidColumnException) {
+        if (m_columnIndex) {
+            const int32_t index = m_columnIndex->find(name);
+            if (index < 0) {
+                throw InvalidColumnException(name);
+            }
+            return index;
+        }
+        for (size_t ii = 0; ii < m_columns->size(); ii++) {
+            if ((*m_columns)[ii].name() == name) {
+                return static_cast<int32_t>(ii);
+            }
+        }
+        throw InvalidColumnException(name);
+    }
+
     std::vector<voltdb::Column> Table::columns() const {
         return *m_columns;
     }
@@ -120,7 +331,7 @@ namespace voltdb {
     }
 
     void Table::toString(std::ostringstream &ostream, std::string indent) const {
-        ostream << indent << "Table size: " << m_buffer.capacity() << std::endl;
+        ostream << indent << "Table size: " << (m_spanned ? m_spanned->m_length : m_buffer.capacity()) << std::endl;
         ostream << indent << "Status code: " << static_cast<int32_t>(getStatusCode()) << std::endl;
         ostream << indent << "Column names: ";
         for (size_t ii = 0; ii < m_columns->size(); ii++) {
@@ -152,8 +363,8 @@ namespace voltdb {
     }
 
     void Table::addRow(RowBuilder& row) throw (TableException, UninitializedColumnException, InCompatibleSchemaException) {
-        const std::vector<Column> schema = row.columns();
-        validateRowScehma(schema);
+        validateRowScehma(row.columns());
+        ensureContiguous();
         m_buffer.limit(m_buffer.capacity());
 
         int32_t serializeRowSize = row.getSerializedSize();
@@ -168,10 +379,12 @@ namespace voltdb {
 
         // update row count
         m_buffer.putInt32(m_rowCountPosition, ++m_rowCount);
+        m_rowOffsets.reset();
         m_buffer.limit(m_buffer.position());
     }
 
     void Table::operator >> (std::ostream &ostream) const {
+        ensureContiguous();
 
         int32_t size = m_buffer.limit();
         ostream.write((const char*)&size, sizeof(size));
@@ -192,6 +405,7 @@ namespace voltdb {
                     "Use the getSerializedSize method to determine the necessary size");
         }
 
+        ensureContiguous();
         int32_t startPosition = buffer.position();
         buffer.position(startPosition + 4);
         m_buffer.flip();
@@ -203,6 +417,7 @@ namespace voltdb {
     }
 
     int32_t Table::getSerializedSize() const {
+        ensureContiguous();
         return 4 + m_buffer.position();
     }
 
@@ -211,9 +426,11 @@ namespace voltdb {
         if (this == &rhs) return true;
         bool eq = (this->rowCount() == rhs.rowCount() && this->columnCount() == rhs.columnCount());
         if (!eq) return false;
-        //Make sure all columns and their order matches.
-        if (m_columns != rhs.m_columns) return false;
+        //Make sure all columns and their order matches, interned schemas are the same vector.
+        if (m_columns != rhs.m_columns && *m_columns != *rhs.m_columns) return false;
         //Is underlying buffer same?
+        ensureContiguous();
+        rhs.ensureContiguous();
         return (m_buffer == rhs.m_buffer);
     }
 
@@ -222,9 +439,11 @@ namespace voltdb {
         if (this == &rhs) return false;
         bool noteq = (this->rowCount() != rhs.rowCount() || this->columnCount() != rhs.columnCount());
         if (noteq) return true;
-        //Make sure all columns and their order matches.
-        if (m_columns != rhs.m_columns) return true;
+        //Make sure all columns and their order matches, interned schemas are the same vector.
+        if (m_columns != rhs.m_columns && *m_columns != *rhs.m_columns) return true;
         //Is underlying buffer same?
+        ensureContiguous();
+        rhs.ensureContiguous();
         return (m_buffer != rhs.m_buffer);
     }
 
@@ -26,6 +26,7 @@
 #include "Exception.hpp"
 #include "ByteBuffer.hpp"
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 namespace voltdb {
 
@@ -52,6 +53,8 @@ CPPUNIT_TEST( testInt16 );
 CPPUNIT_TEST( testInt32 );
 CPPUNIT_TEST( testInt64 );
 CPPUNIT_TEST( testDouble );
+CPPUNIT_TEST( testBulkValues );
+CPPUNIT_TEST_EXCEPTION( testBulkValuesOverflow, voltdb::OverflowUnderflowException );
 CPPUNIT_TEST( testString );
 CPPUNIT_TEST_EXCEPTION( testPositionNegative, voltdb::IndexOutOfBoundsException );
 CPPUNIT_TEST_EXCEPTION( testPositionOver, voltdb::IndexOutOfBoundsException );
@@ -310,6 +313,66 @@ public:
         CPPUNIT_ASSERT(b.position() == 8);
     }
 
+    // every count up to a few SIMD blocks, so both the shuffled blocks and the leftover values are covered
+    void testBulkValues() {
+        for (int32_t count = 0; count < 70; count++) {
+            std::vector<int16_t> shorts(count);
+            std::vector<int32_t> ints(count);
+            std::vector<int64_t> longs(count);
+            std::vector<double> doubles(count);
+            for (int32_t ii = 0; ii < count; ii++) {
+                shorts[ii] = static_cast<int16_t>(ii * 0x0102 - 3000);
+                ints[ii] = ii * 0x01020304 - 7;
+                longs[ii] = static_cast<int64_t>(ii) * 0x0102030405060708LL - 11;
+                doubles[ii] = ii * -1.25;
+            }
+            // one byte in, so the values are unaligned
+            const int32_t size = 1 + count * 22;
+            std::vector<char> storage(size);
+            ByteBuffer b(&storage[0], size);
+            b.putInt8(7);
+            b.putInt16s(shorts.data(), count).putInt32s(ints.data(), count);
+            b.putInt64s(longs.data(), count).putDoubles(doubles.data(), count);
+            CPPUNIT_ASSERT(b.remaining() == 0);
+            b.flip();
+            CPPUNIT_ASSERT(b.getInt8() == 7);
+            for (int32_t ii = 0; ii < count; ii++) {
+                CPPUNIT_ASSERT(b.getInt16() == shorts[ii]);
+            }
+            for (int32_t ii = 0; ii < count; ii++) {
+                CPPUNIT_ASSERT(b.getInt32() == ints[ii]);
+            }
+            for (int32_t ii = 0; ii < count; ii++) {
+                CPPUNIT_ASSERT(b.getInt64() == longs[ii]);
+            }
+            for (int32_t ii = 0; ii < count; ii++) {
+                CPPUNIT_ASSERT(b.getDouble() == doubles[ii]);
+            }
+
+            std::vector<int16_t> shortsRead(count);
+            std::vector<int32_t> intsRead(count);
+            std::vector<int64_t> longsRead(count);
+            std::vector<double> doublesRead(count);
+            b.position(1);
+            b.getInt16s(shortsRead.data(), count);
+            b.getInt32s(intsRead.data(), count);
+            b.getInt64s(longsRead.data(), count);
+            b.getDoubles(doublesRead.data(), count);
+            CPPUNIT_ASSERT(b.remaining() == 0);
+            CPPUNIT_ASSERT(shortsRead == shorts);
+            CPPUNIT_ASSERT(intsRead == ints);
+            CPPUNIT_ASSERT(longsRead == longs);
+            CPPUNIT_ASSERT(doublesRead == doubles);
+        }
+    }
+
+    void testBulkValuesOverflow() {
+        char storage[16];
+        ByteBuffer b(storage, 16);
+        int64_t values[3] = { 1, 2, 3 };
+        b.putInt64s(values, 3);
+    }
+
     void testString() {
         char storage[64];
         std::string value("hello world");
@@ -24,6 +24,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/TestFixture.h>
 #include <vector>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include "Client.h"
 #include "MockVoltDB.h"
 #include "StatusListener.h"
@@ -32,6 +33,16 @@
 #include "Procedure.hpp"
 #include "WireType.h"
 #include "ProcedureCallback.hpp"
+#include "BatchCallback.hpp"
+#include "AllPartitionsCallback.hpp"
+#include "GroupedByPartitionCallback.hpp"
+#include "StreamingProcedureCallback.hpp"
+#include "ResponseStream.h"
+#include "SegmentedBuffer.h"
+#include "TableIterator.h"
+#include "Distributer.h"
+#include "BulkLoader.h"
+#include "RowBuilder.h"
 #include "InvocationResponse.hpp"
 #include "ClientConfig.h"
 
@@ -89,6 +100,25 @@ CPPUNIT_TEST( testCallbackThrows );
 CPPUNIT_TEST( testDrain );
 CPPUNIT_TEST( testLostConnectionDuringDrain );
 CPPUNIT_TEST( testSynchronousInvocations );
+CPPUNIT_TEST( testBatchInvoke );
+CPPUNIT_TEST( testLostConnectionDuringBatch );
+CPPUNIT_TEST( testBatchRepeatedProcedure );
+CPPUNIT_TEST( testBatchUninitializedParams );
+CPPUNIT_TEST_EXCEPTION( testNullBatchCallback, voltdb::NullPointerException );
+CPPUNIT_TEST( testBulkLoader );
+CPPUNIT_TEST( testBulkLoaderFailure );
+CPPUNIT_TEST( testBulkLoaderFlushInterval );
+CPPUNIT_TEST_EXCEPTION( testBulkLoaderInvalidPartitionColumn, voltdb::InvalidColumnException );
+CPPUNIT_TEST( testInvokeAllPartitions );
+CPPUNIT_TEST_EXCEPTION( testInvokeAllPartitionsMultiPartition, voltdb::AllPartitionsInvocationException );
+CPPUNIT_TEST( testInvokeGroupedByPartition );
+CPPUNIT_TEST_EXCEPTION( testInvokeGroupedByPartitionKeyType, voltdb::GroupedInvocationException );
+CPPUNIT_TEST( testResponseStream );
+CPPUNIT_TEST( testStreamingCallback );
+CPPUNIT_TEST( testStreamingCallbackThrows );
+CPPUNIT_TEST( testStreamingMalformedResponse );
+CPPUNIT_TEST( testSegmentedResponse );
+CPPUNIT_TEST( testSegmentedReply );
 CPPUNIT_TEST_EXCEPTION( testLostConnection, voltdb::NoConnectionsException );
 CPPUNIT_TEST_SUITE_END();
 
@@ -574,6 +604,706 @@ public:
         CPPUNIT_ASSERT(cb->m_connectionLost == 0);
     }
 
+    class CollectingBatchCallback : public voltdb::BatchCallback {
+    public:
+        CollectingBatchCallback() : m_calls(0) {}
+
+        bool callback(const std::vector<voltdb::InvocationResponse> &responses) throw (voltdb::Exception) {
+            m_calls++;
+            m_responses = responses;
+            return false;
+        }
+        int32_t m_calls;
+        std::vector<voltdb::InvocationResponse> m_responses;
+    };
+
+    void testBatchInvoke() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        boost::ptr_vector<Procedure> procs;
+        std::vector<Procedure*> batch;
+        for (int ii = 0; ii < 5; ii++) {
+            procs.push_back(new Procedure("Insert", signature));
+            procs.back().params()->addString("Hello");
+            batch.push_back(&procs.back());
+        }
+
+        CollectingBatchCallback *cb = new CollectingBatchCallback();
+        boost::shared_ptr<BatchCallback> callback(cb);
+        m_client->invokeBatch(batch, callback);
+        CPPUNIT_ASSERT(cb->m_calls == 0);
+        m_client->drain();
+
+        CPPUNIT_ASSERT(cb->m_calls == 1);
+        CPPUNIT_ASSERT(cb->m_responses.size() == 5);
+        for (size_t ii = 0; ii < cb->m_responses.size(); ii++) {
+            CPPUNIT_ASSERT(cb->m_responses[ii].success());
+            if (ii > 0) {
+                // submission order is preserved
+                CPPUNIT_ASSERT(cb->m_responses[ii].clientData() == cb->m_responses[ii - 1].clientData() + 1);
+            }
+        }
+    }
+
+    void testLostConnectionDuringBatch() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+
+        std::vector<Parameter> signature;
+        boost::ptr_vector<Procedure> procs;
+        std::vector<Procedure*> batch;
+        for (int ii = 0; ii < 5; ii++) {
+            procs.push_back(new Procedure("Insert", signature));
+            procs.back().params();
+            batch.push_back(&procs.back());
+        }
+
+        CollectingBatchCallback *cb = new CollectingBatchCallback();
+        boost::shared_ptr<BatchCallback> callback(cb);
+        m_client->invokeBatch(batch, callback);
+        m_voltdb->hangupOnRequestCount(3);
+        m_client->drain();
+
+        CPPUNIT_ASSERT(cb->m_calls == 1);
+        CPPUNIT_ASSERT(cb->m_responses.size() == 5);
+        int32_t success = 0, connectionLost = 0;
+        for (size_t ii = 0; ii < cb->m_responses.size(); ii++) {
+            if (cb->m_responses[ii].success()) {
+                success++;
+            } else {
+                CPPUNIT_ASSERT(cb->m_responses[ii].statusCode() == voltdb::STATUS_CODE_CONNECTION_LOST);
+                connectionLost++;
+            }
+        }
+        CPPUNIT_ASSERT(success == 2);
+        CPPUNIT_ASSERT(connectionLost == 3);
+    }
+
+    void testBatchRepeatedProcedure() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        Procedure proc("Insert", signature);
+        proc.params()->addString("Hello");
+        std::vector<Procedure*> batch(3, &proc);
+
+        CollectingBatchCallback *cb = new CollectingBatchCallback();
+        boost::shared_ptr<BatchCallback> callback(cb);
+        m_client->invokeBatch(batch, callback);
+        m_client->drain();
+
+        CPPUNIT_ASSERT(cb->m_calls == 1);
+        CPPUNIT_ASSERT(cb->m_responses.size() == 3);
+        for (size_t ii = 0; ii < cb->m_responses.size(); ii++) {
+            CPPUNIT_ASSERT(cb->m_responses[ii].success());
+            if (ii > 0) {
+                CPPUNIT_ASSERT(cb->m_responses[ii].clientData() == cb->m_responses[ii - 1].clientData() + 1);
+            }
+        }
+    }
+
+    void testBatchUninitializedParams() {
+        m_client->createConnection("localhost");
+
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        Procedure initialized("Insert", signature);
+        initialized.params()->addString("Hello");
+        Procedure uninitialized("Insert", signature);
+        std::vector<Procedure*> batch;
+        batch.push_back(&initialized);
+        batch.push_back(&uninitialized);
+
+        CollectingBatchCallback *cb = new CollectingBatchCallback();
+        boost::shared_ptr<BatchCallback> callback(cb);
+        try {
+            m_client->invokeBatch(batch, callback);
+            CPPUNIT_ASSERT_MESSAGE("uninitialized parameters expected to fail the batch", false);
+        } catch (const voltdb::UninitializedParamsException &e) {
+        }
+        // nothing was registered and the staged request was released
+        CPPUNIT_ASSERT_EQUAL(0, m_client->outstandingRequests());
+        CPPUNIT_ASSERT_EQUAL(0, cb->m_calls);
+        std::vector<Procedure*> released(1, &initialized);
+        try {
+            m_client->invokeBatch(released, callback);
+            CPPUNIT_ASSERT_MESSAGE("released parameters expected to be reset", false);
+        } catch (const voltdb::UninitializedParamsException &e) {
+        }
+    }
+
+    void testNullBatchCallback() {
+        m_client->createConnection("localhost");
+        std::vector<Procedure*> batch;
+        m_client->invokeBatch(batch, boost::shared_ptr<BatchCallback>());
+    }
+
+    class CountingLoaderCallback : public voltdb::BulkLoaderCallback {
+    public:
+        CountingLoaderCallback() : m_successes(0), m_loadedRows(0), m_failures(0), m_failedRows(0) {}
+
+        void failure(const Table &rows, const InvocationResponse &response) throw (voltdb::Exception) {
+            CPPUNIT_ASSERT(response.failure());
+            m_failures++;
+            m_failedRows += rows.rowCount();
+        }
+
+        void success(int32_t rowCount) throw (voltdb::Exception) {
+            m_successes++;
+            m_loadedRows += rowCount;
+        }
+        int32_t m_successes;
+        int32_t m_loadedRows;
+        int32_t m_failures;
+        int32_t m_failedRows;
+    };
+
+    std::vector<Column> loaderSchema() {
+        std::vector<Column> schema;
+        schema.push_back(Column("NAME", WIRE_TYPE_STRING));
+        schema.push_back(Column("ID", WIRE_TYPE_BIGINT));
+        return schema;
+    }
+
+    void testBulkLoader() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+
+        CountingLoaderCallback *cb = new CountingLoaderCallback();
+        const std::vector<Column> schema = loaderSchema();
+        BulkLoader loader(*m_client, "LOADED", schema, 1, boost::shared_ptr<BulkLoaderCallback>(cb), 3);
+        RowBuilder row(schema);
+        for (int64_t ii = 0; ii < 7; ii++) {
+            row.addString("Hello").addInt64(ii);
+            loader.insertRow(row);
+        }
+        // full batches are flushed as rows are inserted
+        CPPUNIT_ASSERT(loader.pendingRows() == 1);
+        loader.flush();
+        CPPUNIT_ASSERT(loader.pendingRows() == 0);
+        m_client->drain();
+
+        CPPUNIT_ASSERT(cb->m_successes == 3);
+        CPPUNIT_ASSERT(cb->m_loadedRows == 7);
+        CPPUNIT_ASSERT(cb->m_failures == 0);
+    }
+
+    void testBulkLoaderFailure() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+        m_voltdb->forceErrorAfter(1);
+
+        CountingLoaderCallback *cb = new CountingLoaderCallback();
+        const std::vector<Column> schema = loaderSchema();
+        BulkLoader loader(*m_client, "LOADED", schema, BulkLoader::REPLICATED, boost::shared_ptr<BulkLoaderCallback>(cb), 2);
+        RowBuilder row(schema);
+        for (int64_t ii = 0; ii < 5; ii++) {
+            row.addString("Hello").addInt64(ii);
+            loader.insertRow(row);
+        }
+        loader.flush();
+        m_client->drain();
+
+        CPPUNIT_ASSERT(cb->m_successes == 2);
+        CPPUNIT_ASSERT(cb->m_loadedRows == 3);
+        CPPUNIT_ASSERT(cb->m_failures == 1);
+        CPPUNIT_ASSERT(cb->m_failedRows == 2);
+    }
+
+    void testBulkLoaderFlushInterval() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+
+        CountingLoaderCallback *cb = new CountingLoaderCallback();
+        const std::vector<Column> schema = loaderSchema();
+        BulkLoader loader(*m_client, "LOADED", schema, 0, boost::shared_ptr<BulkLoaderCallback>(cb), 100, 10);
+        RowBuilder row(schema);
+        row.addString("Hello").addInt64(1);
+        loader.insertRow(row);
+        CPPUNIT_ASSERT(loader.pendingRows() == 1);
+
+        m_client->runForMaxTime(200000);
+        CPPUNIT_ASSERT(loader.pendingRows() == 0);
+        CPPUNIT_ASSERT(cb->m_successes == 1);
+        CPPUNIT_ASSERT(cb->m_loadedRows == 1);
+    }
+
+    void testBulkLoaderInvalidPartitionColumn() {
+        m_client->createConnection("localhost");
+        std::vector<Column> schema = loaderSchema();
+        schema.push_back(Column("RATIO", WIRE_TYPE_FLOAT));
+        BulkLoader loader(*m_client, "LOADED", schema, 2, boost::shared_ptr<BulkLoaderCallback>(new CountingLoaderCallback()));
+    }
+
+    /*
+     * Four partitions owning a quarter of the ring each, a single partition procedure Scan
+     * partitioned on its second parameter and a multi partition procedure Summary
+     */
+    void loadRouting() {
+        std::vector<Column> partitionColumns;
+        partitionColumns.push_back(Column("Partition", WIRE_TYPE_INTEGER));
+        partitionColumns.push_back(Column("Sites", WIRE_TYPE_STRING));
+        partitionColumns.push_back(Column("Leader", WIRE_TYPE_STRING));
+        Table partitions(partitionColumns);
+        RowBuilder partition(partitionColumns);
+        for (int32_t ii = 0; ii < 4; ii++) {
+            partition.addInt32(ii).addString("0:0").addString("0:0");
+            partitions.addRow(partition);
+        }
+        int32_t tokens[9];
+        tokens[0] = htonl(4);
+        for (int32_t ii = 0; ii < 4; ii++) {
+            tokens[1 + ii * 2] = htonl(static_cast<uint32_t>(INT32_MIN + ii * 1073741824));
+            tokens[2 + ii * 2] = htonl(ii);
+        }
+        std::vector<Column> hashColumns;
+        hashColumns.push_back(Column("HashType", WIRE_TYPE_STRING));
+        hashColumns.push_back(Column("HashConfig", WIRE_TYPE_VARBINARY));
+        Table hashConfig(hashColumns);
+        RowBuilder hash(hashColumns);
+        hash.addString("ELASTIC").addVarbinary(sizeof(tokens), reinterpret_cast<uint8_t*>(tokens));
+        hashConfig.addRow(hash);
+        std::vector<Table> topology;
+        topology.push_back(partitions);
+        topology.push_back(hashConfig);
+        m_voltdb->distributer().updateAffinityTopology(topology);
+
+        std::vector<Column> procedureColumns(7, Column("C", WIRE_TYPE_STRING));
+        Table procedures(procedureColumns);
+        RowBuilder procedure(procedureColumns);
+        procedure.addString("").addString("").addString("Scan").addString("").addString("").addString("")
+                 .addString("{\"partitionParameter\":1,\"readOnly\":true,\"partitionParameterType\":5,\"singlePartition\":true}");
+        procedures.addRow(procedure);
+        procedure.addString("").addString("").addString("Lookup").addString("").addString("").addString("")
+                 .addString("{\"partitionParameter\":0,\"readOnly\":true,\"partitionParameterType\":6,\"singlePartition\":true}");
+        procedures.addRow(procedure);
+        procedure.addString("").addString("").addString("Summary").addString("").addString("").addString("")
+                 .addString("{\"readOnly\":true,\"singlePartition\":false}");
+        procedures.addRow(procedure);
+        m_voltdb->distributer().updateProcedurePartitioning(std::vector<Table>(1, procedures));
+    }
+
+    class CollectingPartitionsCallback : public AllPartitionsCallback {
+    public:
+        CollectingPartitionsCallback() : m_partitionResponses(0), m_completions(0) {}
+
+        bool partitionResponse(int32_t partitionId, const InvocationResponse &response) throw (voltdb::Exception) {
+            m_partitionResponses++;
+            return false;
+        }
+
+        bool callback(const std::map<int32_t, InvocationResponse> &responses) throw (voltdb::Exception) {
+            m_completions++;
+            m_responses = responses;
+            return false;
+        }
+        int32_t m_partitionResponses;
+        int32_t m_completions;
+        std::map<int32_t, InvocationResponse> m_responses;
+    };
+
+    void testInvokeAllPartitions() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+        loadRouting();
+
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        signature.push_back(Parameter(WIRE_TYPE_INTEGER));
+        Procedure proc("Scan", signature);
+        proc.params()->addString("filter").addInt32(0);
+        boost::shared_ptr<CollectingPartitionsCallback> cb(new CollectingPartitionsCallback());
+        m_client->invokeAllPartitions(proc, cb);
+        m_client->drain();
+
+        CPPUNIT_ASSERT_EQUAL(4, cb->m_partitionResponses);
+        CPPUNIT_ASSERT_EQUAL(1, cb->m_completions);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), cb->m_responses.size());
+        for (int32_t ii = 0; ii < 4; ii++) {
+            CPPUNIT_ASSERT(cb->m_responses[ii].success());
+        }
+
+        // every request carries a key of a different partition and the other parameters unchanged
+        std::set<int32_t> partitions;
+        const std::vector<std::string> &requests = m_voltdb->requests();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), requests.size());
+        for (size_t ii = 0; ii < requests.size(); ii++) {
+            std::string message = std::string(4, '\0') + requests[ii];
+            ByteBuffer request(&message[0], static_cast<int32_t>(message.size()));
+            bool wasNull;
+            CPPUNIT_ASSERT(request.getString(Distributer::getParameterOffset(request, 0) + 1, wasNull) == "filter");
+            const int offset = Distributer::getParameterOffset(request, 1);
+            CPPUNIT_ASSERT_EQUAL(static_cast<int8_t>(WIRE_TYPE_INTEGER), request.getInt8(offset));
+            partitions.insert(m_voltdb->distributer().hashinate(request.getInt32(offset + 1)));
+        }
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), partitions.size());
+    }
+
+    class CollectingGroupedCallback : public GroupedByPartitionCallback {
+    public:
+        CollectingGroupedCallback() : m_partitionResponses(0), m_completions(0) {}
+
+        bool partitionResponse(int32_t partitionId, const InvocationResponse &response) throw (voltdb::Exception) {
+            m_partitionResponses++;
+            return false;
+        }
+
+        bool callback(const std::map<int32_t, InvocationResponse> &responses,
+                      const std::vector<KeyLocation> &keys) throw (voltdb::Exception) {
+            m_completions++;
+            m_responses = responses;
+            m_keys = keys;
+            return false;
+        }
+        int32_t m_partitionResponses;
+        int32_t m_completions;
+        std::map<int32_t, InvocationResponse> m_responses;
+        std::vector<KeyLocation> m_keys;
+    };
+
+    void testInvokeGroupedByPartition() {
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        m_client->createConnection("localhost");
+        loadRouting();
+
+        std::vector<int64_t> keys;
+        for (int64_t key = 0; key < 100; key++) {
+            keys.push_back(key * 7919);
+        }
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT));
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT, true));
+        Procedure proc("Lookup", signature);
+        boost::shared_ptr<CollectingGroupedCallback> cb(new CollectingGroupedCallback());
+        m_client->invokeGroupedByPartition(proc, keys, cb);
+        m_client->drain();
+
+        const std::vector<std::string> &requests = m_voltdb->requests();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), requests.size());
+        CPPUNIT_ASSERT_EQUAL(4, cb->m_partitionResponses);
+        CPPUNIT_ASSERT_EQUAL(1, cb->m_completions);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), cb->m_responses.size());
+        CPPUNIT_ASSERT_EQUAL(keys.size(), cb->m_keys.size());
+
+        // each partition's request carries its keys in order, the key of the partition first
+        std::map<int32_t, std::vector<int64_t> > sent;
+        for (size_t ii = 0; ii < requests.size(); ii++) {
+            std::string message = std::string(4, '\0') + requests[ii];
+            ByteBuffer request(&message[0], static_cast<int32_t>(message.size()));
+            const int32_t partition = m_voltdb->distributer().hashinate(
+                    request.getInt64(Distributer::getParameterOffset(request, 0) + 1));
+            const int offset = Distributer::getParameterOffset(request, 1);
+            CPPUNIT_ASSERT_EQUAL(static_cast<int8_t>(WIRE_TYPE_ARRAY), request.getInt8(offset));
+            CPPUNIT_ASSERT_EQUAL(static_cast<int8_t>(WIRE_TYPE_BIGINT), request.getInt8(offset + 1));
+            const int16_t count = request.getInt16(offset + 2);
+            for (int16_t jj = 0; jj < count; jj++) {
+                sent[partition].push_back(request.getInt64(offset + 4 + jj * 8));
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), sent.size());
+        for (size_t ii = 0; ii < keys.size(); ii++) {
+            const GroupedByPartitionCallback::KeyLocation &location = cb->m_keys[ii];
+            CPPUNIT_ASSERT_EQUAL(m_voltdb->distributer().hashinate(keys[ii]), location.m_partitionId);
+            CPPUNIT_ASSERT_EQUAL(keys[ii], sent[location.m_partitionId].at(static_cast<size_t>(location.m_position)));
+            CPPUNIT_ASSERT(cb->m_responses[location.m_partitionId].success());
+        }
+    }
+
+    void testInvokeGroupedByPartitionKeyType() {
+        m_client->createConnection("localhost");
+        loadRouting();
+        Procedure proc("Lookup");
+        m_client->invokeGroupedByPartition(proc, std::vector<std::string>(1, "key"),
+                                           boost::shared_ptr<GroupedByPartitionCallback>(new CollectingGroupedCallback()));
+    }
+
+    void testInvokeAllPartitionsMultiPartition() {
+        m_client->createConnection("localhost");
+        loadRouting();
+        Procedure proc("Summary");
+        proc.params();
+        m_client->invokeAllPartitions(proc, boost::shared_ptr<AllPartitionsCallback>(new CollectingPartitionsCallback()));
+    }
+
+    class CollectingStreamingCallback : public StreamingProcedureCallback {
+    public:
+        CollectingStreamingCallback(int64_t throwAtRow = -1) : m_throwAtRow(throwAtRow), m_nameLength(0), m_responses(0) {}
+
+        bool table(size_t index, const Table &schema, int32_t rowCount) {
+            CPPUNIT_ASSERT_EQUAL(m_rowCounts.size(), index);
+            CPPUNIT_ASSERT_EQUAL(2, schema.columnCount());
+            CPPUNIT_ASSERT_EQUAL(0, schema.rowCount());
+            m_rowCounts.push_back(rowCount);
+            return false;
+        }
+
+        bool row(size_t index, Row &row) {
+            CPPUNIT_ASSERT_EQUAL(m_rowCounts.size() - 1, index);
+            if (row.getInt64("ID") == m_throwAtRow) {
+                throw std::exception();
+            }
+            m_ids.push_back(row.getInt64(0));
+            m_nameLength = row.getStringRef("NAME").size();
+            return false;
+        }
+
+        bool callback(InvocationResponse response) throw (voltdb::Exception) {
+            m_responses++;
+            m_response = response;
+            return true;
+        }
+
+        const int64_t m_throwAtRow;
+        std::vector<int32_t> m_rowCounts;
+        std::vector<int64_t> m_ids;
+        size_t m_nameLength;
+        int32_t m_responses;
+        InvocationResponse m_response;
+    };
+
+    // a table of rows numbered from the first id, with long names
+    static Table namedRows(int64_t firstId, int32_t rowCount) {
+        std::vector<Column> columns;
+        columns.push_back(Column("ID", WIRE_TYPE_BIGINT));
+        columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+        Table table(columns);
+        RowBuilder row(columns);
+        for (int32_t ii = 0; ii < rowCount; ii++) {
+            row.addInt64(firstId + ii).addString(std::string(300, 'n'));
+            table.addRow(row);
+        }
+        return table;
+    }
+
+    // a successful response with its length prefix, a status string and an app status string
+    static std::string serializedResponse(std::vector<Table> &tables) {
+        int32_t length = 1 + 8 + 1 + 1 + (4 + 2) + 1 + (4 + 3) + 4 + 2;
+        for (size_t ii = 0; ii < tables.size(); ii++) {
+            length += tables[ii].getSerializedSize();
+        }
+        std::vector<char> message(static_cast<size_t>(4 + length));
+        ByteBuffer buffer(&message[0], 4 + length);
+        buffer.putInt32(length).putInt8(0).putInt64(42).putInt8(static_cast<int8_t>((1 << 5) | (1 << 7)));
+        buffer.putInt8(STATUS_CODE_SUCCESS).putString("ok").putInt8(7).putString("app").putInt32(1);
+        buffer.putInt16(static_cast<int16_t>(tables.size()));
+        for (size_t ii = 0; ii < tables.size(); ii++) {
+            tables[ii].serializeTo(buffer);
+        }
+        CPPUNIT_ASSERT(buffer.remaining() == 0);
+        return std::string(&message[0], message.size());
+    }
+
+    void testResponseStream() {
+        std::vector<Table> tables;
+        tables.push_back(namedRows(0, 2000));
+        tables.push_back(namedRows(0, 0));
+        tables.push_back(namedRows(2000, 3));
+        const std::string message = serializedResponse(tables);
+
+        // all at once, and a byte at a time
+        const size_t pieceSizes[] = { message.size(), 1 };
+        for (size_t pp = 0; pp < sizeof(pieceSizes) / sizeof(pieceSizes[0]); pp++) {
+            boost::shared_ptr<CollectingStreamingCallback> callback(new CollectingStreamingCallback());
+            ResponseStream stream(static_cast<int32_t>(message.size() - 4), 42, callback, boost::shared_ptr<SchemaCache>());
+            struct evbuffer *input = evbuffer_new();
+            size_t needed = 1;
+            size_t reads = 0;
+            for (size_t offset = 4; offset < message.size(); offset += pieceSizes[pp]) {
+                evbuffer_add(input, message.data() + offset, std::min(pieceSizes[pp], message.size() - offset));
+                if (evbuffer_get_length(input) >= needed) {
+                    bool breakEventLoop = false;
+                    needed = stream.read(input, breakEventLoop);
+                    CPPUNIT_ASSERT(!breakEventLoop);
+                    reads++;
+                }
+            }
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), needed);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), evbuffer_get_length(input));
+            evbuffer_free(input);
+            // the rows are delivered as they complete, not when the message did
+            CPPUNIT_ASSERT(pieceSizes[pp] > 1 || reads > 2003);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), callback->m_rowCounts.size());
+            CPPUNIT_ASSERT_EQUAL(2000, callback->m_rowCounts[0]);
+            CPPUNIT_ASSERT_EQUAL(0, callback->m_rowCounts[1]);
+            CPPUNIT_ASSERT_EQUAL(3, callback->m_rowCounts[2]);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2003), callback->m_ids.size());
+            for (size_t ii = 0; ii < callback->m_ids.size(); ii++) {
+                CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(ii), callback->m_ids[ii]);
+            }
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(300), callback->m_nameLength);
+            const InvocationResponse &response = stream.response();
+            CPPUNIT_ASSERT(response.success());
+            CPPUNIT_ASSERT(response.statusString() == "ok");
+            CPPUNIT_ASSERT(response.appStatusString() == "app");
+            CPPUNIT_ASSERT_EQUAL(static_cast<int8_t>(7), response.appStatusCode());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), response.resultCount());
+        }
+    }
+
+    void testStreamingCallback() {
+        m_client->createConnection("localhost");
+        std::vector<Table> tables;
+        // several megabytes, received in many reads
+        tables.push_back(namedRows(0, 20000));
+        m_voltdb->responseForNextRequest(serializedResponse(tables));
+        Procedure proc("Scan");
+        proc.params();
+        boost::shared_ptr<CollectingStreamingCallback> callback(new CollectingStreamingCallback());
+        m_client->invoke(proc, callback);
+        m_client->run();
+        CPPUNIT_ASSERT_EQUAL(1, callback->m_responses);
+        CPPUNIT_ASSERT(callback->m_response.success());
+        CPPUNIT_ASSERT(callback->m_response.statusString() == "ok");
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), callback->m_rowCounts.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(20000), callback->m_ids.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(19999), callback->m_ids.back());
+
+        // the connection reads the next response whole again
+        m_voltdb->responseForNextRequest("");
+        m_voltdb->filenameForNextResponse("invocation_response_success.msg");
+        InvocationResponse response = m_client->invoke(proc);
+        CPPUNIT_ASSERT(response.success());
+    }
+
+    void testStreamingCallbackThrows() {
+        class Listener : public DelegatingListener {
+        public:
+            Listener() : m_exceptions(0) {}
+            virtual bool uncaughtException(std::exception exception, boost::shared_ptr<voltdb::ProcedureCallback> callback,
+                                           InvocationResponse response) {
+                m_exceptions++;
+                return true;
+            }
+            int32_t m_exceptions;
+        } listener;
+        (*m_dlistener)->m_listener = &listener;
+
+        m_client->createConnection("localhost");
+        std::vector<Table> tables;
+        tables.push_back(namedRows(0, 5000));
+        m_voltdb->responseForNextRequest(serializedResponse(tables));
+        Procedure proc("Scan");
+        proc.params();
+        boost::shared_ptr<CollectingStreamingCallback> callback(new CollectingStreamingCallback(100));
+        m_client->invoke(proc, callback);
+        m_client->run();
+        // the rest of the response is skipped without the callback being invoked
+        CPPUNIT_ASSERT_EQUAL(1, listener.m_exceptions);
+        CPPUNIT_ASSERT_EQUAL(0, callback->m_responses);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(100), callback->m_ids.size());
+        CPPUNIT_ASSERT(m_client->drain());
+    }
+
+    void testStreamingMalformedResponse() {
+        class Listener : public DelegatingListener {
+        public:
+            Listener() : m_exceptions(0) {}
+            virtual bool uncaughtException(std::exception exception, boost::shared_ptr<voltdb::ProcedureCallback> callback,
+                                           InvocationResponse response) {
+                m_exceptions++;
+                return true;
+            }
+            int32_t m_exceptions;
+        } listener;
+        (*m_dlistener)->m_listener = &listener;
+
+        m_client->createConnection("localhost");
+        std::vector<Table> tables;
+        tables.push_back(namedRows(0, 50));
+        std::string message = serializedResponse(tables);
+        // the first row claims to be longer than its table
+        const size_t tableStart = 4 + 31;
+        ByteBuffer bytes(&message[0], static_cast<int32_t>(message.size()));
+        const size_t firstRow = tableStart + 8 + static_cast<size_t>(bytes.getInt32(static_cast<int32_t>(tableStart) + 4)) + 4;
+        bytes.putInt32(static_cast<int32_t>(firstRow), INT32_MAX);
+        m_voltdb->responseForNextRequest(message);
+        Procedure proc("Scan");
+        proc.params();
+        boost::shared_ptr<CollectingStreamingCallback> callback(new CollectingStreamingCallback());
+        m_client->invoke(proc, callback);
+        m_client->run();
+        // the request completes with a failure rather than through the listener
+        CPPUNIT_ASSERT_EQUAL(0, listener.m_exceptions);
+        CPPUNIT_ASSERT_EQUAL(1, callback->m_responses);
+        CPPUNIT_ASSERT(callback->m_response.failure());
+        CPPUNIT_ASSERT(callback->m_ids.empty());
+        CPPUNIT_ASSERT(m_client->drain());
+    }
+
+    void testSegmentedResponse() {
+        std::vector<Table> tables;
+        tables.push_back(namedRows(0, 2000));
+        tables.push_back(namedRows(0, 0));
+        tables.push_back(namedRows(2000, 3));
+        const std::string message = serializedResponse(tables);
+
+        // in chunks larger than a row, and smaller than the status strings
+        const size_t chunkSizes[] = { 997, 7 };
+        for (size_t cc = 0; cc < sizeof(chunkSizes) / sizeof(chunkSizes[0]); cc++) {
+            struct evbuffer *input = evbuffer_new();
+            for (size_t offset = 4; offset < message.size(); offset += chunkSizes[cc]) {
+                evbuffer_add_reference(input, message.data() + offset, std::min(chunkSizes[cc], message.size() - offset),
+                                       NULL, NULL);
+            }
+            boost::shared_ptr<SegmentedBuffer> segments(
+                    new SegmentedBuffer(input, static_cast<int32_t>(message.size() - 4)));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), evbuffer_get_length(input));
+            evbuffer_free(input);
+
+            InvocationResponse response(segments);
+            CPPUNIT_ASSERT(response.success());
+            CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(42), response.clientData());
+            CPPUNIT_ASSERT(response.statusString() == "ok");
+            CPPUNIT_ASSERT(response.appStatusString() == "app");
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), response.resultCount());
+            Table last = response.result(2);
+            CPPUNIT_ASSERT_EQUAL(3, last.rowCount());
+            CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(2000), last.iterator().next().getInt64(0));
+
+            std::vector<Table> results = response.results();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), results.size());
+            CPPUNIT_ASSERT_EQUAL(0, results[1].rowCount());
+            int64_t id = 0;
+            for (size_t ii = 0; ii < results.size(); ii++) {
+                TableIterator iterator = results[ii].iterator();
+                while (iterator.hasNext()) {
+                    Row row = iterator.next();
+                    CPPUNIT_ASSERT_EQUAL(id++, row.getInt64(0));
+                    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(300), row.getString(1).size());
+                }
+            }
+            CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(2003), id);
+        }
+    }
+
+    void testSegmentedReply() {
+        m_client->createConnection("localhost");
+        std::vector<Table> tables;
+        // over the length from which responses are kept in the chunks they arrived in
+        tables.push_back(namedRows(0, 5000));
+        m_voltdb->responseForNextRequest(serializedResponse(tables));
+        Procedure proc("Scan");
+        proc.params();
+        InvocationResponse response = m_client->invoke(proc);
+        CPPUNIT_ASSERT(response.success());
+        CPPUNIT_ASSERT(response.statusString() == "ok");
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), response.resultCount());
+        Table table = response.results()[0];
+        CPPUNIT_ASSERT_EQUAL(5000, table.rowCount());
+        TableIterator iterator = table.iterator();
+        int64_t id = 0;
+        while (iterator.hasNext()) {
+            CPPUNIT_ASSERT_EQUAL(id++, iterator.next().getInt64(0));
+        }
+        CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(5000), id);
+    }
+
 private:
     Client *m_client;
     boost::scoped_ptr<MockVoltDB> m_voltdb;
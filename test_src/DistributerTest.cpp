@@ -0,0 +1,428 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+#include <arpa/inet.h>
+#include <sstream>
+#include "Distributer.h"
+#include "Procedure.hpp"
+#include "RowBuilder.h"
+#include "Table.h"
+#include "TypedProcedure.hpp"
+
+namespace voltdb {
+
+class DistributerTest : public CppUnit::TestFixture {
+CPPUNIT_TEST_SUITE( DistributerTest );
+CPPUNIT_TEST( testIntegerKeyAfterArraysAndTables );
+CPPUNIT_TEST( testVarbinaryKey );
+CPPUNIT_TEST( testSkipAllParameterTypes );
+CPPUNIT_TEST( testNullKeys );
+CPPUNIT_TEST( testStringForIntegerPartitionParameter );
+CPPUNIT_TEST( testUnroutableParameters );
+CPPUNIT_TEST( testHashinateBatch );
+CPPUNIT_TEST( testCapturedPartitionParameter );
+CPPUNIT_TEST( testSnapshotsOutliveUpdates );
+CPPUNIT_TEST( testReplicaHostIds );
+CPPUNIT_TEST( testPartitionKeys );
+CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {
+        std::vector<Column> partitionColumns;
+        partitionColumns.push_back(Column("Partition", WIRE_TYPE_INTEGER));
+        partitionColumns.push_back(Column("Sites", WIRE_TYPE_STRING));
+        partitionColumns.push_back(Column("Leader", WIRE_TYPE_STRING));
+        Table partitions(partitionColumns);
+        RowBuilder partition(partitionColumns);
+        for (int32_t ii = 0; ii < 4; ii++) {
+            partition.addInt32(ii).addString("0:0").addString("0:0");
+            partitions.addRow(partition);
+        }
+
+        std::vector<Table> topology;
+        topology.push_back(partitions);
+        topology.push_back(hashConfig());
+        m_distributer.updateAffinityTopology(topology);
+    }
+
+    // four partitions owning a quarter of the ring each
+    Table hashConfig() {
+        int32_t tokens[9];
+        tokens[0] = htonl(4);
+        for (int32_t ii = 0; ii < 4; ii++) {
+            tokens[1 + ii * 2] = htonl(static_cast<uint32_t>(INT32_MIN + ii * 1073741824));
+            tokens[2 + ii * 2] = htonl(ii);
+        }
+        std::vector<Column> hashColumns;
+        hashColumns.push_back(Column("HashType", WIRE_TYPE_STRING));
+        hashColumns.push_back(Column("HashConfig", WIRE_TYPE_VARBINARY));
+        Table config(hashColumns);
+        RowBuilder hash(hashColumns);
+        hash.addString("ELASTIC").addVarbinary(sizeof(tokens), reinterpret_cast<uint8_t*>(tokens));
+        config.addRow(hash);
+        return config;
+    }
+
+    void serialize(Procedure &proc) {
+        const int32_t size = proc.getSerializedSize();
+        m_request = SharedByteBuffer(new char[size], size);
+        proc.serializeTo(&m_request, 42);
+    }
+
+    int hashedPartition(int parameterId, int parameterType) {
+        return m_distributer.getHashedPartitionForParameter(m_request, parameterId, parameterType);
+    }
+
+    void testIntegerKeyAfterArraysAndTables() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING, true));
+        signature.push_back(Parameter(WIRE_TYPE_VOLTTABLE));
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT));
+        Procedure proc("Insert", signature);
+
+        std::vector<std::string> names;
+        names.push_back("first");
+        names.push_back("second");
+        std::vector<Column> columns;
+        columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+        Table table(columns);
+        RowBuilder row(columns);
+        row.addString("Hello");
+        table.addRow(row);
+
+        for (int64_t key = -3; key < 100; key += 7) {
+            proc.params()->addString(names).addTable(table).addInt64(key);
+            serialize(proc);
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(key), hashedPartition(2, WIRE_TYPE_BIGINT));
+        }
+    }
+
+    void testVarbinaryKey() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_INTEGER));
+        signature.push_back(Parameter(WIRE_TYPE_VARBINARY));
+        Procedure proc("Select", signature);
+
+        std::vector<int> partitions(4, 0);
+        for (uint8_t ii = 0; ii < 64; ii++) {
+            uint8_t uuid[16];
+            for (size_t jj = 0; jj < sizeof(uuid); jj++) {
+                uuid[jj] = static_cast<uint8_t>(ii * 31 + jj);
+            }
+            proc.params()->addInt32(ii).addBytes(sizeof(uuid), uuid);
+            serialize(proc);
+            const int partition = hashedPartition(1, WIRE_TYPE_VARBINARY);
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(reinterpret_cast<const char*>(uuid), sizeof(uuid)), partition);
+            partitions[static_cast<size_t>(partition)]++;
+        }
+        // keys are spread across the partitions
+        for (size_t ii = 0; ii < partitions.size(); ii++) {
+            CPPUNIT_ASSERT(partitions[ii] > 0);
+        }
+    }
+
+    void testSkipAllParameterTypes() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_TINYINT, true));
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT, true));
+        signature.push_back(Parameter(WIRE_TYPE_DECIMAL));
+        signature.push_back(Parameter(WIRE_TYPE_GEOGRAPHY_POINT));
+        signature.push_back(Parameter(WIRE_TYPE_GEOGRAPHY));
+        signature.push_back(Parameter(WIRE_TYPE_VARBINARY, true));
+        signature.push_back(Parameter(WIRE_TYPE_TIMESTAMP));
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        Procedure proc("Insert", signature);
+
+        std::vector<int8_t> bytes(3, 7);
+        std::vector<int64_t> longs(5, 11);
+        Geography polygon;
+        polygon.addEmptyRing() << GeographyPoint(0, 0) << GeographyPoint(1, 0) << GeographyPoint(0, 1) << GeographyPoint(0, 0);
+        std::vector<buffer_t> buffers;
+        buffers.push_back(buffer_t("abc", 3));
+        buffers.push_back(buffer_t("de", 2));
+        proc.params()->addInt8(bytes).addInt64(longs).addDecimal(Decimal("1.5"))
+                .addGeographyPoint(GeographyPoint(1, 2)).addGeography(polygon)
+                .addBytes(buffers).addTimestamp(12345).addNull().addString("key");
+        serialize(proc);
+        CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate("key", 3), hashedPartition(8, WIRE_TYPE_STRING));
+    }
+
+    void testNullKeys() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_TINYINT));
+        signature.push_back(Parameter(WIRE_TYPE_INTEGER));
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        signature.push_back(Parameter(WIRE_TYPE_VARBINARY));
+        signature.push_back(Parameter(WIRE_TYPE_VARBINARY));
+        Procedure proc("Select", signature);
+
+        uint8_t empty = 0;
+        proc.params()->addInt8(INT8_MIN).addInt32(INT32_MIN).addNull().addNull().addBytes(0, &empty);
+        serialize(proc);
+        for (int ii = 0; ii < 5; ii++) {
+            CPPUNIT_ASSERT_EQUAL(0, hashedPartition(ii, signature[static_cast<size_t>(ii)].m_type));
+        }
+    }
+
+    void testStringForIntegerPartitionParameter() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        Procedure proc("Select", signature);
+
+        const int64_t keys[] = { 0, 1, -1, 123456789, INT64_MAX };
+        for (size_t ii = 0; ii < sizeof(keys) / sizeof(keys[0]); ii++) {
+            std::ostringstream key;
+            key << keys[ii];
+            proc.params()->addString(key.str());
+            serialize(proc);
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(keys[ii]), hashedPartition(0, WIRE_TYPE_INTEGER));
+            // hashed as a string for string partitioning parameters
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(key.str().data(), static_cast<int32_t>(key.str().size())),
+                                 hashedPartition(0, WIRE_TYPE_STRING));
+        }
+
+        proc.params()->addString("+42");
+        serialize(proc);
+        CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(42), hashedPartition(0, WIRE_TYPE_BIGINT));
+
+        const char *invalid[] = { "", "-", "12a", " 12", "9223372036854775808" };
+        for (size_t ii = 0; ii < sizeof(invalid) / sizeof(invalid[0]); ii++) {
+            proc.params()->addString(invalid[ii]);
+            serialize(proc);
+            CPPUNIT_ASSERT_EQUAL(-1, hashedPartition(0, WIRE_TYPE_BIGINT));
+        }
+    }
+
+    void testUnroutableParameters() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_FLOAT));
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT, true));
+        Procedure proc("Select", signature);
+
+        std::vector<int64_t> longs(2, 1);
+        proc.params()->addDouble(1.5).addInt64(longs);
+        serialize(proc);
+        CPPUNIT_ASSERT_EQUAL(-1, hashedPartition(0, WIRE_TYPE_FLOAT));
+        CPPUNIT_ASSERT_EQUAL(-1, hashedPartition(1, WIRE_TYPE_BIGINT));
+        CPPUNIT_ASSERT_EQUAL(-1, hashedPartition(2, WIRE_TYPE_BIGINT));
+    }
+
+    void testHashinateBatch() {
+        int64_t values[] = { 1, 2, 3, INT64_MIN, 5 };
+        const char *keys[] = { "a", "bc", "def" };
+        int32_t lengths[] = { 1, 2, 3 };
+        int32_t partitions[5];
+
+        m_distributer.hashinateBatch(values, 5, partitions);
+        for (size_t ii = 0; ii < 5; ii++) {
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(values[ii]), partitions[ii]);
+        }
+        m_distributer.hashinateBatch(keys, lengths, 3, partitions);
+        for (size_t ii = 0; ii < 3; ii++) {
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(keys[ii], lengths[ii]), partitions[ii]);
+        }
+
+        // no hashinator before the topology is loaded
+        Distributer unloaded;
+        unloaded.hashinateBatch(values, 5, partitions);
+        for (size_t ii = 0; ii < 5; ii++) {
+            CPPUNIT_ASSERT_EQUAL(-1, partitions[ii]);
+        }
+    }
+
+    int capturedPartition(Procedure &proc, int parameterId, int parameterType) {
+        const int32_t offset = proc.partitionParameterOffset(parameterId);
+        CPPUNIT_ASSERT(offset >= 0);
+        ByteBuffer request = proc.stagedRequest(42);
+        const int partition = m_distributer.getHashedPartitionForParameterAt(request, offset, parameterType);
+        CPPUNIT_ASSERT_EQUAL(m_distributer.getHashedPartitionForParameter(request, parameterId, parameterType), partition);
+        proc.releaseRequest();
+        return partition;
+    }
+
+    void testCapturedPartitionParameter() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_STRING, true));
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT));
+        Procedure proc("Insert", signature);
+        std::vector<std::string> names(3, "name");
+
+        // not captured until the procedure's partitioning is known
+        proc.params()->addString(names).addString("key").addInt64(7);
+        CPPUNIT_ASSERT_EQUAL(-1, proc.partitionParameterOffset(2));
+        proc.releaseRequest();
+
+        proc.trackPartitionParameter(2);
+        for (int64_t key = 0; key < 20; key++) {
+            proc.params()->addString(names).addString("key").addInt64(key);
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(key), capturedPartition(proc, 2, WIRE_TYPE_BIGINT));
+        }
+        // another parameter than the tracked one isn't located
+        proc.params()->addString(names).addString("key").addInt64(1);
+        CPPUNIT_ASSERT_EQUAL(-1, proc.partitionParameterOffset(1));
+        proc.releaseRequest();
+
+        proc.trackPartitionParameter(1);
+        proc.params()->addString(names).addNull().addInt64(1);
+        CPPUNIT_ASSERT_EQUAL(0, capturedPartition(proc, 1, WIRE_TYPE_STRING));
+        proc.params()->addString(names).addString("key").addInt64(1);
+        CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate("key", 3), capturedPartition(proc, 1, WIRE_TYPE_STRING));
+
+        TypedProcedure<std::string, int32_t, int64_t> typed("Select");
+        typed.trackPartitionParameter(2);
+        for (int64_t key = 0; key < 20; key++) {
+            typed.bind("name", 3, key);
+            CPPUNIT_ASSERT_EQUAL(m_distributer.hashinate(key), capturedPartition(typed, 2, WIRE_TYPE_BIGINT));
+        }
+    }
+
+    void loadProcedures(const std::string &name, const std::string &json) {
+        // @SystemCatalog PROCEDURES, only the name and the remarks are read
+        std::vector<Column> columns;
+        for (int ii = 0; ii < 7; ii++) {
+            columns.push_back(Column("C", WIRE_TYPE_STRING));
+        }
+        Table procedures(columns);
+        RowBuilder row(columns);
+        row.addString("").addString("").addString(name).addString("").addString("").addString("").addString(json);
+        procedures.addRow(row);
+        std::vector<Table> tables(1, procedures);
+        m_distributer.updateProcedurePartitioning(tables);
+    }
+
+    void testSnapshotsOutliveUpdates() {
+        loadProcedures("Insert", "{\"partitionParameter\":1,\"readOnly\":false,\"partitionParameterType\":6,\"singlePartition\":true}");
+        const int64_t version = m_distributer.getProcedureInfoVersion();
+        boost::shared_ptr<const ProcedureInfo> insert = m_distributer.getProcedure("Insert");
+        CPPUNIT_ASSERT(insert.get() != NULL);
+        boost::shared_ptr<const RoutingSnapshot> before = m_distributer.snapshot();
+
+        loadProcedures("Select", "{\"readOnly\":true,\"singlePartition\":false}");
+        CPPUNIT_ASSERT_EQUAL(version + 1, m_distributer.getProcedureInfoVersion());
+        CPPUNIT_ASSERT(m_distributer.getProcedure("Insert").get() == NULL);
+        CPPUNIT_ASSERT(m_distributer.getProcedure("Select")->m_multiPart);
+        // entries handed out earlier and loaded snapshots are unaffected
+        CPPUNIT_ASSERT_EQUAL(1, insert->m_partitionParameter);
+        CPPUNIT_ASSERT(!insert->m_multiPart);
+        CPPUNIT_ASSERT(before->m_procedureInfo->find("Insert") != before->m_procedureInfo->end());
+        // updating the procedures shares the topology
+        CPPUNIT_ASSERT(before->m_hashinator == m_distributer.snapshot()->m_hashinator);
+        CPPUNIT_ASSERT(before->m_partitionToHostId == m_distributer.getPartitionToHostId());
+
+        const int64_t topologyVersion = m_distributer.getTopologyVersion();
+        setUp();
+        CPPUNIT_ASSERT_EQUAL(topologyVersion + 1, m_distributer.getTopologyVersion());
+        CPPUNIT_ASSERT(before->m_hashinator != m_distributer.snapshot()->m_hashinator);
+        CPPUNIT_ASSERT_EQUAL(before->m_hashinator->hashinate(42), m_distributer.hashinate(42));
+        CPPUNIT_ASSERT(m_distributer.getProcedure("Select").get() != NULL);
+
+        // the versions of the distributers of different clients collide, their ids don't
+        Distributer other;
+        CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(0), other.getProcedureInfoVersion());
+        CPPUNIT_ASSERT(other.getId() != m_distributer.getId());
+    }
+
+    void testReplicaHostIds() {
+        std::vector<Column> partitionColumns;
+        partitionColumns.push_back(Column("Partition", WIRE_TYPE_INTEGER));
+        partitionColumns.push_back(Column("Sites", WIRE_TYPE_STRING));
+        partitionColumns.push_back(Column("Leader", WIRE_TYPE_STRING));
+        Table partitions(partitionColumns);
+        RowBuilder partition(partitionColumns);
+        partition.addInt32(0).addString("0:0,1:0,2:0").addString("1:0");
+        partitions.addRow(partition);
+        partition.addInt32(1).addString("2:1,0:1").addString("2:1");
+        partitions.addRow(partition);
+        // a leader missing from the sites is still a replica
+        partition.addInt32(2).addString("").addString("1:2");
+        partitions.addRow(partition);
+        std::vector<Table> topology;
+        topology.push_back(partitions);
+        topology.push_back(hashConfig());
+        m_distributer.updateAffinityTopology(topology);
+
+        boost::shared_ptr<const std::map<int, std::vector<int> > > replicas = m_distributer.getPartitionToReplicaHostIds();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), replicas->size());
+        const int partition0[] = { 0, 1, 2 };
+        CPPUNIT_ASSERT(replicas->at(0) == std::vector<int>(partition0, partition0 + 3));
+        const int partition1[] = { 2, 0 };
+        CPPUNIT_ASSERT(replicas->at(1) == std::vector<int>(partition1, partition1 + 2));
+        CPPUNIT_ASSERT(replicas->at(2) == std::vector<int>(1, 1));
+        CPPUNIT_ASSERT_EQUAL(1, m_distributer.getHostIdByPartitionId(0));
+        CPPUNIT_ASSERT_EQUAL(2, m_distributer.getHostIdByPartitionId(1));
+    }
+
+    void testPartitionKeys() {
+        std::map<int, int64_t> keys;
+        Distributer::getPartitionKeys(*m_distributer.snapshot(), keys);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), keys.size());
+        for (std::map<int, int64_t>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+            CPPUNIT_ASSERT_EQUAL(it->first, m_distributer.hashinate(it->second));
+            // the smallest key of the partition
+            for (int64_t key = 0; key < it->second; key++) {
+                CPPUNIT_ASSERT(m_distributer.hashinate(key) != it->first);
+            }
+        }
+
+        Distributer unloaded;
+        try {
+            Distributer::getPartitionKeys(*unloaded.snapshot(), keys);
+            CPPUNIT_ASSERT_MESSAGE("no topology is loaded", false);
+        } catch (AllPartitionsInvocationException &e) {
+        }
+        CPPUNIT_ASSERT(keys.empty());
+
+        // a partition without any token of the ring has no key
+        std::vector<Column> partitionColumns;
+        partitionColumns.push_back(Column("Partition", WIRE_TYPE_INTEGER));
+        partitionColumns.push_back(Column("Sites", WIRE_TYPE_STRING));
+        partitionColumns.push_back(Column("Leader", WIRE_TYPE_STRING));
+        Table partitions(partitionColumns);
+        RowBuilder partition(partitionColumns);
+        for (int32_t ii = 0; ii < 5; ii++) {
+            partition.addInt32(ii).addString("0:0").addString("0:0");
+            partitions.addRow(partition);
+        }
+        std::vector<Table> topology;
+        topology.push_back(partitions);
+        topology.push_back(hashConfig());
+        m_distributer.updateAffinityTopology(topology);
+        try {
+            Distributer::getPartitionKeys(*m_distributer.snapshot(), keys);
+            CPPUNIT_ASSERT_MESSAGE("partition 4 owns no part of the ring", false);
+        } catch (AllPartitionsInvocationException &e) {
+        }
+        CPPUNIT_ASSERT(keys.empty());
+    }
+
+private:
+    Distributer m_distributer;
+    SharedByteBuffer m_request;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( DistributerTest );
+}
@@ -0,0 +1,185 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+#include "ElasticHashinator.h"
+
+namespace voltdb {
+
+class ElasticHashinatorTest : public CppUnit::TestFixture {
+CPPUNIT_TEST_SUITE( ElasticHashinatorTest );
+CPPUNIT_TEST( testTokenLookupMatchesSortedRing );
+CPPUNIT_TEST( testHashesBeforeFirstTokenWrapAround );
+CPPUNIT_TEST( testBatchMatchesScalar );
+CPPUNIT_TEST( testRingShares );
+CPPUNIT_TEST_SUITE_END();
+
+public:
+    /*
+     * Serialized ring in the format of the TOPO statistics' HashConfig column
+     */
+    std::vector<int32_t> serializeRing(const std::vector<int32_t> &tokens) {
+        std::vector<int32_t> ring;
+        ring.push_back(htonl(static_cast<uint32_t>(tokens.size())));
+        for (size_t ii = 0; ii < tokens.size(); ii++) {
+            ring.push_back(htonl(static_cast<uint32_t>(tokens[ii])));
+            ring.push_back(htonl(static_cast<uint32_t>(ii % 7)));
+        }
+        return ring;
+    }
+
+    /*
+     * Partition of the last token less than or equal to the hash
+     */
+    int32_t expectedPartition(const std::vector<int32_t> &tokens, int32_t hash) {
+        std::vector<int32_t>::const_iterator it = std::upper_bound(tokens.begin(), tokens.end(), hash);
+        if (it == tokens.begin()) {
+            it = tokens.end();
+        }
+        return static_cast<int32_t>((it - tokens.begin() - 1) % 7);
+    }
+
+    void testTokenLookupMatchesSortedRing() {
+        srand(12345);
+        const size_t sizes[] = { 1, 2, 3, 7, 8, 15, 16, 17, 100, 1024, 4099 };
+        for (size_t ss = 0; ss < sizeof(sizes) / sizeof(sizes[0]); ss++) {
+            std::set<int32_t> unique;
+            unique.insert(INT32_MIN);
+            while (unique.size() < sizes[ss]) {
+                unique.insert(static_cast<int32_t>((static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand())));
+            }
+            std::vector<int32_t> tokens(unique.begin(), unique.end());
+            std::vector<int32_t> ring = serializeRing(tokens);
+            ElasticHashinator hashinator(reinterpret_cast<const char*>(&ring[0]));
+
+            for (size_t ii = 0; ii < tokens.size(); ii++) {
+                CPPUNIT_ASSERT_EQUAL(expectedPartition(tokens, tokens[ii]), hashinator.partitionForToken(tokens[ii]));
+                if (tokens[ii] != INT32_MAX) {
+                    CPPUNIT_ASSERT_EQUAL(expectedPartition(tokens, tokens[ii] + 1), hashinator.partitionForToken(tokens[ii] + 1));
+                }
+            }
+            for (int ii = 0; ii < 10000; ii++) {
+                const int32_t hash = static_cast<int32_t>((static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand()));
+                CPPUNIT_ASSERT_EQUAL(expectedPartition(tokens, hash), hashinator.partitionForToken(hash));
+            }
+            CPPUNIT_ASSERT_EQUAL(expectedPartition(tokens, INT32_MAX), hashinator.partitionForToken(INT32_MAX));
+        }
+    }
+
+    void testHashesBeforeFirstTokenWrapAround() {
+        std::vector<int32_t> tokens;
+        tokens.push_back(-100);
+        tokens.push_back(0);
+        tokens.push_back(100);
+        std::vector<int32_t> ring = serializeRing(tokens);
+        ElasticHashinator hashinator(reinterpret_cast<const char*>(&ring[0]));
+        CPPUNIT_ASSERT_EQUAL(2, hashinator.partitionForToken(INT32_MIN));
+        CPPUNIT_ASSERT_EQUAL(2, hashinator.partitionForToken(-101));
+        CPPUNIT_ASSERT_EQUAL(0, hashinator.partitionForToken(-100));
+        CPPUNIT_ASSERT_EQUAL(1, hashinator.partitionForToken(99));
+        CPPUNIT_ASSERT_EQUAL(2, hashinator.partitionForToken(INT32_MAX));
+    }
+
+    void testBatchMatchesScalar() {
+        srand(54321);
+        const size_t sizes[] = { 1, 6, 7, 8, 100, 4099 };
+        for (size_t ss = 0; ss < sizeof(sizes) / sizeof(sizes[0]); ss++) {
+            std::set<int32_t> unique;
+            unique.insert(INT32_MIN);
+            while (unique.size() < sizes[ss]) {
+                unique.insert(static_cast<int32_t>((static_cast<uint32_t>(rand()) << 16) ^ static_cast<uint32_t>(rand())));
+            }
+            std::vector<int32_t> tokens(unique.begin(), unique.end());
+            std::vector<int32_t> ring = serializeRing(tokens);
+            ElasticHashinator hashinator(reinterpret_cast<const char*>(&ring[0]));
+
+            // spans several chunks and leaves a remainder that isn't a multiple of the lanes
+            const size_t count = 1003;
+            std::vector<int64_t> values(count);
+            std::vector<std::string> strings(count);
+            std::vector<const char*> keys(count);
+            std::vector<int32_t> lengths(count);
+            for (size_t ii = 0; ii < count; ii++) {
+                values[ii] = (static_cast<int64_t>(rand()) << 32) ^ rand();
+                strings[ii] = std::string(static_cast<size_t>(rand() % 40), static_cast<char>('a' + ii % 26));
+                keys[ii] = strings[ii].data();
+                lengths[ii] = static_cast<int32_t>(strings[ii].size());
+            }
+            values[0] = INT64_MIN;
+            values[1] = INT64_MAX;
+            values[2] = 0;
+            values[count - 1] = INT64_MIN;
+
+            std::vector<int32_t> hashes(count);
+            MurmurHash3_x64_128(&values[0], count, &hashes[0]);
+            std::vector<int32_t> partitions(count);
+            hashinator.hashinateBatch(&values[0], count, &partitions[0]);
+            for (size_t ii = 0; ii < count; ii++) {
+                CPPUNIT_ASSERT_EQUAL(MurmurHash3_x64_128(values[ii]), hashes[ii]);
+                CPPUNIT_ASSERT_EQUAL(hashinator.hashinate(values[ii]), partitions[ii]);
+            }
+
+            hashinator.hashinateBatch(&keys[0], &lengths[0], count, &partitions[0]);
+            for (size_t ii = 0; ii < count; ii++) {
+                CPPUNIT_ASSERT_EQUAL(hashinator.hashinate(keys[ii], lengths[ii]), partitions[ii]);
+            }
+        }
+    }
+
+    void testRingShares() {
+        std::vector<int32_t> tokens;
+        tokens.push_back(-100);
+        tokens.push_back(0);
+        tokens.push_back(100);
+        std::vector<int32_t> ring = serializeRing(tokens);
+        ElasticHashinator hashinator(reinterpret_cast<const char*>(&ring[0]));
+        std::map<int32_t, uint64_t> shares;
+        hashinator.ringShares(shares);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), shares.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(100), shares[0]);
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(100), shares[1]);
+        // from the last token around to the first
+        CPPUNIT_ASSERT_EQUAL((UINT64_C(1) << 32) - 200, shares[2]);
+
+        // partitions owning several tokens add up their ranges
+        tokens.clear();
+        for (int32_t ii = 0; ii < 14; ii++) {
+            tokens.push_back(INT32_MIN + ii * 4096);
+        }
+        ring = serializeRing(tokens);
+        ElasticHashinator repeated(reinterpret_cast<const char*>(&ring[0]));
+        repeated.ringShares(shares);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(7), shares.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(8192), shares[1]);
+        CPPUNIT_ASSERT_EQUAL((UINT64_C(1) << 32) - 13 * 4096 + 4096, shares[6]);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ElasticHashinatorTest );
+}
@@ -257,6 +257,17 @@ void MockVoltDB::readCallback(struct bufferevent *bev) {
 
     struct evbuffer *evbuf = bufferevent_get_input(bev);
     while (evbuffer_get_length(evbuf) > 0)  {
+        // wait for the rest of a partially received message
+        char peekedLength[4];
+        if (evbuffer_copyout(evbuf, peekedLength, 4) < 4) {
+            return;
+        }
+        ByteBuffer peekedLengthBuffer(peekedLength, 4);
+        const size_t messageSize = 4 + static_cast<size_t>(peekedLengthBuffer.getInt32());
+        if (evbuffer_get_length(evbuf) < messageSize) {
+            bufferevent_setwatermark( bev, EV_READ, 0, messageSize > 256 ? messageSize : 256);
+            return;
+        }
         if (m_hangupOnRequestCounter > 0) {
             m_hangupOnRequestCounter--;
             if (m_hangupOnRequestCounter == 0) {
@@ -267,7 +278,7 @@ void MockVoltDB::readCallback(struct bufferevent *bev) {
                 return;
             }
         }
-        if (m_filenameForNextResponse == "") {
+        if (m_filenameForNextResponse == "" && m_responseForNextRequest.empty()) {
             throw std::exception();
         }
         // message length
@@ -279,6 +290,7 @@ void MockVoltDB::readCallback(struct bufferevent *bev) {
         boost::scoped_array<char> message(new char[length]);
         evbuffer_remove(evbuf, message.get(), length );
         ByteBuffer messageBuffer(message.get(), length);
+        m_requests.push_back(std::string(message.get(), static_cast<size_t>(length)));
         // ??
         messageBuffer.getInt8();
         bool wasNull;
@@ -288,6 +300,14 @@ void MockVoltDB::readCallback(struct bufferevent *bev) {
         if (m_filenameForNextResponse == "mimicLargeReply") {
             this->mimicLargeReply(clientData, bev);
         }
+        else if (!m_responseForNextRequest.empty()) {
+            std::vector<char> response(m_responseForNextRequest.begin(), m_responseForNextRequest.end());
+            ByteBuffer(&response[0], static_cast<int32_t>(response.size())).putInt64(5, clientData);
+            evbuf = bufferevent_get_output(bev);
+            if (evbuffer_add(evbuf, &response[0], response.size())) {
+                throw voltdb::LibEventException();
+            }
+        }
         else {
             SharedByteBuffer response;
             response = fileAsByteBuffer(m_filenameForNextResponse);
@@ -327,6 +347,10 @@ void MockVoltDB::readCallback(struct bufferevent *bev) {
 }
 
 void MockVoltDB::eventCallback(struct bufferevent *bev, short events) {}
+
+Distributer& MockVoltDB::distributer() {
+    return m_client.m_impl->m_distributer;
+}
 void MockVoltDB::writeCallback(struct bufferevent *bev) {
     if (m_hangupOnRequestCounter == 0) {
         bufferevent_free(bev);
@@ -30,12 +30,14 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <string>
 #include "Client.h"
 
 namespace voltdb {
 SharedByteBuffer fileAsByteBuffer(std::string filename);
 
 class CxnContext;
+class Distributer;
 
 SharedByteBuffer fileAsByteBuffer(std::string filename);
 
@@ -60,6 +62,13 @@ public:
         m_filenameForNextResponse = filename;
     }
 
+    /*
+     * Message, with its length prefix, to answer the next requests with instead of a file's
+     */
+    void responseForNextRequest(const std::string &message) {
+        m_responseForNextRequest = message;
+    }
+
     void hangupOnRequestCount(int32_t count) {
         m_hangupOnRequestCounter = count;
     }
@@ -85,17 +94,29 @@ public:
     }
 
     Client* client() { return &m_client; }
+
+    /*
+     * The client's distributer, to load a topology and procedure partitioning
+     */
+    Distributer& distributer();
+
+    /*
+     * Requests received so far, without their length prefix
+     */
+    const std::vector<std::string>& requests() const { return m_requests; }
 private:
     struct event_base *m_base;
     struct evconnlistener *m_listener;
     std::set<struct bufferevent*> m_connections;
     std::map<struct bufferevent*, boost::shared_ptr<CxnContext> > m_contexts;
     std::string m_filenameForNextResponse;
+    std::string m_responseForNextRequest;
     int32_t m_hangupOnRequestCounter;
     bool m_dontRead;
     int m_timeoutCount;
     int m_errorCount;
     Client m_client;
+    std::vector<std::string> m_requests;
 };
 }
 
@@ -24,7 +24,9 @@
 #include <cppunit/TestCase.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/TestFixture.h>
+#include <boost/bind.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <iostream>
 #include <exception>
 #include <cstdio>
@@ -36,6 +38,7 @@
 #include "Parameter.hpp"
 #include "ParameterSet.hpp"
 #include "Procedure.hpp"
+#include "TypedProcedure.hpp"
 #include "WireType.h"
 #include "Decimal.hpp"
 #include "InvocationResponse.hpp"
@@ -373,10 +376,13 @@ CPPUNIT_TEST(testAuthenticationRequestSha256);
 CPPUNIT_TEST(testAuthenticationResponse);
 CPPUNIT_TEST(testInvocationAllParams);
 CPPUNIT_TEST(testInvocationDateParams);
+CPPUNIT_TEST(testInvocationReusedProcedure);
+CPPUNIT_TEST(testTypedProcedure);
 CPPUNIT_TEST(testInvocationResponseSuccess);
 CPPUNIT_TEST(testInvocationResponseFailCV);
 CPPUNIT_TEST(testInvocationResponseSelect);
 CPPUNIT_TEST(testInvocationResponseSelectWithDateColumn);
+CPPUNIT_TEST(testInvocationResponseLazyResults);
 CPPUNIT_TEST(testInvocationGeoInsert);
 CPPUNIT_TEST(testInvocationGeoInsertNulls);
 CPPUNIT_TEST(testInvocationGeoSelectBoth);
@@ -607,6 +613,59 @@ void testInvocationDateParams() {
                        buffer,   "generated_all_types.msg");
 }
 
+void testInvocationReusedProcedure() {
+    SharedByteBuffer original = fileAsByteBuffer("invocation_request_date_params.msg");
+    std::vector<Parameter> params;
+    params.push_back(Parameter(WIRE_TYPE_DATE, true));
+    params.push_back(Parameter(WIRE_TYPE_DATE));
+    Procedure proc("date_procedure", params);
+    std::vector<boost::gregorian::date> dates;
+    dates.push_back(boost::gregorian::date(1995, 9, 18));
+    dates.push_back(boost::gregorian::date(2025, 7, 10));
+
+    // the pre-encoded header must serialize identically on every invocation
+    for (int ii = 0; ii < 3; ii++) {
+        ParameterSet *ps = proc.params();
+        ps->addDate(dates);
+        ps->addDate(boost::gregorian::date(2012, 3, 6));
+        int32_t size = proc.getSerializedSize();
+        CPPUNIT_ASSERT(size == original.remaining());
+        ScopedByteBuffer buffer(new char[size], size);
+        proc.serializeTo(&buffer, FAKE_CLIENT_DATA);
+        compareByteBuffers(original, "original_all_types.msg",
+                           buffer,   "generated_all_types.msg");
+    }
+}
+
+void testTypedProcedure() {
+    const uint8_t bytes[] = { 1, 2, 3, 4 };
+    std::vector<Parameter> params;
+    params.push_back(Parameter(WIRE_TYPE_BIGINT));
+    params.push_back(Parameter(WIRE_TYPE_TINYINT));
+    params.push_back(Parameter(WIRE_TYPE_STRING));
+    params.push_back(Parameter(WIRE_TYPE_SMALLINT));
+    params.push_back(Parameter(WIRE_TYPE_INTEGER));
+    params.push_back(Parameter(WIRE_TYPE_FLOAT));
+    params.push_back(Parameter(WIRE_TYPE_DECIMAL));
+    params.push_back(Parameter(WIRE_TYPE_VARBINARY));
+    Procedure proc("Vote", params);
+    proc.params()->addInt64(5085551234LL).addInt8(3).addString("MA").addInt16(-2).addInt32(70000)
+        .addDouble(3.1459).addDecimal(Decimal(std::string("3.1459"))).addBytes(sizeof(bytes), bytes);
+    int32_t size = proc.getSerializedSize();
+    ScopedByteBuffer expected(new char[size], size);
+    proc.serializeTo(&expected, FAKE_CLIENT_DATA);
+
+    TypedProcedure<int64_t, int8_t, std::string, int16_t, int32_t, double, Decimal, buffer_t> typed("Vote");
+    // bind twice to check that each bind starts from an empty parameter set
+    typed.bind(1, 1, "CA", 1, 1, 1.0, Decimal(std::string("1")), buffer_t(bytes, 1));
+    typed.bind(5085551234LL, 3, "MA", -2, 70000, 3.1459, Decimal(std::string("3.1459")), buffer_t(bytes, sizeof(bytes)));
+    CPPUNIT_ASSERT(typed.getSerializedSize() == size);
+    ScopedByteBuffer generated(new char[size], size);
+    typed.serializeTo(&generated, FAKE_CLIENT_DATA);
+    compareByteBuffers(expected, "expected_typed.msg",
+                       generated, "generated_typed.msg");
+}
+
 void testInvocationResponseSuccess() {
     SharedByteBuffer original = fileAsByteBuffer("invocation_response_success.msg");
     original.position(4);
@@ -674,6 +733,69 @@ void testInvocationResponseSelect() {
     CPPUNIT_ASSERT(resultCount == 1);
 }
 
+static std::vector<int64_t> ids(const Table &table) {
+    std::vector<int64_t> values;
+    TableIterator iterator = table.iterator();
+    while (iterator.hasNext()) {
+        values.push_back(iterator.next().getInt64(0));
+    }
+    return values;
+}
+
+void testInvocationResponseLazyResults() {
+    std::vector<Column> columns;
+    columns.push_back(Column("ID", WIRE_TYPE_BIGINT));
+    Table first(columns);
+    Table second(columns);
+    RowBuilder row(columns);
+    row.addInt64(1);
+    first.addRow(row);
+    for (int64_t ii = 0; ii < 3; ii++) {
+        row.addInt64(ii);
+        second.addRow(row);
+    }
+
+    // version, client data, present fields, status, app status, round trip time and the tables
+    const int32_t length = 1 + 8 + 1 + 1 + 1 + 4 + 2 + first.getSerializedSize() + second.getSerializedSize();
+    boost::shared_array<char> message(new char[length]);
+    ByteBuffer buffer(message.get(), length);
+    buffer.putInt8(0).putInt64(FAKE_CLIENT_DATA).putInt8(0).putInt8(STATUS_CODE_SUCCESS).putInt8(-128);
+    buffer.putInt32(FAKE_CLUSTER_ROUND_TRIP_TIME).putInt16(2);
+    first.serializeTo(buffer);
+    second.serializeTo(buffer);
+
+    InvocationResponse response(message, length);
+    CPPUNIT_ASSERT(response.success());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), response.resultCount());
+    // a single table can be decoded before, and after, all of them are
+    CPPUNIT_ASSERT(ids(response.result(1)) == ids(second));
+    CPPUNIT_ASSERT(ids(response.result(0)) == ids(first));
+    InvocationResponse copy(response);
+    std::vector<Table> results = response.results();
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), results.size());
+    CPPUNIT_ASSERT(ids(results[0]) == ids(first));
+    CPPUNIT_ASSERT(ids(results[1]) == ids(second));
+    CPPUNIT_ASSERT(ids(response.result(1)) == ids(second));
+    // copies made before decoding share the decoded tables
+    CPPUNIT_ASSERT(ids(copy.results()[1]) == ids(second));
+
+    // threads sharing one response decode it once, concurrently with reads of single tables
+    InvocationResponse shared(message, length);
+    std::vector<std::vector<int64_t> > decoded(8);
+    boost::thread_group threads;
+    for (size_t ii = 0; ii < decoded.size(); ii++) {
+        threads.create_thread(boost::bind(&decodeShared, boost::cref(shared), ii, boost::ref(decoded[ii])));
+    }
+    threads.join_all();
+    for (size_t ii = 0; ii < decoded.size(); ii++) {
+        CPPUNIT_ASSERT(decoded[ii] == ids(ii % 2 == 0 ? second : first));
+    }
+}
+
+static void decodeShared(const InvocationResponse &response, size_t thread, std::vector<int64_t> &decoded) {
+    decoded = thread % 2 == 0 ? ids(response.results()[1]) : ids(response.result(0));
+}
+
 void testInvocationResponseSelectWithDateColumn() {
     SharedByteBuffer original = fileAsByteBuffer("invocation_response_select_with_date.msg");
     original.position(0);
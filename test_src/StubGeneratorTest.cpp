@@ -0,0 +1,127 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestFixture.h>
+#include "ByteBuffer.hpp"
+#include "Procedure.hpp"
+#include "RowBuilder.h"
+#include "Table.h"
+#include "TableIterator.h"
+// Generated by stubgen from the catalog in test_data/stubgen, "make stubgentest" checks that
+// regenerating it gives the same header
+#include "test_data/stubgen/VoterStubs.h"
+
+namespace voltdb {
+
+class StubGeneratorTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE( StubGeneratorTest );
+    CPPUNIT_TEST( testPinnedProcedureInfo );
+    CPPUNIT_TEST( testBind );
+    CPPUNIT_TEST( testRowRead );
+    CPPUNIT_TEST_SUITE_END();
+public:
+
+    void testPinnedProcedureInfo() {
+        voter::Vote vote;
+        CPPUNIT_ASSERT(vote.m_procInfoPinned);
+        CPPUNIT_ASSERT(vote.m_procInfo.get() == &voter::Vote::procedureInfo());
+        CPPUNIT_ASSERT(!vote.m_procInfo->m_multiPart);
+        CPPUNIT_ASSERT(!vote.m_procInfo->m_readOnly);
+        CPPUNIT_ASSERT_EQUAL(0, vote.m_procInfo->m_partitionParameter);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(WIRE_TYPE_BIGINT), vote.m_procInfo->m_partitionParameterType);
+
+        const ProcedureInfo &record = voter::Record::procedureInfo();
+        CPPUNIT_ASSERT_EQUAL(2, record.m_partitionParameter);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(WIRE_TYPE_INTEGER), record.m_partitionParameterType);
+
+        const ProcedureInfo &results = voter::Results::procedureInfo();
+        CPPUNIT_ASSERT(results.m_multiPart);
+        CPPUNIT_ASSERT(results.m_readOnly);
+    }
+
+    /*
+     * Bytes of the request of the procedure
+     */
+    static std::string serialized(Procedure &proc) {
+        const int32_t size = proc.getSerializedSize();
+        std::string bytes(static_cast<size_t>(size), '\0');
+        ByteBuffer buffer(&bytes[0], size);
+        proc.serializeTo(&buffer, 42);
+        return bytes;
+    }
+
+    void testBind() {
+        std::vector<Parameter> signature;
+        signature.push_back(Parameter(WIRE_TYPE_BIGINT));
+        signature.push_back(Parameter(WIRE_TYPE_STRING));
+        signature.push_back(Parameter(WIRE_TYPE_INTEGER));
+        Procedure proc("Vote", signature);
+        proc.params()->addInt64(5085551234LL).addString("MA").addInt32(3);
+
+        voter::Vote vote;
+        vote.bind(5085551234LL, "MA", 3);
+        CPPUNIT_ASSERT(serialized(vote) == serialized(proc));
+
+        const uint8_t payload[] = { 1, 2, 3 };
+        std::vector<Parameter> recordSignature;
+        recordSignature.push_back(Parameter(WIRE_TYPE_TINYINT));
+        recordSignature.push_back(Parameter(WIRE_TYPE_SMALLINT));
+        recordSignature.push_back(Parameter(WIRE_TYPE_INTEGER));
+        recordSignature.push_back(Parameter(WIRE_TYPE_FLOAT));
+        recordSignature.push_back(Parameter(WIRE_TYPE_DECIMAL));
+        recordSignature.push_back(Parameter(WIRE_TYPE_VARBINARY));
+        Procedure recordProc("Record", recordSignature);
+        recordProc.params()->addInt8(1).addInt16(-2).addInt32(70000).addDouble(0.5)
+            .addDecimal(Decimal(std::string("12.25"))).addBytes(sizeof(payload), payload);
+
+        voter::Record record;
+        record.bind(1, -2, 70000, 0.5, Decimal(std::string("12.25")), buffer_t(payload, sizeof(payload)));
+        CPPUNIT_ASSERT(serialized(record) == serialized(recordProc));
+    }
+
+    void testRowRead() {
+        std::vector<Column> columns;
+        columns.push_back(Column("PHONE_NUMBER", WIRE_TYPE_BIGINT));
+        columns.push_back(Column("STATE", WIRE_TYPE_STRING));
+        columns.push_back(Column("CONTESTANT_NUMBER", WIRE_TYPE_INTEGER));
+        columns.push_back(Column("CREATED", WIRE_TYPE_TIMESTAMP));
+        columns.push_back(Column("LOCATION", WIRE_TYPE_GEOGRAPHY_POINT));
+        Table votes(columns);
+        RowBuilder builder(columns);
+        builder.addInt64(5085551234LL).addString("MA").addInt32(3).addTimeStamp(1500000000000000LL)
+            .addGeographyPoint(GeographyPoint(-71.06, 42.36));
+        votes.addRow(builder);
+
+        TableIterator rows = votes.iterator();
+        Row row = rows.next();
+        voter::VOTES_Row vote = voter::VOTES_Row::read(row);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(5085551234LL), vote.PHONE_NUMBER);
+        CPPUNIT_ASSERT(vote.STATE == "MA");
+        CPPUNIT_ASSERT_EQUAL(3, vote.CONTESTANT_NUMBER);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(1500000000000000LL), vote.CREATED);
+        CPPUNIT_ASSERT(vote.LOCATION == GeographyPoint(-71.06, 42.36));
+    }
+};
+CPPUNIT_TEST_SUITE_REGISTRATION( StubGeneratorTest );
+}
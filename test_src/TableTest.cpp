@@ -26,9 +26,20 @@
 #include "Table.h"
 #include "TableIterator.h"
 #include "RowBuilder.h"
+#include "SchemaCache.h"
+#include "RowCursor.hpp"
+#include "ColumnarTable.h"
+#include "SegmentedBuffer.h"
 #include "Decimal.hpp"
 #include <boost/scoped_ptr.hpp>
+#include <algorithm>
+#include <set>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <sstream>
 #include "DateCodec.h"
+#include <event2/buffer.h>
 
 namespace voltdb {
 
@@ -58,6 +69,15 @@ private:
     CPPUNIT_TEST(testPopulateRowWithIllegalColumnType);
     CPPUNIT_TEST(testDecimalSignedZeroEquality);
     CPPUNIT_TEST(testTableSerializeNegative);
+    CPPUNIT_TEST(testSchemaInterning);
+    CPPUNIT_TEST(testRowCursor);
+    CPPUNIT_TEST(testRowIndex);
+    CPPUNIT_TEST(testParallelForEachRow);
+    CPPUNIT_TEST(testColumnNameIndex);
+    CPPUNIT_TEST(testValueRefs);
+    CPPUNIT_TEST(testColumnarTable);
+    CPPUNIT_TEST(testSegmentedTable);
+    CPPUNIT_TEST(testSegmentedTableReleasesChunks);
     CPPUNIT_TEST_SUITE_END();
 
     void fillRandomValues() {
@@ -607,6 +627,517 @@ private:
             }
         }
 
+        // the table as received in a response, in a buffer of its own
+        static SharedByteBuffer received(Table &table) {
+            const int32_t size = table.getSerializedSize();
+            boost::shared_array<char> bytes(new char[size]);
+            ByteBuffer serialized(bytes.get(), size);
+            table.serializeTo(serialized);
+            SharedByteBuffer buffer(bytes, size);
+            buffer.position(4);
+            return buffer.slice();
+        }
+
+        void testSchemaInterning() {
+            std::vector<Column> columns;
+            columns.push_back(Column("ID", WIRE_TYPE_BIGINT));
+            columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+            Table table(columns);
+            RowBuilder row(columns);
+            row.addInt64(1).addString("one");
+            table.addRow(row);
+            std::vector<Column> otherColumns(columns);
+            otherColumns[1] = Column("LABEL", WIRE_TYPE_STRING);
+            Table other(otherColumns);
+
+            SchemaCache schemas;
+            Table first(received(table), &schemas);
+            Table second(received(table), &schemas);
+            Table third(received(other), &schemas);
+            CPPUNIT_ASSERT(first.m_columns == second.m_columns);
+            CPPUNIT_ASSERT(first.m_columnIndex == second.m_columnIndex);
+            CPPUNIT_ASSERT(first.m_columns != third.m_columns);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), schemas.size());
+            CPPUNIT_ASSERT(first.columns() == columns);
+            CPPUNIT_ASSERT(third.columns() == otherColumns);
+            CPPUNIT_ASSERT(first == second);
+
+            // tables decoded without the cache compare their columns
+            Table uncached(received(table));
+            CPPUNIT_ASSERT(uncached.m_columns != first.m_columns);
+            CPPUNIT_ASSERT(uncached == first);
+            CPPUNIT_ASSERT(!(uncached != first));
+            TableIterator rows = second.iterator();
+            CPPUNIT_ASSERT(rows.next().getString("NAME") == "one");
+        }
+
+        // a table of rows of variable length, ID and NAME being the index of the row
+        static Table numbered(int32_t rowCount) {
+            std::vector<Column> columns;
+            columns.push_back(Column("ID", WIRE_TYPE_INTEGER));
+            columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+            Table table(columns);
+            RowBuilder row(columns);
+            for (int32_t ii = 0; ii < rowCount; ii++) {
+                std::stringstream name;
+                name << ii;
+                row.addInt32(ii).addString(name.str());
+                table.addRow(row);
+            }
+            return Table(TableTest::received(table));
+        }
+
+        void testRowIndex() {
+            Table table = numbered(1000);
+            try {
+                table.row(0);
+                CPPUNIT_ASSERT_MESSAGE("row access without an index expected to fail", false);
+            }
+            catch (const voltdb::TableException &excp) {
+            }
+            table.buildRowIndex();
+            for (int32_t ii = 999; ii >= 0; ii -= 7) {
+                Row row = table.row(ii);
+                std::stringstream name;
+                name << ii;
+                CPPUNIT_ASSERT_EQUAL(ii, row.getInt32(0));
+                CPPUNIT_ASSERT(row.getString("NAME") == name.str());
+            }
+            try {
+                table.row(1000);
+                CPPUNIT_ASSERT_MESSAGE("row past the end expected to fail", false);
+            }
+            catch (const voltdb::IndexOutOfBoundsException &excp) {
+            }
+
+            // adding a row drops the index
+            std::vector<Column> columns = table.columns();
+            RowBuilder row(columns);
+            row.addInt32(1000).addString("1000");
+            table.addRow(row);
+            CPPUNIT_ASSERT(table.m_rowOffsets.get() == NULL);
+            table.buildRowIndex();
+            CPPUNIT_ASSERT(table.row(1000).getString(1) == "1000");
+        }
+
+        struct Visits {
+            Visits(int32_t rowCount) : m_counts(static_cast<size_t>(rowCount)) {}
+
+            void visit(int32_t index, Row &row) {
+                CPPUNIT_ASSERT_EQUAL(index, row.getInt32("ID"));
+                m_counts[static_cast<size_t>(index)]++;
+                boost::mutex::scoped_lock lock(m_lock);
+                m_threads.insert(boost::this_thread::get_id());
+            }
+
+            void fail(int32_t index, Row &row) {
+                if (index == 777) {
+                    throw InvalidColumnException("failed");
+                }
+                visit(index, row);
+            }
+
+            // each thread counts the rows of its own range
+            std::vector<int32_t> m_counts;
+            std::set<boost::thread::id> m_threads;
+            boost::mutex m_lock;
+        };
+
+        void testParallelForEachRow() {
+            Table table = numbered(10001);
+            const int32_t threadCounts[] = { 1, 3, 8, 0 };
+            for (size_t tt = 0; tt < sizeof(threadCounts) / sizeof(threadCounts[0]); tt++) {
+                Visits visits(10001);
+                table.parallelForEachRow(threadCounts[tt], boost::bind(&Visits::visit, &visits, _1, _2));
+                CPPUNIT_ASSERT(std::count(visits.m_counts.begin(), visits.m_counts.end(), 1) == 10001);
+                if (threadCounts[tt] > 0) {
+                    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(threadCounts[tt]), visits.m_threads.size());
+                }
+            }
+
+            // the index is used when built, and more threads than rows leaves some idle
+            table.buildRowIndex();
+            Visits visits(10001);
+            table.parallelForEachRow(4, boost::bind(&Visits::visit, &visits, _1, _2));
+            CPPUNIT_ASSERT(std::count(visits.m_counts.begin(), visits.m_counts.end(), 1) == 10001);
+            Table small = numbered(2);
+            Visits few(2);
+            small.parallelForEachRow(16, boost::bind(&Visits::visit, &few, _1, _2));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), few.m_threads.size());
+
+            try {
+                Visits failing(10001);
+                table.parallelForEachRow(4, boost::bind(&Visits::fail, &failing, _1, _2));
+                CPPUNIT_ASSERT_MESSAGE("exception of a worker expected to be rethrown", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+        }
+
+        void testRowCursor() {
+            // variable sized columns between fixed sized ones, and a fixed width schema
+            std::vector<Column> columns;
+            columns.push_back(Column("ID", WIRE_TYPE_BIGINT));
+            columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+            columns.push_back(Column("SCORE", WIRE_TYPE_INTEGER));
+            std::vector<Column> fixedColumns;
+            fixedColumns.push_back(Column("ID", WIRE_TYPE_BIGINT));
+            fixedColumns.push_back(Column("SCORE", WIRE_TYPE_SMALLINT));
+            Table table(columns);
+            Table fixed(fixedColumns);
+            RowBuilder row(columns);
+            RowBuilder fixedRow(fixedColumns);
+            for (int32_t ii = 0; ii < 100; ii++) {
+                row.addInt64(ii).addString(std::string(static_cast<size_t>(ii % 7), 'x'));
+                if (ii % 5 == 0) {
+                    row.addNull();
+                } else {
+                    row.addInt32(ii * 3);
+                }
+                table.addRow(row);
+                fixedRow.addInt64(-ii).addInt16(static_cast<int16_t>(ii));
+                fixed.addRow(fixedRow);
+            }
+
+            Table received(TableTest::received(table));
+            RowCursor cursor = received.cursor();
+            CPPUNIT_ASSERT_EQUAL(-1, cursor.rowIndex());
+            TableIterator iterator = received.iterator();
+            while (iterator.hasNext()) {
+                Row expected = iterator.next();
+                CPPUNIT_ASSERT(cursor.next());
+                CPPUNIT_ASSERT_EQUAL(expected.getInt64(0), cursor.getInt64(0));
+                CPPUNIT_ASSERT(expected.getString("NAME") == cursor.getString("NAME"));
+                CPPUNIT_ASSERT_EQUAL(expected.isNull(2), cursor.isNull(2));
+                CPPUNIT_ASSERT_EQUAL(expected.getInt32(2), cursor.getInt32(2));
+            }
+            CPPUNIT_ASSERT_EQUAL(99, cursor.rowIndex());
+            CPPUNIT_ASSERT(!cursor.next());
+
+            RowCursor fixedCursor = fixed.cursor();
+            int32_t rows = 0;
+            while (fixedCursor.next()) {
+                CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(-rows), fixedCursor.getInt64(0));
+                CPPUNIT_ASSERT_EQUAL(static_cast<int16_t>(rows), fixedCursor.getInt16("SCORE"));
+                rows++;
+            }
+            CPPUNIT_ASSERT_EQUAL(100, rows);
+        }
+
+        void testColumnNameIndex() {
+            std::vector<Column> columns;
+            columns.push_back(Column("ID", WIRE_TYPE_BIGINT));
+            columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+            columns.push_back(Column("ID", WIRE_TYPE_INTEGER));
+            Table table(columns);
+            RowBuilder row(columns);
+            row.addInt64(1).addString("one").addInt32(2);
+            table.addRow(row);
+
+            // only interned schemas are indexed, the other tables scan their columns
+            CPPUNIT_ASSERT(table.m_columnIndex.get() == NULL);
+            Table uncached(TableTest::received(table));
+            CPPUNIT_ASSERT(uncached.m_columnIndex.get() == NULL);
+            CPPUNIT_ASSERT_EQUAL(1, uncached.columnIndex("NAME"));
+            CPPUNIT_ASSERT_EQUAL(0, uncached.columnIndex("ID"));
+            CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(1), uncached.iterator().next().getInt64("ID"));
+            try {
+                uncached.columnIndex("MISSING");
+                CPPUNIT_ASSERT_MESSAGE("index of a missing column expected to fail", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+
+            SchemaCache schemas;
+            Table received(TableTest::received(table), &schemas);
+            CPPUNIT_ASSERT(received.m_columnIndex.get() != NULL);
+            CPPUNIT_ASSERT_EQUAL(1, received.columnIndex("NAME"));
+            // like the scan, the first of the columns with a name is found
+            CPPUNIT_ASSERT_EQUAL(0, received.columnIndex("ID"));
+            try {
+                received.columnIndex("MISSING");
+                CPPUNIT_ASSERT_MESSAGE("index of a missing column expected to fail", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+
+            Row first = received.iterator().next();
+            CPPUNIT_ASSERT(first.m_columnIndex == received.m_columnIndex);
+            CPPUNIT_ASSERT_EQUAL(static_cast<int64_t>(1), first.getInt64("ID"));
+            CPPUNIT_ASSERT(first.getString("NAME") == "one");
+            RowCursor cursor = received.cursor();
+            CPPUNIT_ASSERT(cursor.next());
+            CPPUNIT_ASSERT(cursor.getStringRef("NAME") == "one");
+            try {
+                first.getInt32("MISSING");
+                CPPUNIT_ASSERT_MESSAGE("value of a missing column expected to fail", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+
+            // rows without an index scan the columns
+            SharedByteBuffer rowData = TableTest::received(table);
+            boost::shared_ptr<std::vector<Column> > schema(new std::vector<Column>(columns));
+            Row unindexed(rowData, schema);
+            CPPUNIT_ASSERT(unindexed.m_columnIndex.get() == NULL);
+            CPPUNIT_ASSERT_EQUAL(1, unindexed.getColumnIndexByName("NAME"));
+            CPPUNIT_ASSERT_EQUAL(0, unindexed.getColumnIndexByName("ID"));
+        }
+
+        void testValueRefs() {
+            std::vector<Column> columns;
+            columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+            columns.push_back(Column("DATA", WIRE_TYPE_VARBINARY));
+            columns.push_back(Column("AREA", WIRE_TYPE_GEOGRAPHY));
+            Table table(columns);
+            RowBuilder row(columns);
+            Geography area;
+            area.addEmptyRing() << GeographyPoint(0, 0) << GeographyPoint(1, 0)
+                                << GeographyPoint(1, 1) << GeographyPoint(0, 0);
+            const uint8_t data[] = { 0, 1, 2, 255 };
+            row.addString("name").addVarbinary(sizeof(data), data).addGeography(area);
+            table.addRow(row);
+            row.addNull().addNull().addNull();
+            table.addRow(row);
+
+            SharedByteBuffer buffer = TableTest::received(table);
+            Table received(buffer);
+            TableIterator rows = received.iterator();
+            Row first = rows.next();
+            boost::string_ref name = first.getStringRef(0);
+            CPPUNIT_ASSERT(!first.wasNull());
+            CPPUNIT_ASSERT(name == "name");
+            CPPUNIT_ASSERT(first.getStringRef("NAME") == first.getString("NAME"));
+            // the view points into the response, it is not a copy
+            CPPUNIT_ASSERT(name.data() > buffer.bytes() && name.data() < buffer.bytes() + buffer.limit());
+            boost::string_ref bytes = first.getVarbinaryRef("DATA");
+            CPPUNIT_ASSERT_EQUAL(sizeof(data), bytes.size());
+            CPPUNIT_ASSERT(::memcmp(data, bytes.data(), sizeof(data)) == 0);
+            boost::string_ref geography = first.getGeographyRef(2);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(area.getSerializedSize() - 4), geography.size());
+            CPPUNIT_ASSERT(first.getGeography("AREA") == area);
+
+            Row second = rows.next();
+            CPPUNIT_ASSERT(second.getStringRef(0).empty());
+            CPPUNIT_ASSERT(second.wasNull());
+            CPPUNIT_ASSERT(second.getVarbinaryRef(1).empty());
+            CPPUNIT_ASSERT(second.wasNull());
+            CPPUNIT_ASSERT(second.getGeographyRef("AREA").empty());
+            CPPUNIT_ASSERT(second.wasNull());
+            CPPUNIT_ASSERT(second.isNull(0) && second.isNull(1) && second.isNull(2));
+            CPPUNIT_ASSERT(!first.isNull(0) && !first.isNull(1) && !first.isNull(2));
+        }
+
+        void testColumnarTable() {
+            std::vector<Column> columns;
+            columns.push_back(Column("TINY", WIRE_TYPE_TINYINT));
+            columns.push_back(Column("SMALL", WIRE_TYPE_SMALLINT));
+            columns.push_back(Column("ID", WIRE_TYPE_INTEGER));
+            columns.push_back(Column("BIG", WIRE_TYPE_BIGINT));
+            columns.push_back(Column("RATIO", WIRE_TYPE_FLOAT));
+            columns.push_back(Column("PRICE", WIRE_TYPE_DECIMAL));
+            columns.push_back(Column("NAME", WIRE_TYPE_STRING));
+            columns.push_back(Column("LOCATION", WIRE_TYPE_GEOGRAPHY_POINT));
+            Table table(columns);
+            RowBuilder row(columns);
+            const int32_t rowCount = 11;
+            for (int32_t ii = 0; ii < rowCount; ii++) {
+                if (ii % 3 == 2) {
+                    for (int32_t column = 0; column < 7; column++) {
+                        row.addNull();
+                    }
+                    row.addGeographyPoint(GeographyPoint());
+                } else {
+                    std::stringstream name;
+                    name << "row" << ii;
+                    row.addInt8(static_cast<int8_t>(-ii)).addInt16(static_cast<int16_t>(ii * 300))
+                       .addInt32(ii * 70000).addInt64(static_cast<int64_t>(ii) << 40).addDouble(ii * 0.5)
+                       .addDecimal(Decimal(name.str() == "row0" ? std::string("0.5") : std::string("-12.25")))
+                       .addString(name.str()).addGeographyPoint(GeographyPoint(ii, -ii));
+                }
+                table.addRow(row);
+            }
+
+            Table received(TableTest::received(table));
+            ColumnarTable columnar(received);
+            CPPUNIT_ASSERT_EQUAL(rowCount, columnar.rowCount());
+            CPPUNIT_ASSERT_EQUAL(8, columnar.columnCount());
+            CPPUNIT_ASSERT(columnar.columns() == *received.m_columns);
+
+            const int32_t *offsets = columnar.offsets(6);
+            CPPUNIT_ASSERT_EQUAL(0, offsets[0]);
+            TableIterator rows = received.iterator();
+            for (int32_t ii = 0; ii < rowCount; ii++) {
+                Row expected = rows.next();
+                for (int32_t column = 0; column < 8; column++) {
+                    const bool valid = (columnar.validity(column)[ii / 8] >> (ii % 8)) & 1;
+                    CPPUNIT_ASSERT_EQUAL(expected.isNull(column), !valid);
+                    CPPUNIT_ASSERT_EQUAL(expected.isNull(column), columnar.isNull(column, ii));
+                }
+                CPPUNIT_ASSERT_EQUAL(expected.getInt8(0), columnar.int8Values(0)[ii]);
+                CPPUNIT_ASSERT_EQUAL(expected.getInt16(1), columnar.int16Values(1)[ii]);
+                CPPUNIT_ASSERT_EQUAL(expected.getInt32(2), columnar.int32Values(2)[ii]);
+                CPPUNIT_ASSERT_EQUAL(expected.getInt64(3), columnar.int64Values(3)[ii]);
+                if (!expected.isNull(4)) {
+                    CPPUNIT_ASSERT_EQUAL(expected.getDouble(4), columnar.doubleValues(4)[ii]);
+                }
+                CPPUNIT_ASSERT(expected.getDecimal(5) == columnar.decimalValue(5, ii));
+                CPPUNIT_ASSERT(expected.getStringRef(6) == columnar.value(6, ii));
+                CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(expected.getStringRef(6).size()), offsets[ii + 1] - offsets[ii]);
+                GeographyPoint point = expected.getGeographyPoint(7);
+                CPPUNIT_ASSERT_EQUAL(point.getLongitude(), columnar.doubleValues(7)[2 * ii]);
+                CPPUNIT_ASSERT_EQUAL(point.getLatitude(), columnar.doubleValues(7)[2 * ii + 1]);
+            }
+            CPPUNIT_ASSERT(std::string(columnar.data(6), static_cast<size_t>(offsets[rowCount])) ==
+                           "row0row1row3row4row6row7row9row10");
+
+            try {
+                columnar.int32Values(0);
+                CPPUNIT_ASSERT_MESSAGE("INTEGER values of a TINYINT column expected to fail", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+            try {
+                columnar.offsets(2);
+                CPPUNIT_ASSERT_MESSAGE("offsets of an INTEGER column expected to fail", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+            try {
+                columnar.validity(8);
+                CPPUNIT_ASSERT_MESSAGE("validity of a missing column expected to fail", false);
+            }
+            catch (const voltdb::InvalidColumnException &excp) {
+            }
+        }
+
+        /*
+         * A segmented buffer of the serialized table taken from an input buffer of chunks of the
+         * specified size, which refer to the bytes
+         */
+        static boost::shared_ptr<SegmentedBuffer> segmented(const std::vector<char> &bytes, size_t chunkSize) {
+            struct evbuffer *input = evbuffer_new();
+            for (size_t offset = 0; offset < bytes.size(); offset += chunkSize) {
+                evbuffer_add_reference(input, &bytes[offset], std::min(chunkSize, bytes.size() - offset), NULL, NULL);
+            }
+            boost::shared_ptr<SegmentedBuffer> segments(new SegmentedBuffer(input, static_cast<int32_t>(bytes.size())));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), evbuffer_get_length(input));
+            evbuffer_free(input);
+            return segments;
+        }
+
+        void testSegmentedTable() {
+            Table table = numbered(1000);
+            std::vector<char> bytes(static_cast<size_t>(table.getSerializedSize()));
+            ByteBuffer serialized(&bytes[0], static_cast<int32_t>(bytes.size()));
+            table.serializeTo(serialized);
+            const int32_t length = static_cast<int32_t>(bytes.size()) - 4;
+
+            boost::shared_ptr<SegmentedBuffer> segments = segmented(bytes, 13);
+            CPPUNIT_ASSERT_EQUAL(static_cast<int32_t>(bytes.size()), segments->length());
+            CPPUNIT_ASSERT_EQUAL((bytes.size() + 12) / 13, segments->segmentCount());
+            // bytes within a chunk are shared, bytes spanning chunks are copied
+            CPPUNIT_ASSERT(segments->slice(14, 12).bytes() == &bytes[14]);
+            SharedByteBuffer spanning = segments->slice(10, 8);
+            CPPUNIT_ASSERT(spanning.bytes() != &bytes[10]);
+            CPPUNIT_ASSERT(::memcmp(spanning.bytes(), &bytes[10], 8) == 0);
+            CPPUNIT_ASSERT_EQUAL(length, segments->getInt32(0));
+            try {
+                segments->slice(length, 5);
+                CPPUNIT_ASSERT_MESSAGE("slice past the end expected to fail", false);
+            }
+            catch (const voltdb::IndexOutOfBoundsException &excp) {
+            }
+
+            Table rows(segments, 4, length);
+            CPPUNIT_ASSERT(rows.m_spanned.get() != NULL);
+            CPPUNIT_ASSERT_EQUAL(1000, rows.rowCount());
+            CPPUNIT_ASSERT_EQUAL(2, rows.columnCount());
+            CPPUNIT_ASSERT_EQUAL(table.getStatusCode(), rows.getStatusCode());
+            TableIterator iterator = rows.iterator();
+            for (int32_t ii = 0; ii < 1000; ii++) {
+                CPPUNIT_ASSERT(iterator.hasNext());
+                Row row = iterator.next();
+                std::stringstream name;
+                name << ii;
+                CPPUNIT_ASSERT_EQUAL(ii, row.getInt32(0));
+                CPPUNIT_ASSERT(row.getString(1) == name.str());
+            }
+            CPPUNIT_ASSERT(!iterator.hasNext());
+
+            ColumnarTable columnar(rows);
+            CPPUNIT_ASSERT(rows.m_spanned.get() != NULL);
+            for (int32_t ii = 0; ii < 1000; ii++) {
+                CPPUNIT_ASSERT_EQUAL(ii, columnar.int32Values(0)[ii]);
+            }
+
+            // the cursor needs the rows in one buffer, copied once for all copies of the table
+            Table copy(rows);
+            Table iterated(rows);
+            RowCursor cursor = rows.cursor();
+            CPPUNIT_ASSERT(rows.m_spanned.get() == NULL);
+            CPPUNIT_ASSERT(copy.m_spanned.get() != NULL);
+            CPPUNIT_ASSERT(copy.cursor().next());
+            CPPUNIT_ASSERT(copy.m_buffer.bytes() == rows.m_buffer.bytes());
+            CPPUNIT_ASSERT(iterated.iterator().hasNext());
+            CPPUNIT_ASSERT(iterated.m_spanned.get() == NULL);
+            CPPUNIT_ASSERT(iterated.m_buffer.bytes() == rows.m_buffer.bytes());
+            int32_t count = 0;
+            while (cursor.next()) {
+                CPPUNIT_ASSERT_EQUAL(count++, cursor.getInt32(0));
+            }
+            CPPUNIT_ASSERT_EQUAL(1000, count);
+            CPPUNIT_ASSERT(rows == table);
+
+            // a table within one chunk is read in place
+            boost::shared_ptr<SegmentedBuffer> whole = segmented(bytes, bytes.size());
+            Table shared(whole, 4, length);
+            CPPUNIT_ASSERT(shared.m_spanned.get() == NULL);
+            CPPUNIT_ASSERT(shared.m_buffer.bytes() == &bytes[4]);
+            CPPUNIT_ASSERT(shared == table);
+        }
+
+        static void countRelease(const void *, size_t, void *released) {
+            ++*static_cast<size_t*>(released);
+        }
+
+        void testSegmentedTableReleasesChunks() {
+            Table table = numbered(1000);
+            std::vector<char> bytes(static_cast<size_t>(table.getSerializedSize()));
+            ByteBuffer serialized(&bytes[0], static_cast<int32_t>(bytes.size()));
+            table.serializeTo(serialized);
+            const int32_t length = static_cast<int32_t>(bytes.size()) - 4;
+
+            // chunks large enough for the header to lie within the first one
+            const size_t chunkSize = 256;
+            size_t released = 0;
+            struct evbuffer *input = evbuffer_new();
+            for (size_t offset = 0; offset < bytes.size(); offset += chunkSize) {
+                evbuffer_add_reference(input, &bytes[offset], std::min(chunkSize, bytes.size() - offset),
+                                       &countRelease, &released);
+            }
+            boost::shared_ptr<SegmentedBuffer> segments(new SegmentedBuffer(input, static_cast<int32_t>(bytes.size())));
+            evbuffer_free(input);
+            const size_t chunks = segments->segmentCount();
+            CPPUNIT_ASSERT(chunks > 1);
+
+            Table rows(segments, 4, length);
+            Table copy(rows);
+            segments.reset();
+            CPPUNIT_ASSERT(copy.m_spanned.get() != NULL);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), released);
+
+            // once copied into one buffer the chunks are released, though a copy of the table still refers to them
+            RowCursor cursor = rows.cursor();
+            CPPUNIT_ASSERT_EQUAL(chunks, released);
+            CPPUNIT_ASSERT(copy == table);
+            int32_t count = 0;
+            while (cursor.next()) {
+                CPPUNIT_ASSERT_EQUAL(count++, cursor.getInt32(0));
+            }
+            CPPUNIT_ASSERT_EQUAL(1000, count);
+        }
+
         // type specific test for testing signed zero equality
         void testDecimalSignedZeroEquality() {
             TTInt positiveZero;
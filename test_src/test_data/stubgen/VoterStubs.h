@@ -0,0 +1,144 @@
+/* Generated by stubgen from the VoltDB catalog, do not edit. */
+#ifndef voter_PROCEDURE_STUBS_H_
+#define voter_PROCEDURE_STUBS_H_
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include "Client.h"
+#include "Distributer.h"
+#include "Geography.hpp"
+#include "GeographyPoint.hpp"
+#include "ProcedureCallback.hpp"
+#include "Row.hpp"
+#include "TypedProcedure.hpp"
+
+namespace voter {
+
+// DeleteVotes: skipped, parameter type BIGINT[] is not supported by TypedProcedure
+
+/*
+ * Record(flags TINYINT, region SMALLINT, id INTEGER, ratio FLOAT, price DECIMAL, payload VARBINARY)
+ * {"partitionParameter":2,"readOnly":false,"partitionParameterType":5,"singlePartition":true}
+ */
+class Record : public voltdb::TypedProcedure<int8_t, int16_t, int32_t, double, voltdb::Decimal, voltdb::buffer_t> {
+public:
+    Record() : voltdb::TypedProcedure<int8_t, int16_t, int32_t, double, voltdb::Decimal, voltdb::buffer_t>("Record") {
+        pinProcedureInfo(&procedureInfo());
+    }
+
+    static const voltdb::ProcedureInfo &procedureInfo() {
+        static const voltdb::ProcedureInfo info("{\"partitionParameter\":2,\"readOnly\":false,\"partitionParameterType\":5,\"singlePartition\":true}");
+        return info;
+    }
+
+    voltdb::InvocationResponse invoke(voltdb::Client &client, int8_t flags, int16_t region, int32_t id, double ratio, const voltdb::Decimal &price, const voltdb::buffer_t &payload) {
+        return client.invoke(bind(flags, region, id, ratio, price, payload));
+    }
+
+    void invoke(voltdb::Client &client, boost::shared_ptr<voltdb::ProcedureCallback> callback, int8_t flags, int16_t region, int32_t id, double ratio, const voltdb::Decimal &price, const voltdb::buffer_t &payload) {
+        client.invoke(bind(flags, region, id, ratio, price, payload), callback);
+    }
+};
+
+/*
+ * Results()
+ * {"readOnly":true,"singlePartition":false}
+ */
+class Results : public voltdb::TypedProcedure<> {
+public:
+    Results() : voltdb::TypedProcedure<>("Results") {
+        pinProcedureInfo(&procedureInfo());
+    }
+
+    static const voltdb::ProcedureInfo &procedureInfo() {
+        static const voltdb::ProcedureInfo info("{\"readOnly\":true,\"singlePartition\":false}");
+        return info;
+    }
+
+    voltdb::InvocationResponse invoke(voltdb::Client &client) {
+        return client.invoke(bind());
+    }
+
+    void invoke(voltdb::Client &client, boost::shared_ptr<voltdb::ProcedureCallback> callback) {
+        client.invoke(bind(), callback);
+    }
+};
+
+/*
+ * Vote(phoneNumber BIGINT, state VARCHAR, contestantNumber INTEGER)
+ * {"partitionParameter":0,"readOnly":false,"partitionParameterType":6,"singlePartition":true}
+ */
+class Vote : public voltdb::TypedProcedure<int64_t, std::string, int32_t> {
+public:
+    Vote() : voltdb::TypedProcedure<int64_t, std::string, int32_t>("Vote") {
+        pinProcedureInfo(&procedureInfo());
+    }
+
+    static const voltdb::ProcedureInfo &procedureInfo() {
+        static const voltdb::ProcedureInfo info("{\"partitionParameter\":0,\"readOnly\":false,\"partitionParameterType\":6,\"singlePartition\":true}");
+        return info;
+    }
+
+    voltdb::InvocationResponse invoke(voltdb::Client &client, int64_t phoneNumber, const std::string &state, int32_t contestantNumber) {
+        return client.invoke(bind(phoneNumber, state, contestantNumber));
+    }
+
+    void invoke(voltdb::Client &client, boost::shared_ptr<voltdb::ProcedureCallback> callback, int64_t phoneNumber, const std::string &state, int32_t contestantNumber) {
+        client.invoke(bind(phoneNumber, state, contestantNumber), callback);
+    }
+};
+
+/*
+ * Row of AREAS, read by column position from SELECT * results
+ */
+struct AREAS_Row {
+    int8_t CODE;
+    // PHOTO VARBINARY is not read
+    voltdb::Geography BORDER;
+
+    static AREAS_Row read(voltdb::Row &row) {
+        AREAS_Row r;
+        r.CODE = row.getInt8(0);
+        r.BORDER = row.getGeography(2);
+        return r;
+    }
+};
+
+/*
+ * Row of CONTESTANTS, read by column position from SELECT * results
+ */
+struct CONTESTANTS_Row {
+    int32_t CONTESTANT_NUMBER;
+    std::string CONTESTANT_NAME;
+
+    static CONTESTANTS_Row read(voltdb::Row &row) {
+        CONTESTANTS_Row r;
+        r.CONTESTANT_NUMBER = row.getInt32(0);
+        r.CONTESTANT_NAME = row.getString(1);
+        return r;
+    }
+};
+
+/*
+ * Row of VOTES, read by column position from SELECT * results
+ */
+struct VOTES_Row {
+    int64_t PHONE_NUMBER;
+    std::string STATE;
+    int32_t CONTESTANT_NUMBER;
+    int64_t CREATED;
+    voltdb::GeographyPoint LOCATION;
+
+    static VOTES_Row read(voltdb::Row &row) {
+        VOTES_Row r;
+        r.PHONE_NUMBER = row.getInt64(0);
+        r.STATE = row.getString(1);
+        r.CONTESTANT_NUMBER = row.getInt32(2);
+        r.CREATED = row.getTimestamp(3);
+        r.LOCATION = row.getGeographyPoint(4);
+        return r;
+    }
+};
+
+}
+
+#endif
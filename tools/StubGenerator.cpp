@@ -0,0 +1,347 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2018 VoltDB Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Generates a C++ header of typed procedure stubs from a VoltDB catalog.
+ *
+ * For every procedure a class derived from voltdb::TypedProcedure is emitted with the
+ * procedure's signature and its partitioning information pinned, so invocations neither
+ * validate parameter types at runtime nor look the procedure up in the client's catalog.
+ * A signature change in the database shows up as a compile error at the call sites once
+ * the header is regenerated. For every table a row struct with a reader is emitted.
+ *
+ * The catalog is read either from a running database or from @SystemCatalog results
+ * saved by an earlier run with --save, which allows generating stubs as part of a build
+ * without a database:
+ *
+ *   stubgen --host localhost --port 21212 --save catalog/ --output VoterStubs.h
+ *   stubgen --load catalog/ --namespace voter --output VoterStubs.h
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Client.h"
+#include "ClientConfig.h"
+#include "Distributer.h"
+#include "InvocationResponse.hpp"
+#include "Procedure.hpp"
+#include "Row.hpp"
+#include "Table.h"
+#include "TableIterator.h"
+
+namespace {
+
+const char *SELECTORS[] = { "PROCEDURES", "PROCEDURECOLUMNS", "COLUMNS" };
+
+struct ParameterDesc {
+    std::string name;
+    std::string type;
+    bool array;
+};
+
+struct ColumnDesc {
+    std::string name;
+    std::string type;
+};
+
+/*
+ * C++ parameter type for a catalog type name, empty if TypedProcedure does not support it
+ */
+std::string parameterType(const std::string &typeName) {
+    if (typeName == "TINYINT") return "int8_t";
+    if (typeName == "SMALLINT") return "int16_t";
+    if (typeName == "INTEGER") return "int32_t";
+    if (typeName == "BIGINT") return "int64_t";
+    if (typeName == "FLOAT") return "double";
+    if (typeName == "DECIMAL") return "voltdb::Decimal";
+    if (typeName == "VARCHAR") return "std::string";
+    if (typeName == "VARBINARY") return "voltdb::buffer_t";
+    return "";
+}
+
+/*
+ * C++ field type and Row getter for a column type name, empty if not supported
+ */
+std::string columnType(const std::string &typeName, std::string &getter) {
+    if (typeName == "TINYINT") { getter = "getInt8"; return "int8_t"; }
+    if (typeName == "SMALLINT") { getter = "getInt16"; return "int16_t"; }
+    if (typeName == "INTEGER") { getter = "getInt32"; return "int32_t"; }
+    if (typeName == "BIGINT") { getter = "getInt64"; return "int64_t"; }
+    if (typeName == "FLOAT") { getter = "getDouble"; return "double"; }
+    if (typeName == "DECIMAL") { getter = "getDecimal"; return "voltdb::Decimal"; }
+    if (typeName == "VARCHAR") { getter = "getString"; return "std::string"; }
+    if (typeName == "TIMESTAMP") { getter = "getTimestamp"; return "int64_t"; }
+    if (typeName == "GEOGRAPHY_POINT") { getter = "getGeographyPoint"; return "voltdb::GeographyPoint"; }
+    if (typeName == "GEOGRAPHY") { getter = "getGeography"; return "voltdb::Geography"; }
+    return "";
+}
+
+std::string identifier(const std::string &name) {
+    std::string id(name);
+    for (size_t ii = 0; ii < id.size(); ii++) {
+        char c = id[ii];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+            id[ii] = '_';
+        }
+    }
+    if (id.empty() || (id[0] >= '0' && id[0] <= '9')) {
+        id = "_" + id;
+    }
+    return id;
+}
+
+std::string quoted(const std::string &text) {
+    std::string out("\"");
+    for (size_t ii = 0; ii < text.size(); ii++) {
+        if (text[ii] == '"' || text[ii] == '\\') {
+            out += '\\';
+        }
+        out += text[ii];
+    }
+    return out + "\"";
+}
+
+void usage() {
+    std::cerr << "Usage: stubgen [--host <host>] [--port <port>] [--user <user>] [--password <password>]\n"
+              << "               [--load <dir>] [--save <dir>] [--namespace <ns>] [--output <file>]\n"
+              << "Reads the catalog from the database at host:port (default localhost:21212), or from the\n"
+              << "@SystemCatalog results saved in <dir> with --load, and writes the stubs to <file> (default stdout)."
+              << std::endl;
+}
+
+std::vector<voltdb::Table> fetchCatalog(const std::string &host, unsigned short port,
+                                        const std::string &user, const std::string &password) {
+    voltdb::ClientConfig config(user, password);
+    voltdb::Client client = voltdb::Client::create(config);
+    client.createConnection(host, port);
+
+    std::vector<voltdb::Table> tables;
+    std::vector<voltdb::Parameter> signature;
+    signature.push_back(voltdb::Parameter(voltdb::WIRE_TYPE_STRING));
+    voltdb::Procedure systemCatalog("@SystemCatalog", signature);
+    for (size_t ii = 0; ii < sizeof(SELECTORS) / sizeof(SELECTORS[0]); ii++) {
+        systemCatalog.params()->addString(SELECTORS[ii]);
+        voltdb::InvocationResponse response = client.invoke(systemCatalog);
+        if (response.failure()) {
+            throw voltdb::Exception();
+        }
+        tables.push_back(response.results()[0]);
+    }
+    client.close();
+    return tables;
+}
+
+std::string catalogFile(const std::string &dir, size_t selector) {
+    return dir + "/" + SELECTORS[selector] + ".tbl";
+}
+
+void generate(std::ostream &out, const std::string &ns, const std::vector<voltdb::Table> &catalog) {
+    // procedure name -> partitioning json
+    std::map<std::string, std::string> procedures;
+    voltdb::TableIterator procIter = catalog[0].iterator();
+    while (procIter.hasNext()) {
+        voltdb::Row row = procIter.next();
+        procedures[row.getString("PROCEDURE_NAME")] = row.getString("REMARKS");
+    }
+
+    // procedure name -> parameters by ordinal position
+    std::map<std::string, std::map<int32_t, ParameterDesc> > parameters;
+    voltdb::TableIterator paramIter = catalog[1].iterator();
+    while (paramIter.hasNext()) {
+        voltdb::Row row = paramIter.next();
+        ParameterDesc param;
+        param.name = row.getString("COLUMN_NAME");
+        param.type = row.getString("TYPE_NAME");
+        std::string remarks = row.getString("REMARKS");
+        param.array = row.wasNull() ? false : (remarks.find("ARRAY_PARAMETER") != std::string::npos);
+        parameters[row.getString("PROCEDURE_NAME")][row.getInt32("ORDINAL_POSITION")] = param;
+    }
+
+    // table name -> columns by ordinal position
+    std::map<std::string, std::map<int32_t, ColumnDesc> > tables;
+    voltdb::TableIterator columnIter = catalog[2].iterator();
+    while (columnIter.hasNext()) {
+        voltdb::Row row = columnIter.next();
+        ColumnDesc column;
+        column.name = row.getString("COLUMN_NAME");
+        column.type = row.getString("TYPE_NAME");
+        tables[row.getString("TABLE_NAME")][row.getInt32("ORDINAL_POSITION")] = column;
+    }
+
+    out << "/* Generated by stubgen from the VoltDB catalog, do not edit. */\n"
+        << "#ifndef " << identifier(ns) << "_PROCEDURE_STUBS_H_\n"
+        << "#define " << identifier(ns) << "_PROCEDURE_STUBS_H_\n"
+        << "#include <string>\n"
+        << "#include <boost/shared_ptr.hpp>\n"
+        << "#include \"Client.h\"\n"
+        << "#include \"Distributer.h\"\n"
+        << "#include \"Geography.hpp\"\n"
+        << "#include \"GeographyPoint.hpp\"\n"
+        << "#include \"ProcedureCallback.hpp\"\n"
+        << "#include \"Row.hpp\"\n"
+        << "#include \"TypedProcedure.hpp\"\n\n"
+        << "namespace " << identifier(ns) << " {\n";
+
+    for (std::map<std::string, std::string>::const_iterator proc = procedures.begin(); proc != procedures.end(); ++proc) {
+        const std::string className = identifier(proc->first);
+        const std::map<int32_t, ParameterDesc> &params = parameters[proc->first];
+
+        std::ostringstream types, args, names, signature;
+        std::string unsupported;
+        for (std::map<int32_t, ParameterDesc>::const_iterator param = params.begin(); param != params.end(); ++param) {
+            const ParameterDesc &desc = param->second;
+            std::string type = desc.array ? "" : parameterType(desc.type);
+            if (type.empty()) {
+                unsupported = desc.type + (desc.array ? "[]" : "");
+                break;
+            }
+            const bool byValue = (type.find("::") == std::string::npos);
+            const std::string sep = (param == params.begin()) ? "" : ", ";
+            types << sep << type;
+            args << ", " << (byValue ? type + " " : "const " + type + " &") << identifier(desc.name);
+            names << sep << identifier(desc.name);
+            signature << sep << desc.name << " " << desc.type;
+        }
+        if (!unsupported.empty()) {
+            out << "\n// " << proc->first << ": skipped, parameter type " << unsupported
+                << " is not supported by TypedProcedure\n";
+            std::cerr << "stubgen: skipping " << proc->first << ", unsupported parameter type " << unsupported << std::endl;
+            continue;
+        }
+        const std::string base = "voltdb::TypedProcedure<" + types.str() + ">";
+
+        out << "\n/*\n * " << proc->first << "(" << signature.str() << ")\n * " << proc->second << "\n */\n"
+            << "class " << className << " : public " << base << " {\n"
+            << "public:\n"
+            << "    " << className << "() : " << base << "(" << quoted(proc->first) << ") {\n"
+            << "        pinProcedureInfo(&procedureInfo());\n"
+            << "    }\n\n"
+            << "    static const voltdb::ProcedureInfo &procedureInfo() {\n"
+            << "        static const voltdb::ProcedureInfo info(" << quoted(proc->second) << ");\n"
+            << "        return info;\n"
+            << "    }\n\n"
+            << "    voltdb::InvocationResponse invoke(voltdb::Client &client" << args.str() << ") {\n"
+            << "        return client.invoke(bind(" << names.str() << "));\n"
+            << "    }\n\n"
+            << "    void invoke(voltdb::Client &client, boost::shared_ptr<voltdb::ProcedureCallback> callback"
+            << args.str() << ") {\n"
+            << "        client.invoke(bind(" << names.str() << "), callback);\n"
+            << "    }\n"
+            << "};\n";
+    }
+
+    for (std::map<std::string, std::map<int32_t, ColumnDesc> >::const_iterator table = tables.begin(); table != tables.end(); ++table) {
+        std::ostringstream fields, reads;
+        int32_t index = 0;
+        for (std::map<int32_t, ColumnDesc>::const_iterator column = table->second.begin(); column != table->second.end(); ++column, ++index) {
+            std::string getter;
+            std::string type = columnType(column->second.type, getter);
+            if (type.empty()) {
+                fields << "    // " << column->second.name << " " << column->second.type << " is not read\n";
+                continue;
+            }
+            fields << "    " << type << " " << identifier(column->second.name) << ";\n";
+            reads << "        r." << identifier(column->second.name) << " = row." << getter << "(" << index << ");\n";
+        }
+        const std::string structName = identifier(table->first) + "_Row";
+        out << "\n/*\n * Row of " << table->first << ", read by column position from SELECT * results\n */\n"
+            << "struct " << structName << " {\n"
+            << fields.str() << "\n"
+            << "    static " << structName << " read(voltdb::Row &row) {\n"
+            << "        " << structName << " r;\n"
+            << reads.str()
+            << "        return r;\n"
+            << "    }\n"
+            << "};\n";
+    }
+
+    out << "\n}\n\n#endif\n";
+}
+
+}
+
+int main(int argc, char **argv) {
+    std::string host("localhost"), user, password, loadDir, saveDir, ns("procedures"), output;
+    unsigned short port = 21212;
+    for (int ii = 1; ii < argc; ii++) {
+        std::string arg(argv[ii]);
+        if (ii + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value(argv[++ii]);
+        if (arg == "--host") host = value;
+        else if (arg == "--port") port = static_cast<unsigned short>(atoi(value.c_str()));
+        else if (arg == "--user") user = value;
+        else if (arg == "--password") password = value;
+        else if (arg == "--load") loadDir = value;
+        else if (arg == "--save") saveDir = value;
+        else if (arg == "--namespace") ns = value;
+        else if (arg == "--output") output = value;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    try {
+        std::vector<voltdb::Table> catalog;
+        if (loadDir.empty()) {
+            catalog = fetchCatalog(host, port, user, password);
+        } else {
+            for (size_t ii = 0; ii < sizeof(SELECTORS) / sizeof(SELECTORS[0]); ii++) {
+                std::ifstream in(catalogFile(loadDir, ii).c_str(), std::ios::binary);
+                if (!in) {
+                    std::cerr << "stubgen: cannot read " << catalogFile(loadDir, ii) << std::endl;
+                    return 1;
+                }
+                catalog.push_back(voltdb::Table(in));
+            }
+        }
+
+        if (!saveDir.empty()) {
+            for (size_t ii = 0; ii < catalog.size(); ii++) {
+                std::ofstream out(catalogFile(saveDir, ii).c_str(), std::ios::binary);
+                catalog[ii] >> out;
+            }
+        }
+
+        if (output.empty()) {
+            generate(std::cout, ns, catalog);
+        } else {
+            std::ofstream out(output.c_str());
+            generate(out, ns, catalog);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "stubgen: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}